@@ -0,0 +1,73 @@
+/**
+ * @file Analyzer.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Print structural metrics of grid files as JSON
+ * @version 0.1
+ * @date 2023-01-21
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "../Utility/FileManager.hpp"
+#include "../Utility/GridFile.hpp"
+#include "../Utility/MazeAnalytics.hpp"
+
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Module {
+
+using std::cout;
+using std::endl;
+using std::vector;
+
+class Analyzer {
+    /// @brief `path` as a JSON string (quotes and backslashes escaped)
+    static std::string quoted(const std::filesystem::path& path) {
+        std::string ret = "\"";
+        for (char c : path.string()) {
+            if (c == '"' || c == '\\') {
+                ret += '\\';
+            }
+            ret += c;
+        }
+        return ret + "\"";
+    }
+
+public:
+    /**
+     * @brief analyze every grid, print one JSON array to stdout
+     *
+     * @param grids  defaults to `MazeData.grid`
+     * @note each element is `{ "file": ..., "metrics": { ... } }`, see
+     *      `MazeMetrics::to_json`
+     * @note grids are analyzed in their mapped cells, no `Maze` is built
+     */
+    static void analyze(
+        vector<std::filesystem::path>   grids,
+        const Utility::AnalyticsConfig& config = {}
+    ) {
+        if (grids.empty()) {
+            grids.push_back(FileManager::Filename::MazeGrid);
+        }
+        cout << "[" << endl;
+        for (size_t i = 0; i < grids.size(); ++i) {
+            auto grid = Utility::GridFile::open(grids[i]);
+            if (grid.get_layout() != Utility::layout::row_major) {
+                throw std::runtime_error("Only row-major grid files can be loaded!");
+            }
+            auto metrics = Utility::MazeAnalytics::analyze(grid.get_cells(), grid.get_size(), grid.get_entry(), config);
+            cout << "  { \"file\": " << quoted(grids[i]) << ", \"metrics\": " << metrics.to_json() << " }"
+                 << (i + 1 < grids.size() ? "," : "") << endl;
+        }
+        cout << "]" << endl;
+    }
+};
+
+} // namespace Module
@@ -0,0 +1,179 @@
+/**
+ * @file Daemon.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Serve route queries from a long-running process, and query it
+ * @version 0.1
+ * @date 2023-01-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "../Utility/FileManager.hpp"
+#include "../Utility/GridFile.hpp"
+#include "../Utility/Maze.hpp"
+#include "../Utility/PartitionedBfs.hpp"
+#include "../Utility/RouteService.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Module {
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+using Utility::coordinate;
+using Utility::matrix;
+
+class Daemon {
+    using clock = std::chrono::steady_clock;
+
+public:
+    /// @brief build a maze from a grid file (e.g. `MazeData.grid`)
+    static std::shared_ptr<const Utility::Maze> load(const std::filesystem::path& path) {
+        auto grid = Utility::GridFile::open(path);
+        if (grid.get_layout() != Utility::layout::row_major) {
+            throw std::runtime_error("Only row-major grid files can be loaded!");
+        }
+        const size_t size  = grid.get_size();
+        auto         cells = grid.get_cells();
+        matrix<int>  data(size, vector<int>(size, 0));
+        for (size_t i = 0; i < size; ++i) {
+            for (size_t j = 0; j < size; ++j) {
+                data[i][j] = cells[i * size + j] & Utility::GridFile::open_bit;
+            }
+        }
+        return std::make_shared<const Utility::Maze>(
+            Utility::Maze::create(data, grid.get_entry(), grid.get_exit())
+        );
+    }
+
+#if MAZE_HAS_UNIX_SOCKET
+    /**
+     * @brief load every grid once, then answer queries until shut down
+     *
+     * @param grids    maze `i` of a request is `grids[i]`
+     * @param workers  0 for one per hardware thread
+     */
+    static void serve(
+        const std::filesystem::path&  socket_path,
+        vector<std::filesystem::path> grids,
+        size_t                        workers = 0
+    ) {
+        if (grids.empty()) {
+            grids.push_back(FileManager::Filename::MazeGrid);
+        }
+        vector<std::shared_ptr<const Utility::Maze>> mazes;
+        for (const auto& path : grids) {
+            auto start = clock::now();
+            mazes.push_back(load(path));
+            std::chrono::duration<double, std::milli> spent = clock::now() - start;
+            cout << "maze " << mazes.size() - 1 << " <= " << path << " ("
+                 << mazes.back()->get_size() << " x " << mazes.back()->get_size() << ", "
+                 << spent.count() << " ms)" << endl;
+        }
+        Utility::RouteServer server { socket_path, std::move(mazes), workers };
+        cout << "Serving on " << socket_path << " ..." << endl;
+        cout << endl;
+        server.run();
+        cout << "Server stopped." << endl;
+    }
+
+    /**
+     * @brief send `count` pipelined copies of one query, print the last answer
+     *
+     * @throw std::invalid_argument if `count` is 0
+     */
+    static void query(
+        const std::filesystem::path& socket_path,
+        const Utility::RouteRequest& request,
+        size_t                       count = 1
+    ) {
+        if (count == 0) {
+            throw std::invalid_argument("At least one query must be sent!");
+        }
+        Utility::RouteClient client { socket_path };
+
+        auto start = clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            auto copy = request;
+            copy.id   = static_cast<uint32_t>(i);
+            client.send(copy);
+        }
+        Utility::RouteReply reply;
+        for (size_t i = 0; i < count; ++i) {
+            reply = client.receive();
+        }
+        std::chrono::duration<double, std::micro> spent = clock::now() - start;
+
+        switch (reply.status) {
+        case Utility::route_status::found:
+            cout << "route => " << reply.route.size() << " cells" << endl;
+            break;
+        case Utility::route_status::no_route:
+            cout << "no route" << endl;
+            break;
+        case Utility::route_status::bad_request:
+            cout << "bad request" << endl;
+            break;
+        default:
+            cout << "server is stopping" << endl;
+            break;
+        }
+        cout << count << " queries in " << spent.count() << " us ("
+             << spent.count() / count << " us each)" << endl;
+    }
+
+    /**
+     * @brief ask the server to stop
+     *
+     */
+    static void shutdown(const std::filesystem::path& socket_path) {
+        Utility::RouteClient  client { socket_path };
+        Utility::RouteRequest request;
+        request.op = Utility::route_op::shutdown;
+        client.query(request);
+        cout << "Server is stopping." << endl;
+    }
+
+    /**
+     * @brief route entry to exit of a grid file with `workers` processes,
+     *      each owning a stripe of rows
+     *
+     * @note the file stays mapped, a worker only reads the rows it owns
+     */
+    static void partition(size_t workers, const std::filesystem::path& grid_path = FileManager::Filename::MazeGrid) {
+        auto grid = Utility::GridFile::open(grid_path);
+        if (grid.get_layout() != Utility::layout::row_major) {
+            throw std::runtime_error("Only row-major grid files can be partitioned!");
+        }
+        const size_t size   = grid.get_size();
+        auto         to_idx = [&](const coordinate& cord) {
+            return static_cast<uint32_t>(static_cast<size_t>(cord.first) * size + static_cast<size_t>(cord.second));
+        };
+
+        auto start  = clock::now();
+        auto result = Utility::PartitionedBfs::route(grid.get_cells(), size, to_idx(grid.get_entry()), to_idx(grid.get_exit()), workers);
+        std::chrono::duration<double, std::milli> spent = clock::now() - start;
+
+        if (result.found) {
+            cout << "route => " << result.route.size() << " cells" << endl;
+        } else {
+            cout << "no route" << endl;
+        }
+        cout << result.workers << " workers, " << result.rounds << " rounds, "
+             << result.exchanged << " border cells exchanged, " << spent.count() << " ms" << endl;
+    }
+#endif
+};
+
+} // namespace Module
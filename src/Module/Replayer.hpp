@@ -0,0 +1,96 @@
+/**
+ * @file Replayer.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Record synthetic query traces and replay traces with latencies
+ * @version 0.1
+ * @date 2023-01-23
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "../Utility/GridFile.hpp"
+#include "../Utility/TraceReplay.hpp"
+#include "../Utility/WorkloadGenerator.hpp"
+#include "Daemon.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Module {
+
+using std::cout;
+using std::endl;
+using std::vector;
+
+class Replayer {
+public:
+    /**
+     * @brief generate `maze_count` mazes and a trace of `queries` over them
+     *
+     * @note the mazes are `Generator`'s perfect dfs mazes at any odd size,
+     *      written as `<trace>.<id>.grid` beside the trace; the algorithms
+     *      are bfs, a*, bidirectional bfs and tree routes in equal shares
+     */
+    static void record(
+        const std::filesystem::path& trace_path,
+        size_t                       queries    = 10000,
+        size_t                       maze_count = 4,
+        int                          size       = 1001,
+        uint64_t                     seed       = 20230123
+    ) {
+        Utility::Trace                                trace;
+        vector<std::shared_ptr<const Utility::Maze>> mazes;
+        for (size_t id = 0; id < maze_count; ++id) {
+            Utility::WorkloadConfig config;
+            config.size = size;
+            config.seed = seed + id;
+            auto workload = Utility::WorkloadGenerator::generate(config);
+            mazes.push_back(std::make_shared<const Utility::Maze>(
+                Utility::Maze::create(workload.data, workload.entry, workload.exit)
+            ));
+
+            auto grid = trace_path;
+            grid += "." + std::to_string(id) + ".grid";
+            Utility::GridFile::write(grid, mazes.back()->get_cells(), mazes.back()->get_size(), workload.entry, workload.exit);
+            trace.grids.push_back(grid);
+        }
+
+        static constexpr Utility::trace_algorithm mix[] = {
+            Utility::trace_algorithm::bfs,
+            Utility::trace_algorithm::a_star,
+            Utility::trace_algorithm::bidirectional,
+            Utility::trace_algorithm::tree,
+        };
+        trace.records = Utility::synthesize_trace(mazes, queries, seed, mix);
+        trace.write(trace_path);
+        cout << trace.records.size() << " queries over " << mazes.size() << " mazes ("
+             << size << " x " << size << ") => " << trace_path << endl;
+    }
+
+    /**
+     * @brief replay a trace, print its `ReplayReport` as JSON on stdout
+     *
+     */
+    static void replay(
+        const std::filesystem::path&  trace_path,
+        const Utility::ReplayConfig& config = {}
+    ) {
+        auto trace = Utility::Trace::read(trace_path);
+
+        vector<std::shared_ptr<const Utility::Maze>> mazes;
+        for (const auto& grid : trace.grids) {
+            mazes.push_back(Daemon::load(grid));
+        }
+        auto report = Utility::TraceReplayer::replay(mazes, trace.records, config);
+        cout << report.to_json() << endl;
+    }
+};
+
+} // namespace Module
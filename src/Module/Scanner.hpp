@@ -13,6 +13,7 @@
 
 #include "../Resource/Maze.hpp"
 #include "../Utility/FileManager.hpp"
+#include "../Utility/GridFile.hpp"
 
 namespace Module {
 
@@ -97,6 +98,15 @@ class Scanner {
     }
     void register_the_maze() {
         Resource::set(matrix, entry, exit);
+        Resource::contract_corridors();
+        Resource::load_route_index(FileManager::Filename::RouteIndex);
+        Utility::GridFile::write(
+            FileManager::Filename::MazeGrid,
+            Resource::get()->get_cells(),
+            matrix.size(),
+            entry,
+            exit
+        );
         cout << "Successfully registered the maze..." << endl;
         cout << endl;
     }
@@ -122,7 +132,12 @@ class Scanner {
         // 4. exit
         cout << "exit => (" << exit.first << ", " << exit.second << ")" << endl;
         cout << endl;
-        // 5. tips
+        // 5. corridor graph
+        const auto& corridors = Resource::get()->get_corridors();
+        cout << "corridor graph => " << corridors.node_count() << " nodes, "
+             << corridors.edge_count() << " edges" << endl;
+        cout << endl;
+        // 6. tips
         cout << "Now, we'll try to solve the maze..." << endl;
         cout << endl;
     }
@@ -13,7 +13,19 @@
 
 #include "../Resource/Maze.hpp"
 #include "../Utility/FileManager.hpp"
+#include "../Utility/ExternalBfs.hpp"
+#include "../Utility/FixedMaze.hpp"
+#include "../Utility/GridFile.hpp"
+#include "../Utility/ImageExport.hpp"
+#include "../Utility/LowMemorySolver.hpp"
+#include "../Utility/ParallelAStar.hpp"
+#include "../Utility/Portfolio.hpp"
+#include "../Utility/SolverSelection.hpp"
+#include <algorithm>
 #include <filesystem>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
 
 namespace Module {
 
@@ -22,22 +34,42 @@ using std::cout;
 using std::endl;
 using std::fstream;
 using std::string;
+using std::vector;
 using Utility::coordinate;
 using Utility::matrix;
 
 class Solver {
-    matrix<int> answer           = {};
-    coordinate  entry            = { -1, -1 };
-    coordinate  exit             = { -1, -1 };
-    bool        if_have_solution = true;
+    using index_type = Utility::Maze::index_type;
+
+    matrix<int>        answer           = {};
+    vector<index_type> route            = {}; /* flat indices, entry first */
+    coordinate         entry            = { -1, -1 };
+    coordinate         exit             = { -1, -1 };
+    bool               if_have_solution = true;
+
+    /// @brief keep the route of the `*_solution` just run on the registered maze
+    void keep_solution_route() {
+        auto solved = Resource::get()->get_solution_route();
+        route.assign(solved.begin(), solved.end());
+    }
 
     void solve_by_bfs() {
+        auto maze  = Resource::get();
+        auto fixed = Utility::fixed_bfs_solution<23, 31, 63>(
+            maze->get_data(),
+            maze->get_entry(),
+            maze->get_exit(),
+            &route
+        );
         auto&& [_if_have_solution, _answer, _entry, _exit]
-            = Resource::get()->bfs_solution();
+            = fixed.has_value() ? std::move(*fixed) : maze->bfs_solution();
         if_have_solution = _if_have_solution;
         answer           = std::move(_answer);
         entry            = std::move(_entry);
         exit             = std::move(_exit);
+        if (!fixed.has_value()) {
+            keep_solution_route();
+        }
     }
     void solve_by_a_star() {
         auto&& [_if_have_solution, _answer, _entry, _exit]
@@ -46,21 +78,218 @@ class Solver {
         answer           = std::move(_answer);
         entry            = std::move(_entry);
         exit             = std::move(_exit);
+        keep_solution_route();
+    }
+    void solve_by_corridor_graph() {
+        auto&& [_if_have_solution, _answer, _entry, _exit]
+            = Resource::get()->corridor_solution();
+        if_have_solution = _if_have_solution;
+        answer           = std::move(_answer);
+        entry            = std::move(_entry);
+        exit             = std::move(_exit);
+        keep_solution_route();
+    }
+    /**
+     * @brief IDA* in a fixed memory budget, bfs if the budget runs out
+     *
+     */
+    void solve_by_bounded() {
+        auto maze = Resource::get();
+        auto&& [_if_have_solution, _answer, _entry, _exit]
+            = maze->bounded_solution();
+        if_have_solution = _if_have_solution;
+        answer           = std::move(_answer);
+        entry            = std::move(_entry);
+        exit             = std::move(_exit);
+        keep_solution_route();
+
+        const auto& stats = maze->get_bounded_stats();
+        if (stats.status == Utility::search_status::stopped) {
+            cout << "IDA* ran out of its memory budget, solved by bfs instead." << endl;
+        } else {
+            cout << "IDA*: " << stats.expanded << " expansions in " << stats.iterations
+                 << " iterations, " << stats.peak_bytes << " bytes at most." << endl;
+        }
+        cout << endl;
+    }
+    void solve_by_route_index() {
+        auto&& [_if_have_solution, _answer, _entry, _exit]
+            = Resource::get()->indexed_solution();
+        if_have_solution = _if_have_solution;
+        answer           = std::move(_answer);
+        entry            = std::move(_entry);
+        exit             = std::move(_exit);
+        keep_solution_route();
+    }
+    /**
+     * @brief solve on the mapped `MazeData.grid`, without per-cell tables
+     *
+     * @param if_tremaux  Trémaux if true, otherwise wall follower
+     * @throw std::runtime_error if the grid is not row-major
+     */
+    void solve_by_low_memory(bool if_tremaux) {
+        using Utility::LowMemorySolver;
+
+        auto grid = Utility::GridFile::open(
+            FileManager::Filename::MazeGrid,
+            Utility::MappedFile::access::read_write
+        );
+        if (grid.get_layout() != Utility::layout::row_major) {
+            throw std::runtime_error("Only row-major grid files can be loaded!");
+        }
+        auto maze = Resource::get();
+
+        if (if_tremaux) {
+            if_have_solution = LowMemorySolver::tremaux_route(
+                grid.get_mutable_cells(),
+                grid.get_size(),
+                maze->to_index(maze->get_entry()),
+                maze->to_index(maze->get_exit()),
+                route
+            );
+        } else {
+            if_have_solution = LowMemorySolver::wall_follower_route(
+                grid.get_cells(),
+                grid.get_size(),
+                maze->to_index(maze->get_entry()),
+                maze->to_index(maze->get_exit()),
+                route
+            );
+        }
+        answer = maze->overlay_route(route);
+        entry  = maze->get_entry();
+        exit   = maze->get_exit();
+    }
+    /**
+     * @brief tile `MazeData.grid` onto disk, then solve it out of core
+     *
+     */
+    void solve_by_external_bfs() {
+        static constexpr uint32_t tile_size  = 64;
+        static constexpr size_t   memory_cap = size_t(64) << 20;
+
+        auto grid = Utility::GridFile::open(FileManager::Filename::MazeGrid);
+        Utility::TiledGrid::build(
+            grid.get_cells(),
+            grid.get_size(),
+            tile_size,
+            FileManager::Filename::MazeTiles
+        );
+
+        auto maze   = Resource::get();
+        entry       = maze->get_entry();
+        exit        = maze->get_exit();
+        auto result = Utility::ExternalBfs::solve(
+            FileManager::Filename::MazeTiles,
+            { entry.first, entry.second },
+            { exit.first, exit.second },
+            { FileManager::Dir::Scratch, memory_cap }
+        );
+
+        route.clear();
+        route.reserve(result.route.size());
+        for (auto [x, y] : result.route) {
+            route.push_back(maze->to_index({ static_cast<int>(x), static_cast<int>(y) }));
+        }
+        if_have_solution = result.found;
+        answer           = maze->overlay_route(route);
+    }
+    /**
+     * @brief race bfs, bidirectional bfs and a* on threads, keep the first
+     *
+     */
+    void solve_by_portfolio() {
+        auto maze   = Resource::get();
+        entry       = maze->get_entry();
+        exit        = maze->get_exit();
+        auto result = Utility::solve_portfolio(*maze, entry, exit);
+
+        cout << "Answered first by " << Utility::name_of(result.winner) << "." << endl;
+        cout << endl;
+        if_have_solution = result.if_found;
+        answer           = maze->overlay_route(result.route);
+        route            = std::move(result.route);
+    }
+    /**
+     * @brief the solver expected to be fastest on this maze, from its features
+     *
+     */
+    void solve_by_auto() {
+        auto                    maze = Resource::get();
+        Utility::AdaptiveSolver solver { *maze };
+        cout << "Auto mode picked " << solver.get_choice().describe() << "." << endl;
+        cout << endl;
+
+        Utility::Workspace ws;
+        entry            = maze->get_entry();
+        exit             = maze->get_exit();
+        if_have_solution = solver.route(ws, entry, exit);
+        answer           = maze->overlay_route(ws.get_route());
+        route.assign(ws.get_route().begin(), ws.get_route().end());
+    }
+    /**
+     * @brief a* on every hardware thread, cells hashed to their owner thread
+     *
+     */
+    void solve_by_parallel_a_star() {
+        auto maze   = Resource::get();
+        entry       = maze->get_entry();
+        exit        = maze->get_exit();
+        auto result = Utility::hda_star(*maze, entry, exit);
+
+        cout << result.expanded << " expansions on " << result.threads << " threads, "
+             << result.messages << " sent to another thread." << endl;
+        cout << endl;
+        if_have_solution = result.if_found;
+        answer           = maze->overlay_route(result.route);
+        route            = std::move(result.route);
+    }
+    /**
+     * @brief from the entry to the closest border opening, in one search
+     *
+     */
+    void solve_by_nearest_exit() {
+        auto maze  = Resource::get();
+        entry      = maze->get_entry();
+        auto exits = maze->border_cells();
+        std::erase(exits, entry);
+
+        Utility::Workspace ws;
+        if_have_solution = maze->nearest_route(ws, entry, exits);
+        exit             = if_have_solution ? maze->to_coordinate(ws.get_route().back()) : maze->get_exit();
+        answer           = maze->overlay_route(ws.get_route());
+        route.assign(ws.get_route().begin(), ws.get_route().end());
+
+        cout << "Nearest of " << exits.size() << " exits => "
+             << "(" << exit.first << ", " << exit.second << ")" << endl;
+        cout << endl;
     }
     void show_mode() {
         cout << "Here's mode to solve the maze:" << endl;
         cout << endl;
+        cout << "0. Auto (picked from the maze's features)" << endl;
         cout << "1. BFS" << endl;
         cout << "2. A*" << endl;
+        cout << "3. Corridor Graph" << endl;
+        cout << "4. Route Index" << endl;
+        cout << "5. Tremaux (low memory)" << endl;
+        cout << "6. Wall Follower (low memory)" << endl;
+        cout << "7. External Memory BFS" << endl;
+        cout << "8. Portfolio (BFS / Bidirectional / A*, first wins)" << endl;
+        cout << "9. Nearest Exit (any border opening)" << endl;
+        cout << "10. Parallel A* (HDA*, every hardware thread)" << endl;
+        cout << "11. IDA* (memory-bounded)" << endl;
         cout << endl;
         cout << "Please select a mode >>> ";
     }
     void solve_by_selected_mode() {
+        static constexpr std::string_view MODES[] = { "0", "1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11" };
+
         string mode;
         while (true) {
             show_mode();
             cin >> mode;
-            if (mode == "1" || mode == "2") {
+            if (std::ranges::find(MODES, mode) != std::end(MODES)) {
                 break;
             } else {
                 cout << "Invalid mode, please try again." << endl;
@@ -68,15 +297,36 @@ class Solver {
             }
         }
         cout << endl;
-        if (mode == "1") {
+        if (mode == "0") {
+            solve_by_auto();
+        } else if (mode == "1") {
             solve_by_bfs();
-        } else {
+        } else if (mode == "2") {
             solve_by_a_star();
+        } else if (mode == "3") {
+            solve_by_corridor_graph();
+        } else if (mode == "4") {
+            solve_by_route_index();
+        } else if (mode == "5" || mode == "6") {
+            solve_by_low_memory(mode == "5");
+        } else if (mode == "7") {
+            solve_by_external_bfs();
+        } else if (mode == "8") {
+            solve_by_portfolio();
+        } else if (mode == "10") {
+            solve_by_parallel_a_star();
+        } else if (mode == "11") {
+            solve_by_bounded();
+        } else {
+            solve_by_nearest_exit();
         }
     }
     void write_into_output_file() {
         static constexpr std::string_view SEPERATOR = " ";
 
+        /// @brief larger mazes are only written as an image
+        static constexpr size_t TEXT_LIMIT = 1024;
+
         fstream output;
         output.open(FileManager::Filename::Solved, fstream::out);
         if (!output.is_open()) {
@@ -93,15 +343,19 @@ class Solver {
         output << "Here's the maze (0 for wall, 1 for available path, * for picked path) : " << endl;
         output << endl;
 
-        for (const auto& curr_row : answer) {
-            for (const auto& curr_num : curr_row) {
-                if (curr_num != 2) {
-                    output << curr_num << SEPERATOR;
-                } else {
-                    output << "*" << SEPERATOR;
+        if (answer.size() <= TEXT_LIMIT) {
+            for (const auto& curr_row : answer) {
+                for (const auto& curr_num : curr_row) {
+                    if (curr_num != 2) {
+                        output << curr_num << SEPERATOR;
+                    } else {
+                        output << "*" << SEPERATOR;
+                    }
                 }
+                output << endl;
             }
-            output << endl;
+        } else {
+            output << "(too large for text, see `Solved.png`)" << endl;
         }
         output << endl;
 
@@ -122,12 +376,30 @@ class Solver {
         cout << FileManager::fs::absolute(FileManager::Filename::Solved) << endl;
         cout << endl;
     }
+    /**
+     * @brief render the maze and the picked path into `Solved.png`
+     *
+     */
+    void write_into_image_file() {
+        auto maze = Resource::get();
+        Utility::ImageExport::write(
+            FileManager::Filename::SolvedPng,
+            maze->get_cells(),
+            maze->get_size(),
+            route,
+            Utility::image_format::png
+        );
+        cout << "Image of the maze has been written into => " << endl;
+        cout << FileManager::fs::absolute(FileManager::Filename::SolvedPng) << endl;
+        cout << endl;
+    }
 
 public:
     static void solve() {
         Solver solver;
         solver.solve_by_selected_mode();
         solver.write_into_output_file();
+        solver.write_into_image_file();
     }
 };
 
@@ -13,6 +13,7 @@
 
 #include "../Utility/Maze.hpp"
 
+#include <filesystem>
 #include <memory>
 #include <stdexcept>
 #include <utility>
@@ -64,6 +65,23 @@ static void set(
     instance->set(matrix, entry, exit);
 }
 
+/**
+ * @brief contract corridors of the maze instance into a junction graph
+ *
+ */
+static void contract_corridors() {
+    instance->contract_corridors();
+}
+
+/**
+ * @brief map (or build) the route index of the maze instance
+ *
+ * @param path
+ */
+static void load_route_index(const std::filesystem::path& path) {
+    instance->load_route_index(path);
+}
+
 /**
  * @brief reset the maze instance
  *
@@ -11,12 +11,21 @@
 
 #pragma once
 
+#include "Module/Analyzer.hpp"
+#include "Module/Daemon.hpp"
 #include "Module/Generator.hpp"
 #include "Module/Initializer.hpp"
+#include "Module/Replayer.hpp"
 #include "Module/Scanner.hpp"
 #include "Module/Solver.hpp"
 #include "Utility/FileManager.hpp"
 
+#include <charconv>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
 namespace Task {
 
 void run_all_tasks() {
@@ -30,4 +39,117 @@ void run_all_tasks() {
     Module::Solver::solve();
 }
 
+static void show_usage() {
+    std::cout << "usage:" << std::endl;
+    std::cout << "    Maze                                   (interactive)" << std::endl;
+    std::cout << "    Maze serve <socket> [grid file ...]" << std::endl;
+    std::cout << "    Maze query <socket> <maze> <entry x> <entry y> <exit x> <exit y> [count]" << std::endl;
+    std::cout << "    Maze stop <socket>" << std::endl;
+    std::cout << "    Maze partition <workers> [grid file]" << std::endl;
+    std::cout << "    Maze analyze [grid file ...]           (JSON on stdout)" << std::endl;
+    std::cout << "    Maze trace <trace> [queries] [mazes] [size] [seed]" << std::endl;
+    std::cout << "    Maze replay <trace> [threads] [rate] [repeat]   (JSON on stdout, rate 0 = closed loop)" << std::endl;
+}
+
+/// @brief a command line argument that is not a number of the expected kind (or 0 where it must not be)
+struct bad_argument {
+    std::string arg;
+};
+
+/**
+ * @brief `arg` as a number, the whole of it
+ *
+ * @throw bad_argument if `arg` is not a number, or out of the range of `T`
+ */
+template <class T>
+T number_of(const std::string& arg) {
+    T    ret {};
+    auto [end, error] = std::from_chars(arg.data(), arg.data() + arg.size(), ret);
+    if (arg.empty() || error != std::errc {} || end != arg.data() + arg.size()) {
+        throw bad_argument { arg };
+    }
+    return ret;
+}
+
+/// @brief `number_of`, rejecting 0
+template <class T>
+T positive_number_of(const std::string& arg) {
+    T ret = number_of<T>(arg);
+    if (ret == 0) {
+        throw bad_argument { arg };
+    }
+    return ret;
+}
+
+static int dispatch_command(const std::vector<std::string>& args) {
+    if (!args.empty() && args[0] == "analyze") {
+        Module::Analyzer::analyze({ args.begin() + 1, args.end() });
+        return 0;
+    }
+    if (args.size() >= 2 && args.size() <= 6 && args[0] == "trace") {
+        Module::Replayer::record(
+            args[1],
+            args.size() > 2 ? number_of<size_t>(args[2]) : 10000,
+            args.size() > 3 ? positive_number_of<size_t>(args[3]) : 4,
+            args.size() > 4 ? positive_number_of<int>(args[4]) : 1001,
+            args.size() > 5 ? number_of<uint64_t>(args[5]) : 20230123
+        );
+        return 0;
+    }
+    if (args.size() >= 2 && args.size() <= 5 && args[0] == "replay") {
+        Utility::ReplayConfig config;
+        config.threads = args.size() > 2 ? number_of<size_t>(args[2]) : 1;
+        config.rate    = args.size() > 3 ? number_of<double>(args[3]) : 0;
+        config.repeat  = args.size() > 4 ? positive_number_of<size_t>(args[4]) : 1;
+        Module::Replayer::replay(args[1], config);
+        return 0;
+    }
+#if MAZE_HAS_UNIX_SOCKET
+    if (args.size() >= 2 && args[0] == "serve") {
+        Module::Daemon::serve(args[1], { args.begin() + 2, args.end() });
+        return 0;
+    }
+    if ((args.size() == 7 || args.size() == 8) && args[0] == "query") {
+        Utility::RouteRequest request;
+        request.maze    = number_of<uint16_t>(args[2]);
+        request.entry_x = number_of<int>(args[3]);
+        request.entry_y = number_of<int>(args[4]);
+        request.exit_x  = number_of<int>(args[5]);
+        request.exit_y  = number_of<int>(args[6]);
+        Module::Daemon::query(args[1], request, args.size() == 8 ? positive_number_of<size_t>(args[7]) : 1);
+        return 0;
+    }
+    if (args.size() == 2 && args[0] == "stop") {
+        Module::Daemon::shutdown(args[1]);
+        return 0;
+    }
+    if ((args.size() == 2 || args.size() == 3) && args[0] == "partition") {
+        if (args.size() == 3) {
+            Module::Daemon::partition(positive_number_of<size_t>(args[1]), args[2]);
+        } else {
+            Module::Daemon::partition(positive_number_of<size_t>(args[1]));
+        }
+        return 0;
+    }
+#endif
+    show_usage();
+    return 1;
+}
+
+/**
+ * @brief run a command given on the command line
+ *
+ * @return exit code
+ */
+int run_command(const std::vector<std::string>& args) {
+    try {
+        return dispatch_command(args);
+    } catch (const bad_argument& bad) {
+        std::cout << "Invalid argument: `" << bad.arg << "`" << std::endl;
+        std::cout << std::endl;
+        show_usage();
+        return 1;
+    }
+}
+
 } // namespace Task
\ No newline at end of file
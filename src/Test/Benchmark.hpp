@@ -0,0 +1,258 @@
+/**
+ * @file Benchmark.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Timings of the solvers on large synthetic mazes
+ * @version 0.1
+ * @date 2023-01-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "../Utility/Maze.hpp"
+#include "../Utility/ParallelAStar.hpp"
+#include "../Utility/SolverSelection.hpp"
+#include "../Utility/WorkloadGenerator.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace Test {
+
+using std::cout;
+using std::endl;
+using std::vector;
+using Utility::coordinate;
+using Utility::matrix;
+
+/// @brief `size` x `size` grid, each cell open with `percent`% chance
+inline matrix<int> random_grid(int size, int percent, uint32_t seed) {
+    std::mt19937 rng(seed);
+    matrix<int>  ret(size, vector<int>(size, 0));
+    for (auto& row : ret) {
+        for (auto& cell : row) {
+            cell = static_cast<int>(rng() % 100) < percent;
+        }
+    }
+    return ret;
+}
+
+/// @brief average milliseconds of `fn()` over `rounds` runs
+template <class Fn>
+double average_ms(int rounds, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        fn();
+    }
+    std::chrono::duration<double, std::milli> spent
+        = std::chrono::steady_clock::now() - start;
+    return spent.count() / rounds;
+}
+
+/**
+ * @brief full-grid bfs, row-major vs tiled Morton layout
+ *
+ * @note corner to corner on an open random grid, so the frontier sweeps
+ *      the whole maze as a 2D wave
+ */
+void LayoutBenchmark(int size = 4000, int rounds = 5) {
+    auto data = random_grid(size, 70, 20230116);
+
+    coordinate entry = { 0, 0 };
+    coordinate exit  = { size - 1, size - 1 };
+    // an open first row and last column keep entry and exit connected
+    for (int i = 0; i < size; ++i) {
+        data[0][i] = data[i][size - 1] = 1;
+    }
+
+    auto maze = Utility::Maze::create(data, entry, exit);
+    data.clear();
+
+    Utility::Workspace ws;
+
+    size_t route_length = 0;
+    auto   time_layout  = [&](Utility::layout target) {
+        maze.set_layout(target);
+        maze.bfs_route(ws, entry, exit); /* warm up the workspace */
+        return average_ms(rounds, [&]() {
+            maze.bfs_route(ws, entry, exit);
+            if (route_length != 0 && route_length != ws.get_route().size()) {
+                throw std::runtime_error("Layouts disagree on the route length!");
+            }
+            route_length = ws.get_route().size();
+        });
+    };
+    double row_major    = time_layout(Utility::layout::row_major);
+    double tiled_morton = time_layout(Utility::layout::tiled_morton);
+
+    cout << std::fixed << std::setprecision(2);
+    cout << "LayoutBenchmark (" << size << " x " << size << ", route " << route_length << ")" << endl;
+    cout << "    row-major    : " << row_major << " ms" << endl;
+    cout << "    tiled morton : " << tiled_morton << " ms" << endl;
+    cout << "    speedup      : " << row_major / tiled_morton << "x" << endl;
+    cout << endl;
+}
+
+/**
+ * @brief bfs vs the corridor graph on every kind of the workload corpus
+ *
+ */
+void WorkloadBenchmark(int size = 1001, int rounds = 5, uint64_t seed = 20230118) {
+    Utility::Workspace ws;
+
+    cout << std::fixed << std::setprecision(2);
+    cout << "WorkloadBenchmark (" << size << " x " << size << ", seed " << seed << ")" << endl;
+    for (auto& workload : Utility::WorkloadGenerator::corpus(size, seed)) {
+        auto maze = Utility::Maze::create(workload.data, workload.entry, workload.exit);
+        maze.contract_corridors();
+
+        size_t route_length = 0;
+        double bfs          = average_ms(rounds, [&]() {
+            maze.bfs_route(ws, workload.entry, workload.exit);
+            route_length = ws.get_route().size();
+        });
+        double corridor     = average_ms(rounds, [&]() {
+            maze.corridor_route(ws, workload.entry, workload.exit);
+        });
+        cout << "    " << std::left << std::setw(10) << workload.name << std::right
+             << " route " << std::setw(8) << route_length
+             << "  graph " << std::setw(8) << maze.get_corridors().node_count() << " nodes"
+             << "  bfs " << std::setw(8) << bfs << " ms"
+             << "  corridor " << std::setw(8) << corridor << " ms" << endl;
+    }
+    cout << endl;
+}
+
+/**
+ * @brief per-query time of every solver `AdaptiveSolver` picks from, next to
+ *      its choice, on every kind of the workload corpus
+ *
+ * @note the numbers behind `Utility::selection_rules`, rerun it after
+ *      touching a solver
+ */
+void SelectionBenchmark(int size = 1001, int queries = 40, uint64_t seed = 20230118) {
+    using Utility::selected_solver;
+    std::mt19937       rng(seed);
+    Utility::Workspace ws;
+
+    cout << std::fixed << std::setprecision(3);
+    cout << "SelectionBenchmark (" << size << " x " << size << ", " << queries << " random queries)" << endl;
+    for (auto& workload : Utility::WorkloadGenerator::corpus(size, seed)) {
+        auto maze = Utility::Maze::create(workload.data, workload.entry, workload.exit);
+
+        vector<coordinate> open;
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                if (workload.data[i][j]) {
+                    open.push_back({ i, j });
+                }
+            }
+        }
+        vector<std::pair<coordinate, coordinate>> pairs;
+        for (int query = 0; query < queries; ++query) {
+            pairs.emplace_back(open[rng() % open.size()], open[rng() % open.size()]);
+        }
+
+        double landmarks = average_ms(1, [&]() {
+            maze.prepare_landmarks();
+        });
+        auto per_query = [&](auto&& solve) {
+            return average_ms(1, [&]() {
+                for (auto& [entry, exit] : pairs) {
+                    solve(entry, exit);
+                }
+            }) / queries;
+        };
+        const std::pair<selected_solver, double> timings[] = {
+            { selected_solver::tree, per_query([&](auto& entry, auto& exit) { maze.tree_route(ws, entry, exit); }) },
+            { selected_solver::bfs, per_query([&](auto& entry, auto& exit) { maze.bfs_route(ws, entry, exit); }) },
+            { selected_solver::a_star, per_query([&](auto& entry, auto& exit) { maze.a_star_route(ws, entry, exit); }) },
+            { selected_solver::alt, per_query([&](auto& entry, auto& exit) { maze.alt_route(ws, entry, exit); }) },
+        };
+        auto features = Utility::MazeFeatures::sample(maze);
+
+        cout << "    " << std::left << std::setw(10) << workload.name << std::right;
+        for (auto [solver, ms] : timings) {
+            cout << "  " << Utility::name_of(solver) << " " << std::setw(8) << ms << " ms";
+        }
+        cout << "  (landmarks " << landmarks << " ms)" << endl;
+        cout << "        one query => " << Utility::choose_solver(features, 1).describe() << endl;
+        cout << "        many      => " << Utility::choose_solver(features, 1000).describe() << endl;
+    }
+    cout << endl;
+}
+
+/**
+ * @brief HDA* on 1, 2, 4, ... threads against a* on one, random queries
+ *      across big rooms joined by corridors
+ *
+ * @note rooms make a* search: on wide open ground manhattan is exact, a*
+ *      walks the route alone and there is nothing to share. Speedup needs
+ *      as many cores as threads, with fewer the threads take turns, and
+ *      the one waiting for its turn stalls the others' messages
+ */
+void ParallelAStarBenchmark(int size = 2001, int queries = 10, uint64_t seed = 20230128) {
+    Utility::WorkloadConfig config;
+    config.size         = size;
+    config.seed         = seed;
+    config.room_density = 0.3;
+    config.room_max     = 61;
+    config.braid        = 0.2;
+    auto workload = Utility::WorkloadGenerator::generate(config);
+    auto maze     = Utility::Maze::create(workload.data, workload.entry, workload.exit);
+
+    // queries from one half of the maze to the other, so routes are long
+    std::mt19937                              rng(seed);
+    vector<std::pair<coordinate, coordinate>> pairs;
+    while (pairs.size() < static_cast<size_t>(queries)) {
+        coordinate entry = { static_cast<int>(rng() % size), static_cast<int>(rng() % (size / 2)) };
+        coordinate exit  = { static_cast<int>(rng() % size), size - 1 - static_cast<int>(rng() % (size / 2)) };
+        if (workload.data[entry.first][entry.second] && workload.data[exit.first][exit.second]) {
+            pairs.emplace_back(entry, exit);
+        }
+    }
+    workload.data.clear();
+
+    Utility::Workspace ws;
+    vector<size_t>     route_lengths;
+    const double       a_star = average_ms(1, [&]() {
+        for (auto& [entry, exit] : pairs) {
+            maze.a_star_route(ws, entry, exit);
+            route_lengths.push_back(ws.get_route().size());
+        }
+    }) / queries;
+
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    cout << std::fixed << std::setprecision(2);
+    cout << "ParallelAStarBenchmark (" << size << " x " << size << " rooms, " << queries
+         << " random queries, " << cores << " cores)" << endl;
+    cout << "    a*              : " << std::setw(9) << a_star << " ms" << endl;
+    for (size_t threads = 1; threads <= std::max<size_t>(cores, 2); threads *= 2) {
+        uint64_t     expanded = 0;
+        uint64_t     messages = 0;
+        const double hda      = average_ms(1, [&]() {
+            for (size_t query = 0; query < pairs.size(); ++query) {
+                auto result = Utility::hda_star(maze, pairs[query].first, pairs[query].second, threads);
+                if (result.route.size() != route_lengths[query]) {
+                    throw std::runtime_error("HDA* is not shortest on open rooms!");
+                }
+                expanded += result.expanded;
+                messages += result.messages;
+            }
+        }) / queries;
+        cout << "    HDA* " << std::setw(2) << threads << " threads : " << std::setw(9) << hda << " ms"
+             << "  speedup " << a_star / hda << "x"
+             << "  (" << expanded / queries << " expansions, " << messages / queries << " sent)" << endl;
+    }
+    cout << endl;
+}
+
+} // namespace Test
@@ -0,0 +1,1613 @@
+/**
+ * @file SolverTest.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Cross-check the solvers on freshly generated mazes
+ * @version 0.1
+ * @date 2023-01-08
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "../Module/Replayer.hpp"
+#include "../Resource/Maze.hpp"
+#include "../Utility/AsyncSolve.hpp"
+#include "../Utility/ChunkedMaze.hpp"
+#include "../Utility/ExitField.hpp"
+#include "../Utility/ExternalBfs.hpp"
+#include "../Utility/FixedMaze.hpp"
+#include "../Utility/ImageExport.hpp"
+#include "../Utility/LowMemorySolver.hpp"
+#include "../Utility/MazeAnalytics.hpp"
+#include "../Utility/ParallelAStar.hpp"
+#include "../Utility/PartitionedBfs.hpp"
+#include "../Utility/Portfolio.hpp"
+#include "../Utility/RouteService.hpp"
+#include "../Utility/SolverSelection.hpp"
+#include "../Utility/StaticMaze.hpp"
+#include "../Utility/TraceReplay.hpp"
+#include "../Utility/WorkloadGenerator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace Test {
+
+using std::cout;
+using std::endl;
+using std::vector;
+using Utility::coordinate;
+using Utility::matrix;
+
+/// @brief `Generator`-like 23 x 23 mazes, generated and solved at compile time
+inline constexpr std::array fixtures = {
+    Utility::StaticMaze<23>::generate(1),
+    Utility::StaticMaze<23>::generate(2),
+    Utility::StaticMaze<23>::generate(3),
+    Utility::StaticMaze<23>::generate(4),
+    Utility::StaticMaze<23>::generate(5),
+    Utility::StaticMaze<23>::generate(6),
+    Utility::StaticMaze<23>::generate(7),
+    Utility::StaticMaze<23>::generate(8),
+};
+static_assert(std::ranges::all_of(fixtures, [](const auto& fixture) {
+    return fixture.route_length() > 0;
+}));
+
+/// @brief register the next fixture maze (no file is touched)
+inline void register_fixture() {
+    static size_t next    = 0;
+    const auto&   fixture = fixtures[next++ % fixtures.size()];
+    Resource::set(fixture.to_matrix(), fixture.entry, fixture.exit);
+}
+
+/// @brief every open cell of `data`
+inline vector<coordinate> all_open_cells_of(const matrix<int>& data) {
+    vector<coordinate> ret;
+    for (int i = 0; i < static_cast<int>(data.size()); ++i) {
+        for (int j = 0; j < static_cast<int>(data.size()); ++j) {
+            if (data[i][j]) {
+                ret.emplace_back(i, j);
+            }
+        }
+    }
+    return ret;
+}
+
+/// @brief every open cell of the registered maze
+inline vector<coordinate> all_open_cells() {
+    return all_open_cells_of(Resource::get()->get_data());
+}
+
+void FixedMazeTest() {
+    for (int round = 0; round < 10; ++round) {
+        register_fixture();
+        auto                              maze = Resource::get();
+        vector<Utility::Maze::index_type> route;
+        auto                              fixed = Utility::fixed_bfs_solution<23>(
+            maze->get_data(),
+            maze->get_entry(),
+            maze->get_exit(),
+            &route
+        );
+        if (!fixed.has_value()) {
+            throw std::runtime_error("FixedMaze<23, 23> is not selected!");
+        }
+        auto fresh = Utility::Maze::create(
+            maze->get_data(),
+            maze->get_entry(),
+            maze->get_exit()
+        );
+        if (*fixed != fresh.bfs_solution()
+            || !std::ranges::equal(route, fresh.get_solution_route())) {
+            throw std::runtime_error("FixedMaze disagrees with Maze::bfs_solution!");
+        }
+    }
+    cout << "FixedMazeTest passed!" << endl;
+    cout << endl;
+}
+
+void StaticMazeTest() {
+    // checked by the compiler: a wall cut across makes it unsolvable
+    static_assert([] {
+        auto maze = Utility::StaticMaze<9>::generate(20230125);
+        for (auto& cell : maze.data) {
+            cell = 1;
+        }
+        for (int i = 0; i < 9; ++i) {
+            maze.data[i * 9 + 4] = 0;
+        }
+        return maze.route_length({ 0, 0 }, { 8, 8 }) == 0
+            && maze.route_length({ 0, 0 }, { 8, 3 }) == 12;
+    }());
+
+    // the fixtures agree with the runtime solver, cell for cell
+    Utility::Workspace ws;
+    for (const auto& fixture : fixtures) {
+        auto maze = Utility::Maze::create(fixture.to_matrix(), fixture.entry, fixture.exit);
+        if (!maze.bfs_route(ws, fixture.entry, fixture.exit)
+            || ws.get_route().size() != fixture.route_length()
+            || !maze.is_perfect()) {
+            throw std::runtime_error("Static fixture disagrees with Maze!");
+        }
+    }
+    cout << "StaticMazeTest passed!" << endl;
+    cout << endl;
+}
+
+/// @brief route is a chain of adjacent open cells from `entry` to `exit`
+inline bool if_valid_route(
+    const Utility::Maze&                       maze,
+    std::span<const Utility::Maze::index_type> route,
+    const coordinate&                          entry,
+    const coordinate&                          exit
+) {
+    if (route.empty()
+        || route.front() != maze.to_index(entry)
+        || route.back() != maze.to_index(exit)) {
+        return false;
+    }
+    for (size_t i = 0; i < route.size(); ++i) {
+        auto [x, y] = maze.to_coordinate(route[i]);
+        if (maze.get_data()[x][y] == 0) {
+            return false;
+        }
+        if (i > 0) {
+            auto [px, py] = maze.to_coordinate(route[i - 1]);
+            if (std::abs(px - x) + std::abs(py - y) != 1) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// @brief a random query on a maze of the workload corpus, with the bfs answer
+struct CorpusQuery {
+    const Utility::Workload&                   workload;
+    Utility::Maze&                             maze;
+    coordinate                                 entry;
+    coordinate                                 exit;
+    bool                                       found; /* by bfs */
+    std::span<const Utility::Maze::index_type> route; /* by bfs, valid until the next query */
+    int                                        index; /* of the query on its maze */
+};
+
+/**
+ * @brief `fn(query)` on `queries` random pairs of open cells of every maze of
+ *      `WorkloadGenerator::corpus(size, seed)`
+ *
+ * @param prepare  `prepare(workload, maze)` before the queries of each maze,
+ *      false to skip it
+ * @note the same arguments give the same queries
+ */
+template <class Prepare, class Fn>
+void for_each_corpus_query(int size, uint64_t seed, int queries, Prepare&& prepare, Fn&& fn) {
+    std::mt19937       rng(static_cast<uint32_t>(seed));
+    Utility::Workspace ws;
+    for (auto& workload : Utility::WorkloadGenerator::corpus(size, seed)) {
+        auto maze = Utility::Maze::create(workload.data, workload.entry, workload.exit);
+        if (!prepare(std::as_const(workload), maze)) {
+            continue;
+        }
+        const auto open = all_open_cells_of(workload.data);
+        for (int index = 0; index < queries; ++index) {
+            coordinate entry = open[rng() % open.size()];
+            coordinate exit  = open[rng() % open.size()];
+            const bool found = maze.bfs_route(ws, entry, exit);
+            fn(CorpusQuery { workload, maze, entry, exit, found, ws.get_route(), index });
+        }
+    }
+}
+template <class Fn>
+void for_each_corpus_query(int size, uint64_t seed, int queries, Fn&& fn) {
+    for_each_corpus_query(
+        size, seed, queries, [](const auto&, auto&) { return true; }, std::forward<Fn>(fn)
+    );
+}
+
+/// @brief throw unless `route` is a shortest one of `query`, found exactly when bfs found one
+inline void expect_shortest(
+    const std::string&                         solver,
+    const CorpusQuery&                         query,
+    bool                                       found,
+    std::span<const Utility::Maze::index_type> route
+) {
+    if (found != query.found
+        || (found
+            && (route.size() != query.route.size()
+                || !if_valid_route(query.maze, route, query.entry, query.exit)))) {
+        throw std::runtime_error(solver + " is not shortest on " + query.workload.name + "!");
+    }
+}
+
+void WorkspaceTest() {
+    std::mt19937               rng(33773);
+    Utility::Workspace         ws;
+    Utility::FixedMaze<23, 23> fixed;
+
+    register_fixture();
+    auto maze = Resource::get();
+    auto open = all_open_cells();
+
+    // one workspace, many consecutive queries
+    for (int query = 0; query < 200; ++query) {
+        coordinate entry = open[rng() % open.size()];
+        coordinate exit  = open[rng() % open.size()];
+        bool       found = maze->bfs_route(ws, entry, exit);
+
+        fixed.set(maze->get_data(), entry, exit);
+        if (found != fixed.solve()
+            || ws.get_route().size() != fixed.get_route_length()) {
+            throw std::runtime_error("Workspace reuse changed the bfs result!");
+        }
+    }
+
+    // a moved-from workspace allocates its own arena again, never the mover's
+    const coordinate   entry = open.front();
+    const coordinate   exit  = open.back();
+    Utility::Workspace moved(std::move(ws));
+    const vector<Utility::Workspace::index_type> before(moved.get_route().begin(), moved.get_route().end());
+    if (!ws.get_route().empty()
+        || !maze->bfs_route(ws, entry, exit)
+        || !if_valid_route(*maze, ws.get_route(), entry, exit)
+        || !std::ranges::equal(before, moved.get_route())) {
+        throw std::runtime_error("Moved-from workspace shares the arena!");
+    }
+    ws = std::move(moved);
+    if (!moved.get_route().empty()
+        || !maze->bfs_route(moved, exit, entry)
+        || !std::ranges::equal(before, ws.get_route())) {
+        throw std::runtime_error("Moved-from workspace wasn't reset!");
+    }
+    cout << "WorkspaceTest passed!" << endl;
+    cout << endl;
+}
+
+void CorridorGraphTest() {
+    std::mt19937       rng(20230110);
+    Utility::Workspace bfs_ws;
+    Utility::Workspace graph_ws;
+
+    for (int round = 0; round < 10; ++round) {
+        register_fixture();
+        auto data = Resource::get()->get_data();
+        // knock down some walls, so there're loops and parallel corridors
+        for (int i = 0; i < round * 4; ++i) {
+            data[rng() % data.size()][rng() % data.size()] = 1;
+        }
+        auto entry = Resource::get()->get_entry();
+        auto exit  = Resource::get()->get_exit();
+        auto maze  = Utility::Maze::create(data, entry, exit);
+        maze.contract_corridors();
+
+        bool if_bfs   = maze.bfs_route(bfs_ws, entry, exit);
+        bool if_graph = maze.corridor_route(graph_ws, entry, exit);
+        if (if_bfs != if_graph
+            || bfs_ws.get_route().size() != graph_ws.get_route().size()
+            || !if_valid_route(maze, graph_ws.get_route(), entry, exit)) {
+            throw std::runtime_error("Corridor graph route is not the shortest one!");
+        }
+    }
+    cout << "CorridorGraphTest passed!" << endl;
+    cout << endl;
+}
+
+void ComponentsTest() {
+    std::mt19937       rng(20230111);
+    Utility::Workspace ws;
+
+    for (int round = 0; round < 5; ++round) {
+        // random (non-maze) grid, so there're plenty of components
+        const int   size = 200 + round;
+        matrix<int> data(size, vector<int>(size, 0));
+        for (auto& row : data) {
+            for (auto& cell : row) {
+                cell = rng() % 100 < 55;
+            }
+        }
+        data[0][0] = data[size - 1][size - 1] = 1;
+        auto maze = Utility::Maze::create(data, { 0, 0 }, { size - 1, size - 1 });
+
+        vector<uint8_t> cells(size * size);
+        for (int i = 0; i < size * size; ++i) {
+            cells[i] = data[i / size][i % size];
+        }
+        auto serial   = Utility::Components::label(cells, size, 1);
+        auto parallel = Utility::Components::label(cells, size, 4);
+        if (serial.component_count() != parallel.component_count()) {
+            throw std::runtime_error("Parallel labelling disagrees with serial one!");
+        }
+        for (int query = 0; query < 200; ++query) {
+            coordinate entry = { rng() % size, rng() % size };
+            coordinate exit  = { rng() % size, rng() % size };
+            if (!data[entry.first][entry.second] || !data[exit.first][exit.second]) {
+                continue;
+            }
+            auto lhs = maze.to_index(entry);
+            auto rhs = maze.to_index(exit);
+            if (parallel.connected(lhs, rhs) != serial.connected(lhs, rhs)) {
+                throw std::runtime_error("Parallel labelling disagrees with serial one!");
+            }
+            // search on a freshly contracted graph, which never reads labels
+            bool if_reachable = Utility::CorridorGraph::build(cells, size, { lhs, rhs })
+                                    .route(ws, cells.size(), lhs, rhs);
+            if (if_reachable != maze.connected(entry, exit)) {
+                throw std::runtime_error("Component labels disagree with search!");
+            }
+        }
+    }
+    cout << "ComponentsTest passed!" << endl;
+    cout << endl;
+}
+
+void RouteIndexTest() {
+    static const auto path = FileManager::Dir::Root / "RouteIndexTest.idx";
+
+    std::mt19937       rng(20230112);
+    Utility::Workspace bfs_ws;
+    Utility::Workspace index_ws;
+
+    register_fixture();
+    auto data  = Resource::get()->get_data();
+    auto entry = Resource::get()->get_entry();
+    auto exit  = Resource::get()->get_exit();
+
+    for (int round = 0; round < 3; ++round) {
+        // every round changes the maze, so the index on disk goes stale
+        for (int i = 0; i < 8; ++i) {
+            data[rng() % data.size()][rng() % data.size()] = 1;
+        }
+        auto maze = Utility::Maze::create(data, entry, exit);
+        maze.load_route_index(path);
+
+        for (const coordinate& from : all_open_cells()) {
+            bool if_bfs   = maze.bfs_route(bfs_ws, from, exit);
+            bool if_index = maze.indexed_route(index_ws, from, exit);
+            if (if_bfs != if_index
+                || bfs_ws.get_route().size() != index_ws.get_route().size()
+                || (if_index && !if_valid_route(maze, index_ws.get_route(), from, exit))) {
+                throw std::runtime_error("Route index disagrees with bfs!");
+            }
+        }
+    }
+    FileManager::fs::remove(path);
+    cout << "RouteIndexTest passed!" << endl;
+    cout << endl;
+}
+
+void AsyncSolveTest() {
+    using state = Utility::AsyncResult::state;
+
+    // a wide open grid, so a full bfs takes a while
+    const int   size = 1500;
+    matrix<int> data(size, vector<int>(size, 1));
+    coordinate  entry = { 0, 0 };
+    coordinate  exit  = { size - 1, size - 1 };
+    auto        maze  = std::make_shared<const Utility::Maze>(
+        Utility::Maze::create(data, entry, exit)
+    );
+
+    auto full = Utility::solve_async(maze, entry, exit).get();
+    if (full.status != state::solved || full.route.size() != 2 * size - 1) {
+        throw std::runtime_error("Async solve did not finish the route!");
+    }
+
+    auto late = Utility::solve_async(
+        maze, entry, exit, {}, Utility::SolveBudget::within(std::chrono::seconds(0))
+    ).get();
+    if (late.status != state::timed_out
+        || late.route.empty()
+        || late.route.front() != entry
+        || late.expanded >= full.expanded) {
+        throw std::runtime_error("Async solve ignored its deadline!");
+    }
+
+    // a zero interval checks in on every expansion
+    auto eager = Utility::solve_async(
+        maze, entry, exit, {}, { Utility::SolveBudget::clock::now(), 0 }
+    ).get();
+    if (eager.status != state::timed_out || eager.expanded != 1) {
+        throw std::runtime_error("Async solve mishandled a zero check interval!");
+    }
+
+    Utility::CancellationToken token;
+    auto                       progress = std::make_shared<Utility::SolveProgress>();
+    auto                       pending  = Utility::solve_async(maze, entry, exit, token, {}, progress);
+    token.cancel();
+    auto cancelled = pending.get();
+    if (cancelled.status != state::cancelled && cancelled.status != state::solved) {
+        throw std::runtime_error("Async solve ended in an unexpected state!");
+    }
+    if (progress->expanded.load() != cancelled.expanded) {
+        throw std::runtime_error("Async solve did not publish its progress!");
+    }
+    cout << "AsyncSolveTest passed!" << endl;
+    cout << endl;
+}
+
+void LowMemorySolverTest() {
+    using Utility::LowMemorySolver;
+    static const auto path = FileManager::Dir::Root / "LowMemoryTest.grid";
+
+    std::mt19937       rng(20230114);
+    Utility::Workspace ws;
+
+    vector<LowMemorySolver::index_type> route;
+    for (int round = 0; round < 10; ++round) {
+        register_fixture();
+        auto data  = Resource::get()->get_data();
+        auto entry = Resource::get()->get_entry();
+        auto exit  = Resource::get()->get_exit();
+        // first half: perfect mazes, second half: with loops and islands
+        bool if_perfect = round < 5;
+        if (!if_perfect) {
+            for (int i = 0; i < 40; ++i) {
+                data[rng() % data.size()][rng() % data.size()] ^= 1;
+            }
+            data[entry.first][entry.second] = data[exit.first][exit.second] = 1;
+        }
+        auto maze = Utility::Maze::create(data, entry, exit);
+        Utility::GridFile::write(path, maze.get_cells(), maze.get_size(), entry, exit);
+        auto grid = Utility::GridFile::open(path, Utility::MappedFile::access::read_write);
+
+        bool if_bfs     = maze.bfs_route(ws, entry, exit);
+        bool if_tremaux = LowMemorySolver::tremaux_route(
+            grid.get_mutable_cells(),
+            grid.get_size(),
+            maze.to_index(entry),
+            maze.to_index(exit),
+            route
+        );
+        if (if_bfs != if_tremaux
+            || (if_tremaux && !if_valid_route(maze, route, entry, exit))
+            || (if_perfect && route.size() != ws.get_route().size())) {
+            throw std::runtime_error("Tremaux disagrees with bfs!");
+        }
+        if (!if_perfect) {
+            continue;
+        }
+        bool if_follower = LowMemorySolver::wall_follower_route(
+            grid.get_cells(),
+            grid.get_size(),
+            maze.to_index(entry),
+            maze.to_index(exit),
+            route
+        );
+        if (!if_follower
+            || !if_valid_route(maze, route, entry, exit)
+            || route.size() != ws.get_route().size()) {
+            throw std::runtime_error("Wall follower disagrees with bfs!");
+        }
+    }
+    FileManager::fs::remove(path);
+    cout << "LowMemorySolverTest passed!" << endl;
+    cout << endl;
+}
+
+void ExternalBfsTest() {
+    using Utility::ExternalBfs;
+    static const auto path = FileManager::Dir::Root / "ExternalBfsTest.tiles";
+
+    std::mt19937       rng(20230115);
+    Utility::Workspace ws;
+
+    // a few KiB only, so tiles get evicted and candidates spill into runs
+    const ExternalBfs::Config config { FileManager::Dir::Scratch, 16 << 10 };
+    for (int round = 0; round < 3; ++round) {
+        // not a multiple of the tile size, so the last tiles are padded
+        const int   size = 203 + round;
+        matrix<int> data(size, vector<int>(size, 0));
+        for (auto& row : data) {
+            for (auto& cell : row) {
+                cell = rng() % 100 < 62;
+            }
+        }
+        for (int query = 0; query < 5; ++query) {
+            coordinate entry = { rng() % size, rng() % size };
+            coordinate exit  = { rng() % size, rng() % size };
+            data[entry.first][entry.second] = data[exit.first][exit.second] = 1;
+            auto maze = Utility::Maze::create(data, entry, exit);
+            Utility::TiledGrid::build(maze.get_cells(), size, 16, path);
+
+            auto result = ExternalBfs::solve(
+                path,
+                { entry.first, entry.second },
+                { exit.first, exit.second },
+                config
+            );
+            bool if_bfs = maze.bfs_route(ws, entry, exit);
+
+            vector<Utility::Maze::index_type> route;
+            for (auto [x, y] : result.route) {
+                route.push_back(maze.to_index({ static_cast<int>(x), static_cast<int>(y) }));
+            }
+            if (result.found != if_bfs
+                || (if_bfs && route.size() != ws.get_route().size())
+                || (if_bfs && !if_valid_route(maze, route, entry, exit))) {
+                throw std::runtime_error("External bfs disagrees with bfs!");
+            }
+        }
+    }
+
+    // two solves at once in the same scratch directory, each in its own files
+    {
+        const int   size = 301;
+        matrix<int> data(size, vector<int>(size, 1));
+        auto        maze = Utility::Maze::create(data, { 0, 0 }, { size - 1, size - 1 });
+        Utility::TiledGrid::build(maze.get_cells(), size, 16, path);
+
+        ExternalBfs::Result results[2];
+        std::thread         other([&] { results[1] = ExternalBfs::solve(path, { 0, 0 }, { size - 1, 0 }, config); });
+        results[0] = ExternalBfs::solve(path, { 0, 0 }, { size - 1, size - 1 }, config);
+        other.join();
+        if (!results[0].found || results[0].levels != 2 * (size - 1)
+            || !results[1].found || results[1].levels != size - 1
+            || !FileManager::fs::is_empty(FileManager::Dir::Scratch)) {
+            throw std::runtime_error("External bfs solves collided in the scratch directory!");
+        }
+    }
+
+    // runs far beyond what one pass may open are merged in several passes
+    {
+        const auto             sorted = FileManager::Dir::Scratch / "SorterTest.run";
+        Utility::ExternalSorter sorter { FileManager::Dir::Scratch, "sorter", 1 << 10, 32 };
+        vector<uint64_t>        records(50000);
+        for (auto& record : records) {
+            record = rng() % 1000;
+            sorter.push(record);
+        }
+        std::sort(records.begin(), records.end());
+        vector<uint64_t> merged;
+        {
+            sorter.finish(sorted);
+            Utility::RunReader reader { sorted };
+            for (uint64_t record = 0; reader.next(record);) {
+                merged.push_back(record);
+            }
+        }
+        FileManager::fs::remove(sorted);
+        if (merged != records || !FileManager::fs::is_empty(FileManager::Dir::Scratch)) {
+            throw std::runtime_error("Multi-pass merge lost or misplaced records!");
+        }
+    }
+    FileManager::fs::remove(path);
+    cout << "ExternalBfsTest passed!" << endl;
+    cout << endl;
+}
+
+void LayoutTest() {
+    static const auto path = FileManager::Dir::Root / "LayoutTest.grid";
+
+    std::mt19937       rng(20230116);
+    Utility::Workspace ws;
+
+    for (int size : { 31, 32, 45, 97 }) {
+        matrix<int> data(size, vector<int>(size, 0));
+        for (auto& row : data) {
+            for (auto& cell : row) {
+                cell = rng() % 100 < 62;
+            }
+        }
+        for (int query = 0; query < 20; ++query) {
+            coordinate entry = { rng() % size, rng() % size };
+            coordinate exit  = { rng() % size, rng() % size };
+            data[entry.first][entry.second] = data[exit.first][exit.second] = 1;
+
+            auto maze = Utility::Maze::create(data, entry, exit);
+            bool if_row_major = maze.bfs_route(ws, entry, exit);
+            auto length       = ws.get_route().size();
+
+            maze.set_layout(Utility::layout::tiled_morton);
+            bool if_tiled = maze.bfs_route(ws, entry, exit);
+            if (if_tiled != if_row_major
+                || (if_tiled && ws.get_route().size() != length)
+                || (if_tiled && !if_valid_route(maze, ws.get_route(), entry, exit))) {
+                throw std::runtime_error("Tiled layout disagrees with row-major!");
+            }
+        }
+
+        // the file keeps its layout, cells are found through the same policy
+        vector<uint8_t> cells(size * size);
+        for (int i = 0; i < size * size; ++i) {
+            cells[i] = data[i / size][i % size];
+        }
+        Utility::GridFile::write(path, cells, size, {}, {}, Utility::layout::tiled_morton);
+        auto                       grid = Utility::GridFile::open(path);
+        Utility::TiledMortonLayout tiles { static_cast<size_t>(size) };
+        if (grid.get_layout() != Utility::layout::tiled_morton
+            || grid.cell_count() != tiles.cell_count()) {
+            throw std::runtime_error("Grid file lost its layout!");
+        }
+        for (int x = 0; x < size; ++x) {
+            for (int y = 0; y < size; ++y) {
+                if ((grid.get_cells()[tiles.to_index(x, y)] != 0) != (data[x][y] != 0)) {
+                    throw std::runtime_error("Tiled grid file mismatches the maze!");
+                }
+            }
+        }
+    }
+    FileManager::fs::remove(path);
+    cout << "LayoutTest passed!" << endl;
+    cout << endl;
+}
+
+void ImageExportTest() {
+    using Utility::ImageExport;
+    using Utility::image_format;
+    static const auto path = FileManager::Dir::Root / "ImageExportTest.img";
+
+    Utility::Workspace ws;
+
+    auto read_all = [](const FileManager::fs::path& path) {
+        std::ifstream file { path, std::ios::binary };
+        return std::string { std::istreambuf_iterator<char>(file), {} };
+    };
+
+    for (int round = 0; round < 3; ++round) {
+        register_fixture();
+        auto maze = Resource::get();
+        if (!maze->bfs_route(ws, maze->get_entry(), maze->get_exit())) {
+            throw std::runtime_error("Generated maze has no route!");
+        }
+        const size_t size = maze->get_size();
+        const auto   cord = [&](size_t x, size_t y) {
+            return coordinate { static_cast<int>(x), static_cast<int>(y) };
+        };
+
+        // pgm, one pixel per cell: every cell is shown as it is
+        ImageExport::write(path, maze->get_cells(), size, ws.get_route(), image_format::pgm);
+        auto        pgm    = read_all(path);
+        std::string header = "P5\n" + std::to_string(size) + " " + std::to_string(size) + "\n255\n";
+        if (pgm.size() != header.size() + size * size || pgm.compare(0, header.size(), header) != 0) {
+            throw std::runtime_error("Bad pgm layout!");
+        }
+        auto overlay = maze->overlay_route(ws.get_route());
+        for (size_t x = 0; x < size; ++x) {
+            for (size_t y = 0; y < size; ++y) {
+                auto pixel = static_cast<uint8_t>(pgm[header.size() + maze->to_index(cord(x, y))]);
+                int  kind  = overlay[x][y];
+                if ((kind == 0) != (pixel == 0) || (kind == 2) != (pixel != 0 && pixel != 255)) {
+                    throw std::runtime_error("Pgm pixel mismatches the maze!");
+                }
+            }
+        }
+
+        // pbm downscaled by 2, rows padded to whole bytes
+        ImageExport::write(path, maze->get_cells(), size, ws.get_route(), image_format::pbm, 2);
+        const size_t side = (size + 1) / 2;
+        header            = "P4\n" + std::to_string(side) + " " + std::to_string(side) + "\n";
+        if (read_all(path).size() != header.size() + side * ((side + 7) / 8)) {
+            throw std::runtime_error("Bad pbm layout!");
+        }
+
+        // png: well-formed chunks, much smaller than the text output
+        ImageExport::write(path, maze->get_cells(), size, ws.get_route(), image_format::png);
+        auto png = read_all(path);
+        if (png.compare(0, 8, "\x89PNG\r\n\x1a\n") != 0
+            || png.compare(png.size() - 8, 4, "IEND") != 0
+            || png.size() * 4 > size * size * 2) {
+            throw std::runtime_error("Bad png layout!");
+        }
+
+        // ... whose IDAT stream inflates to the overlay, 2 bits per pixel
+        const auto      bytes = std::span { reinterpret_cast<const uint8_t*>(png.data()), png.size() };
+        vector<uint8_t> idat;
+        for (size_t at = 8; at + 12 <= bytes.size();) {
+            const size_t length = size_t(bytes[at]) << 24 | size_t(bytes[at + 1]) << 16
+                                | size_t(bytes[at + 2]) << 8 | bytes[at + 3];
+            Utility::Crc32 crc;
+            crc.update(bytes.subspan(at + 4, length + 4));
+            const size_t end = at + 8 + length;
+            if (crc.value() != (uint32_t(bytes[end]) << 24 | uint32_t(bytes[end + 1]) << 16 | uint32_t(bytes[end + 2]) << 8 | bytes[end + 3])) {
+                throw std::runtime_error("Bad png chunk crc!");
+            }
+            if (png.compare(at + 4, 4, "IDAT") == 0) {
+                idat.insert(idat.end(), bytes.begin() + at + 8, bytes.begin() + end);
+            }
+            at = end + 4;
+        }
+        const auto   pixels = Utility::Inflater::inflate(idat);
+        const size_t stride = 1 + (size + 3) / 4;
+        if (pixels.size() != size * stride) {
+            throw std::runtime_error("Png rows have the wrong size!");
+        }
+        for (size_t x = 0; x < size; ++x) {
+            if (pixels[x * stride] != 0) {
+                throw std::runtime_error("Png row is filtered!");
+            }
+            for (size_t y = 0; y < size; ++y) {
+                const int pixel = pixels[x * stride + 1 + y / 4] >> (6 - 2 * (y % 4)) & 0b11;
+                if (pixel != std::array { 0, 3, 2 }[overlay[x][y]]) {
+                    throw std::runtime_error("Png pixel mismatches the maze!");
+                }
+            }
+        }
+    }
+    FileManager::fs::remove(path);
+    cout << "ImageExportTest passed!" << endl;
+    cout << endl;
+}
+
+void WorkloadTest() {
+    using Utility::WorkloadGenerator;
+
+    Utility::Workspace ws;
+
+    // same seed => same maze, other seed => other maze
+    Utility::WorkloadConfig config;
+    config.size          = 61;
+    config.corridor_bias = 0.5;
+    config.braid         = 0.3;
+    config.room_density  = 0.1;
+    auto lhs             = WorkloadGenerator::generate(config);
+    auto rhs             = WorkloadGenerator::generate(config);
+    config.seed += 1;
+    auto other = WorkloadGenerator::generate(config);
+    if (lhs.data != rhs.data || lhs.entry != rhs.entry || lhs.exit != rhs.exit || lhs.data == other.data) {
+        throw std::runtime_error("Workload is not determined by its seed!");
+    }
+
+    // untouched knobs give a perfect maze: a spanning tree of the cells
+    auto perfect = WorkloadGenerator::generate(Utility::WorkloadConfig {});
+    int  cells   = 0;
+    int  edges   = 0;
+    for (size_t x = 0; x < perfect.data.size(); ++x) {
+        for (size_t y = 0; y < perfect.data.size(); ++y) {
+            if (!perfect.data[x][y]) {
+                continue;
+            }
+            ++cells;
+            edges += x + 1 < perfect.data.size() && perfect.data[x + 1][y];
+            edges += y + 1 < perfect.data.size() && perfect.data[x][y + 1];
+        }
+    }
+    if (edges != cells - 1) {
+        throw std::runtime_error("Default workload is not a perfect maze!");
+    }
+
+    for (auto& workload : WorkloadGenerator::corpus(81, 7)) {
+        auto maze = Utility::Maze::create(workload.data, workload.entry, workload.exit);
+        if (!maze.bfs_route(ws, workload.entry, workload.exit)) {
+            throw std::runtime_error("Workload endpoints are disconnected!");
+        }
+        if (workload.name != "perfect") {
+            continue;
+        }
+        // on a tree the double sweep is exact: nothing is farther from entry
+        const auto length = ws.get_route().size();
+        for (auto cord : all_open_cells_of(workload.data)) {
+            maze.bfs_route(ws, workload.entry, cord);
+            if (ws.get_route().size() > length) {
+                throw std::runtime_error("Farthest pair is not the farthest!");
+            }
+        }
+    }
+    cout << "WorkloadTest passed!" << endl;
+    cout << endl;
+}
+
+void PortfolioTest() {
+    Utility::Workspace ws;
+    Utility::Workspace back;
+
+    // every racer is exact: same lengths as bfs on every kind of maze
+    for_each_corpus_query(61, 11, 100, [&](const CorpusQuery& query) {
+        auto& [workload, maze, entry, exit, found, route, index] = query;
+        bool  if_found = maze.bidirectional_route(ws, back, entry, exit);
+        expect_shortest("Bidirectional bfs", query, if_found, ws.get_route());
+        if_found = maze.a_star_route(ws, entry, exit);
+        expect_shortest("A*", query, if_found, ws.get_route());
+        auto result = Utility::solve_portfolio(maze, entry, exit);
+        expect_shortest("Portfolio", query, result.if_found, result.route);
+    });
+
+    // two halves split by a wall: answered at once, whoever wins
+    matrix<int> split(31, vector<int>(31, 1));
+    for (auto& row : split) {
+        row[15] = 0;
+    }
+    auto maze = Utility::Maze::create(split, { 0, 0 }, { 30, 30 });
+    if (Utility::solve_portfolio(maze, { 0, 0 }, { 30, 30 }).if_found) {
+        throw std::runtime_error("Portfolio found a route through a wall!");
+    }
+
+    // a wide open grid: a* walks straight there, the others get cancelled
+    const int   size = 1500;
+    matrix<int> open(size, vector<int>(size, 1));
+    auto        grid   = Utility::Maze::create(open, { 0, 0 }, { size - 1, size - 1 });
+    auto        result = Utility::solve_portfolio(grid, { 0, 0 }, { size - 1, size - 1 });
+    if (result.route.size() != 2 * size - 1) {
+        throw std::runtime_error("Portfolio lost the route on an open grid!");
+    }
+    cout << "PortfolioTest passed! (open grid won by " << Utility::name_of(result.winner) << ")" << endl;
+    cout << endl;
+}
+
+void ParallelAStarTest() {
+    Utility::Workspace ws;
+
+    // optimal on every kind of maze, whatever the number of threads; a single
+    // thread sends nothing, and every cell of the route but the exit is expanded
+    for_each_corpus_query(61, 13, 40, [&](const CorpusQuery& query) {
+        const size_t threads = 1 + query.index % 4;
+        auto         result  = Utility::hda_star(query.maze, query.entry, query.exit, threads);
+        expect_shortest("HDA*", query, result.if_found, result.route);
+        if (result.threads != threads || (threads == 1 && result.messages != 0)
+            || (result.if_found && result.expanded + 1 < result.route.size())) {
+            throw std::runtime_error("HDA* miscounted on " + query.workload.name + "!");
+        }
+    });
+
+    // one winding corridor on many threads: a single open node at a time, so
+    // all but its owner are idle, woken by every message, until all run dry
+    matrix<int> snake(31, vector<int>(31, 0));
+    for (int i = 0; i < 31; ++i) {
+        for (int j = 0; j < 31; ++j) {
+            snake[i][j] = i % 2 == 0 || j == (i % 4 == 1 ? 30 : 0);
+        }
+    }
+    auto maze = Utility::Maze::create(snake, { 0, 0 }, { 30, 30 });
+    maze.bfs_route(ws, { 0, 0 }, { 30, 30 });
+    for (size_t threads : { 2, 8, 16 }) {
+        for (int round = 0; round < 20; ++round) {
+            auto result = Utility::hda_star(maze, { 0, 0 }, { 30, 30 }, threads);
+            if (!result.if_found || result.route.size() != ws.get_route().size() || result.messages == 0
+                || result.expanded + 1 < result.route.size()) {
+                throw std::runtime_error("HDA* went wrong on a corridor!");
+            }
+        }
+    }
+
+    // open rooms: same length as a* (timings are in `ParallelAStarBenchmark`)
+    Utility::WorkloadConfig config;
+    config.size         = 1001;
+    config.room_density = 0.6;
+    config.room_max     = 61;
+    config.braid        = 1.0;
+    auto workload = Utility::WorkloadGenerator::generate(config);
+    auto rooms    = Utility::Maze::create(workload.data, workload.entry, workload.exit);
+    rooms.a_star_route(ws, workload.entry, workload.exit);
+    if (Utility::hda_star(rooms, workload.entry, workload.exit, 4).route.size() != ws.get_route().size()) {
+        throw std::runtime_error("HDA* is not shortest on open rooms!");
+    }
+    cout << "ParallelAStarTest passed!" << endl;
+    cout << endl;
+}
+
+void SolverSelectionTest() {
+    using Utility::selected_solver;
+    Utility::Workspace ws;
+
+    // the calibrated picks on the corpus, and shortest routes whatever the pick
+    static constexpr selected_solver expected[] = {
+        selected_solver::tree,   /* perfect */
+        selected_solver::tree,   /* corridors */
+        selected_solver::bfs,    /* braided */
+        selected_solver::a_star, /* rooms */
+        selected_solver::a_star, /* open */
+    };
+    size_t                          kind = 0;
+    vector<Utility::AdaptiveSolver> solvers;
+    auto                            pick = [&](const Utility::Workload& workload, Utility::Maze& maze) {
+        solvers.clear();
+        for (size_t queries : { 1, 1000 }) {
+            const auto& solver = solvers.emplace_back(maze, queries);
+            const auto  want   = queries > 1 && !maze.is_perfect() ? selected_solver::alt : expected[kind];
+            if (solver.get_choice().solver != want || solver.get_choice().reason.empty()) {
+                throw std::runtime_error("Auto mode picked " + solver.get_choice().describe() + " on " + workload.name + "!");
+            }
+        }
+        ++kind;
+        return true;
+    };
+    for_each_corpus_query(301, 19, 20, pick, [&](const CorpusQuery& query) {
+        for (const auto& solver : solvers) {
+            const bool if_found = solver.route(ws, query.entry, query.exit);
+            expect_shortest("Auto mode", query, if_found, ws.get_route());
+        }
+    });
+
+    // small mazes never pay for a heuristic
+    auto small = Utility::WorkloadGenerator::corpus(61, 19).back();
+    auto maze  = Utility::Maze::create(small.data, small.entry, small.exit);
+    if (Utility::AdaptiveSolver { maze }.get_choice().solver != selected_solver::bfs) {
+        throw std::runtime_error("Auto mode picked a heuristic on a small maze!");
+    }
+    cout << "SolverSelectionTest passed!" << endl;
+    cout << endl;
+}
+
+void BoundedSearchTest() {
+    vector<uint32_t> route;
+
+    // shortest on every kind of maze, also with a table far smaller than the
+    // maze. Every query finishes, but on trees in the smallest budget, whose
+    // path of 256 cells is shorter than many of their dead ends
+    for (size_t budget : { size_t(1) << 20, size_t(64) << 10, size_t(16) << 10 }) {
+        // { finished, floor } of each maze
+        std::map<std::string, std::pair<size_t, size_t>> finished;
+        auto                                              floor = [&](const Utility::Workload& workload, Utility::Maze& maze) {
+            finished[workload.name] = { 0, maze.is_perfect() && budget == (size_t(16) << 10) ? 10 : 40 };
+            return true;
+        };
+        for_each_corpus_query(61, 23, 40, floor, [&](const CorpusQuery& query) {
+            auto stats = query.maze.bounded_route(route, query.entry, query.exit, { budget });
+            if (stats.status == Utility::search_status::stopped) {
+                return;
+            }
+            ++finished[query.workload.name].first;
+            expect_shortest("IDA*", query, stats.status == Utility::search_status::found, route);
+            if (stats.peak_bytes > budget) {
+                throw std::runtime_error("IDA* outgrew its budget on " + query.workload.name + "!");
+            }
+        });
+        for (const auto& [name, count] : finished) {
+            if (count.first < count.second) {
+                throw std::runtime_error("IDA* stopped too often on " + name + "!");
+            }
+        }
+    }
+
+    // a route longer than the path budget stops, and the solution falls back to bfs
+    auto workload = Utility::WorkloadGenerator::corpus(101, 23).front();
+    auto maze     = Utility::Maze::create(workload.data, workload.entry, workload.exit);
+    auto stats    = maze.bounded_route(route, workload.entry, workload.exit, { 1024 });
+    if (stats.status != Utility::search_status::stopped || stats.peak_bytes > 1024) {
+        throw std::runtime_error("IDA* outgrew its memory budget!");
+    }
+    auto [if_solved, answer, entry, exit] = maze.bounded_solution({ 1024 });
+    auto [if_bfs_solved, bfs_answer, bfs_entry, bfs_exit] = maze.bfs_solution();
+    if (!if_solved || answer != bfs_answer || maze.get_bounded_stats().status != Utility::search_status::stopped) {
+        throw std::runtime_error("IDA* did not fall back to bfs!");
+    }
+    auto [if_bounded, bounded_answer, _entry, _exit] = maze.bounded_solution();
+    if (!if_bounded || bounded_answer != bfs_answer) {
+        throw std::runtime_error("IDA* solution differs from bfs!");
+    }
+    cout << "BoundedSearchTest passed! (" << maze.get_bounded_stats().expanded << " expansions, "
+         << maze.get_bounded_stats().peak_bytes << " bytes on a " << workload.name << " maze)" << endl;
+    cout << endl;
+}
+
+void TreeIndexTest() {
+    std::mt19937       rng(20230120);
+    Utility::Workspace ws;
+    Utility::Workspace tree_ws;
+
+    // the fixtures, dug like `Generator`'s mazes, are flagged perfect
+    register_fixture();
+    if (!Resource::get()->is_perfect()) {
+        throw std::runtime_error("Fixture maze is not flagged perfect!");
+    }
+
+    // so are the trees of the corpus, and they are solved on their tree
+    auto if_tree = [](const Utility::Workload& workload, Utility::Maze& maze) {
+        if (maze.is_perfect() != (workload.name == "perfect" || workload.name == "corridors")) {
+            throw std::runtime_error("Perfect flag is wrong on " + workload.name + "!");
+        }
+        return maze.is_perfect();
+    };
+    for_each_corpus_query(101, 5, 2000, if_tree, [&](const CorpusQuery& query) {
+        auto& [workload, maze, entry, exit, found, route, index] = query;
+        if (!maze.tree_route(tree_ws, entry, exit)
+            || !std::ranges::equal(route, tree_ws.get_route())
+            || maze.tree_distance(entry, exit) + 1 != route.size()) {
+            throw std::runtime_error("Tree route disagrees with bfs on " + workload.name + "!");
+        }
+
+        // a wall at either end: no route, like bfs, and nothing read off the tree
+        if (index >= 200) {
+            return;
+        }
+        const int  size = static_cast<int>(workload.data.size());
+        coordinate wall = { static_cast<int>(rng() % size), static_cast<int>(rng() % size) };
+        if (workload.data[wall.first][wall.second]) {
+            return;
+        }
+        for (auto [from, to] : { std::pair { entry, wall }, std::pair { wall, entry }, std::pair { wall, wall } }) {
+            if (maze.bfs_route(ws, from, to)
+                || maze.tree_route(tree_ws, from, to)
+                || !tree_ws.get_route().empty()
+                || maze.tree_distance(from, to) != Utility::Workspace::npos) {
+                throw std::runtime_error("Tree route to a wall!");
+            }
+        }
+    });
+    cout << "TreeIndexTest passed!" << endl;
+    cout << endl;
+}
+
+void NearestExitTest() {
+    Utility::Workspace ws;
+    Utility::Workspace nearest_ws;
+
+    // every border cell is an exit, from the entry of each query
+    vector<coordinate>                exits;
+    std::optional<Utility::ExitField> field;
+    auto                              all_exits = [&](const Utility::Workload&, Utility::Maze& maze) {
+        exits = maze.border_cells();
+        field.emplace(maze.exit_field(exits));
+        return true;
+    };
+    for_each_corpus_query(41, 3, 50, all_exits, [&](const CorpusQuery& query) {
+        auto& [workload, maze, entry, exit, found, route, index] = query;
+
+        // the old way: one bfs per exit, keep the shortest
+        size_t shortest = SIZE_MAX;
+        for (auto border : exits) {
+            if (maze.bfs_route(ws, entry, border)) {
+                shortest = std::min(shortest, ws.get_route().size());
+            }
+        }
+
+        const bool if_found = maze.nearest_route(nearest_ws, entry, exits);
+        const auto reached  = if_found ? maze.to_coordinate(nearest_ws.get_route().back()) : entry;
+        if (if_found != (shortest != SIZE_MAX)
+            || (if_found
+                && (nearest_ws.get_route().size() != shortest
+                    || std::ranges::find(exits, reached) == exits.end()
+                    || !if_valid_route(maze, nearest_ws.get_route(), entry, reached)))) {
+            throw std::runtime_error("Nearest exit disagrees with bfs on " + workload.name + "!");
+        }
+
+        const auto idx = maze.to_index(entry);
+        if (field->route(ws, idx) != if_found
+            || (if_found
+                && (field->get_distance(idx) + 1 != shortest
+                    || ws.get_route().size() != shortest
+                    || std::ranges::find(exits, maze.to_coordinate(ws.get_route().back())) == exits.end()))) {
+            throw std::runtime_error("Exit field disagrees with bfs on " + workload.name + "!");
+        }
+    });
+
+    // no exit in reach: a walled-in cell
+    matrix<int> boxed(5, vector<int>(5, 1));
+    boxed[1][2] = boxed[3][2] = boxed[2][1] = boxed[2][3] = 0;
+    auto maze = Utility::Maze::create(boxed, { 0, 0 }, { 4, 4 });
+    exits     = maze.border_cells();
+    if (exits.size() != 16 || maze.nearest_route(ws, { 2, 2 }, exits)) {
+        throw std::runtime_error("Nearest exit found a way out of a box!");
+    }
+    cout << "NearestExitTest passed!" << endl;
+    cout << endl;
+}
+
+void AnalyticsTest() {
+    for (auto& workload : Utility::WorkloadGenerator::corpus(41, 9)) {
+        auto maze = Utility::Maze::create(workload.data, workload.entry, workload.exit);
+
+        // brute force: degrees, and a bfs from every reachable cell
+        const auto& data      = workload.data;
+        const int   size      = static_cast<int>(data.size());
+        size_t      dead_ends = 0;
+        size_t      junctions = 0;
+        size_t      node_ends = 0;
+        size_t      reachable = 0;
+        size_t      diameter  = 0;
+        for (auto cord : all_open_cells_of(data)) {
+            auto [x, y] = cord;
+            int degree  = (x > 0 && data[x - 1][y]) + (x + 1 < size && data[x + 1][y])
+                       + (y > 0 && data[x][y - 1]) + (y + 1 < size && data[x][y + 1]);
+            dead_ends += degree == 1;
+            junctions += degree >= 3;
+            node_ends += degree != 2 ? degree : 0;
+            if (!maze.connected(workload.entry, cord)) {
+                continue;
+            }
+            ++reachable;
+            // eccentricity of `cord`: the last level of a bfs over the matrix
+            matrix<int>        dist(size, vector<int>(size, -1));
+            vector<coordinate> queue = { cord };
+            dist[x][y]               = 0;
+            for (size_t head = 0; head < queue.size(); ++head) {
+                auto [i, j] = queue[head];
+                diameter    = std::max(diameter, static_cast<size_t>(dist[i][j]));
+                for (auto [di, dj] : { std::pair { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } }) {
+                    int ni = i + di;
+                    int nj = j + dj;
+                    if (ni >= 0 && ni < size && nj >= 0 && nj < size && data[ni][nj] && dist[ni][nj] == -1) {
+                        dist[ni][nj] = dist[i][j] + 1;
+                        queue.emplace_back(ni, nj);
+                    }
+                }
+            }
+        }
+
+        // a budget large enough for iFUB to close the bounds
+        auto metrics     = Utility::MazeAnalytics::analyze(maze, { 1, 100000 });
+        auto in_parallel = Utility::MazeAnalytics::analyze(maze, { 4, 100000 });
+        metrics.seconds = in_parallel.seconds = 0;
+
+        size_t histogram = 0;
+        for (size_t count : metrics.corridor_lengths) {
+            histogram += count;
+        }
+        if (metrics.dead_ends != dead_ends
+            || metrics.junctions != junctions
+            || metrics.reachable_cells != reachable
+            || metrics.corridors * 2 != node_ends
+            || histogram != metrics.corridors
+            || metrics.components != maze.get_components().component_count()) {
+            throw std::runtime_error("Analytics miscounted " + workload.name + "!");
+        }
+        if (!metrics.diameter_exact || metrics.diameter != diameter) {
+            throw std::runtime_error("Analytics got the diameter of " + workload.name + " wrong!");
+        }
+        if (metrics.to_json() != in_parallel.to_json()) {
+            throw std::runtime_error("Analytics depends on the thread count on " + workload.name + "!");
+        }
+
+        // straight from grid cells, marks in the spare bits as a mapped `GridFile` may have
+        vector<uint8_t> marked { maze.get_cells().begin(), maze.get_cells().end() };
+        for (size_t idx = 0; idx < marked.size(); idx += 3) {
+            marked[idx] |= 0b111100;
+        }
+        auto from_cells    = Utility::MazeAnalytics::analyze(marked, maze.get_size(), workload.entry, { 2, 100000 });
+        from_cells.seconds = 0;
+        if (from_cells.to_json() != metrics.to_json()) {
+            throw std::runtime_error("Analytics of the cells differ from the maze on " + workload.name + "!");
+        }
+
+        // out of budget: bounds still hold
+        auto bounded = Utility::MazeAnalytics::analyze(maze, { 2, 3 });
+        if (bounded.diameter > diameter || bounded.diameter_upper < diameter) {
+            throw std::runtime_error("Analytics bounds exclude the diameter of " + workload.name + "!");
+        }
+    }
+    cout << "AnalyticsTest passed!" << endl;
+    cout << endl;
+}
+
+void SearchPolicyTest() {
+    using namespace Utility;
+    Workspace ws;
+
+    // every combination is exact: found together, same lengths
+    for (auto cell_layout : { layout::row_major, layout::tiled_morton }) {
+        auto with_layout = [&](const Workload&, Maze& maze) {
+            maze.set_layout(cell_layout);
+            maze.prepare_landmarks(4);
+            return true;
+        };
+        for_each_corpus_query(61, 13, 40, with_layout, [&](const CorpusQuery& query) {
+            auto& [workload, maze, entry, exit, found, route, index] = query;
+            ManhattanHeuristic manhattan {
+                static_cast<size_t>(exit.first),
+                static_cast<size_t>(exit.second),
+            };
+            const std::pair<std::string, std::function<search_status()>> policies[] = {
+                { "Bitset bfs", [&]() { return maze.policy_search<FifoOpen, BitsetVisited>(ws, entry, exit, NoHeuristic {}, Maze::no_monitor {}); } },
+                { "Dijkstra", [&]() { return maze.policy_search<HeapOpen>(ws, entry, exit, NoHeuristic {}, Maze::no_monitor {}); } },
+                { "Bucket Dijkstra", [&]() { return maze.policy_search<BucketOpen>(ws, entry, exit, NoHeuristic {}, Maze::no_monitor {}); } },
+                { "Bitset a*", [&]() { return maze.policy_search<HeapOpen, BitsetVisited>(ws, entry, exit, manhattan, Maze::no_monitor {}); } },
+                { "Bucket a*", [&]() { return maze.policy_search<BucketOpen>(ws, entry, exit, manhattan, Maze::no_monitor {}); } },
+                { "A*", [&]() { return maze.a_star_search(ws, entry, exit, Maze::no_monitor {}); } },
+                { "ALT", [&]() { return maze.alt_search(ws, entry, exit, Maze::no_monitor {}); } },
+            };
+            for (const auto& [name, search] : policies) {
+                const bool if_found = search() == search_status::found;
+                expect_shortest(name, query, if_found, ws.get_route());
+            }
+        });
+    }
+
+    // a monitored search stops with a partial route from the entry
+    matrix<int> open(64, vector<int>(64, 1));
+    auto        maze   = Maze::create(open, { 0, 0 }, { 63, 63 });
+    auto        status = maze.policy_search<BucketOpen, BitsetVisited>(
+        ws, { 0, 0 }, { 63, 63 }, NoHeuristic {}, [](size_t expanded) { return expanded < 100; }
+    );
+    if (status != search_status::stopped || ws.get_route().empty() || ws.get_route().front() != 0) {
+        throw std::runtime_error("Monitored search did not stop!");
+    }
+
+    // landmarks make the estimate exact along a single corridor
+    maze.prepare_landmarks(2);
+    AltHeuristic alt { maze.get_landmarks(), maze.to_index({ 63, 63 }) };
+    if (alt(0, 0) != 126) {
+        throw std::runtime_error("ALT estimate is not exact from a landmark!");
+    }
+    cout << "SearchPolicyTest passed!" << endl;
+    cout << endl;
+}
+
+void TraceReplayTest() {
+    static const auto path = FileManager::Dir::Root / "ReplayTest.trace";
+
+    // percentiles stay within a bucket (1 / 256) of the exact ones
+    std::mt19937_64            rng(20230123);
+    vector<uint64_t>           values;
+    Utility::LatencyHistogram  whole;
+    Utility::LatencyHistogram  halves[2];
+    for (int i = 0; i < 100000; ++i) {
+        // heavy tailed, from nanoseconds to seconds
+        uint64_t value = rng() >> (rng() % 64);
+        values.push_back(value);
+        whole.record(value);
+        halves[i % 2].record(value);
+    }
+    halves[0].merge(halves[1]);
+    std::ranges::sort(values);
+    for (double percentile : { 0.0, 1.0, 50.0, 90.0, 99.0, 99.9, 100.0 }) {
+        auto rank  = std::max<size_t>(1, static_cast<size_t>(std::ceil(percentile / 100 * values.size())));
+        auto exact = values[rank - 1];
+        auto got   = whole.value_at(percentile);
+        if (got < exact || got - exact > exact / Utility::LatencyHistogram::sub_buckets
+            || halves[0].value_at(percentile) != got) {
+            throw std::runtime_error("Histogram percentile is off!");
+        }
+    }
+    if (whole.count() != values.size() || whole.min() != values.front() || whole.max() != values.back()) {
+        throw std::runtime_error("Histogram lost a value!");
+    }
+
+    // a synthetic trace survives a round trip, and replays every query
+    Module::Replayer::record(path, 400, 2, 61, 20230123);
+    auto trace = Utility::Trace::read(path);
+    if (trace.grids.size() != 2 || trace.records.size() != 400) {
+        throw std::runtime_error("Trace lost a maze or a query!");
+    }
+    trace.write(path);
+    auto again = Utility::Trace::read(path);
+    for (size_t i = 0; i < trace.records.size(); ++i) {
+        const auto& lhs = trace.records[i];
+        const auto& rhs = again.records[i];
+        if (lhs.maze != rhs.maze || lhs.entry != rhs.entry || lhs.exit != rhs.exit
+            || lhs.algorithm != rhs.algorithm || trace.grids != again.grids) {
+            throw std::runtime_error("Trace changed on a round trip!");
+        }
+    }
+
+    vector<std::shared_ptr<const Utility::Maze>> mazes;
+    for (const auto& grid : trace.grids) {
+        mazes.push_back(Module::Daemon::load(grid));
+    }
+    auto closed = Utility::TraceReplayer::replay(mazes, trace.records, { 2, 0, 3 });
+    if (closed.queries != 1200 || closed.found != 1200 || closed.latency.count() != 1200) {
+        throw std::runtime_error("Closed loop replay lost a query!");
+    }
+
+    // open loop: 400 queries due over 0.1 s can't finish much sooner
+    auto open = Utility::TraceReplayer::replay(mazes, trace.records, { 2, 4000, 1 });
+    if (open.queries != 400 || open.found != 400 || open.seconds < 0.099) {
+        throw std::runtime_error("Open loop replay ignored the rate!");
+    }
+    for (const auto& grid : trace.grids) {
+        FileManager::fs::remove(grid);
+    }
+    FileManager::fs::remove(path);
+    cout << "TraceReplayTest passed! (closed loop " << closed.to_json() << ")" << endl;
+    cout << endl;
+}
+
+void ChunkedMazeTest() {
+    using Utility::ChunkedMaze;
+    using Utility::world_coordinate;
+    static constexpr int64_t side = ChunkedMaze::chunk_side;
+
+    // a chunk is the same whatever the order or the cache size
+    std::mt19937_64 rng(20230124);
+    ChunkedMaze     roomy { 7, 64 * ChunkedMaze::chunk_cells };
+    ChunkedMaze     cramped { 7, 2 * ChunkedMaze::chunk_cells };
+    for (int i = 0; i < 20000; ++i) {
+        auto x = static_cast<int64_t>(rng() % (8 * side)) - 4 * side;
+        auto y = static_cast<int64_t>(rng() % (8 * side)) - 4 * side;
+        if (roomy.is_open(x, y) != cramped.is_open(x, y)) {
+            throw std::runtime_error("Chunk changed after eviction!");
+        }
+    }
+    if (cramped.cached_chunks() > 2 || cramped.get_misses() <= roomy.get_misses()) {
+        throw std::runtime_error("Chunk cache ignored its cap!");
+    }
+
+    // 4 x 4 chunks around the origin: connected, as a perfect maze inside
+    //  each chunk plus one door per shared border
+    const auto data = roomy.window(-2 * side, -2 * side, 4 * side);
+    auto       maze = Utility::Maze::create(data, { 0, 0 }, { 4 * side - 2, 4 * side - 2 });
+    if (maze.get_components().component_count() != 1) {
+        throw std::runtime_error("Chunks are not joined by their doors!");
+    }
+
+    // world routes: valid, and as short as bfs when inside the window
+    Utility::Workspace       ws;
+    vector<world_coordinate> route;
+    const auto               open = all_open_cells_of(data);
+    for (int query = 0; query < 50; ++query) {
+        coordinate entry = open[rng() % open.size()];
+        coordinate exit  = open[rng() % open.size()];
+        auto       world = [&](coordinate cord) {
+            return world_coordinate { cord.first - 2 * side, cord.second - 2 * side };
+        };
+        if (!roomy.route(world(entry), world(exit), route)
+            || route.front() != world(entry) || route.back() != world(exit)) {
+            throw std::runtime_error("World route not found!");
+        }
+        bool if_inside = true;
+        for (size_t i = 0; i < route.size(); ++i) {
+            auto [x, y] = route[i];
+            if (!roomy.is_open(x, y)
+                || (i > 0 && std::abs(x - route[i - 1].first) + std::abs(y - route[i - 1].second) != 1)) {
+                throw std::runtime_error("World route is broken!");
+            }
+            if_inside = if_inside && x >= -2 * side && x < 2 * side && y >= -2 * side && y < 2 * side;
+        }
+        maze.bfs_route(ws, entry, exit);
+        if (route.size() > ws.get_route().size()
+            || (if_inside && route.size() != ws.get_route().size())) {
+            throw std::runtime_error("World route is not shortest!");
+        }
+    }
+
+    // far from the origin, with little memory: only the explored chunks
+    ChunkedMaze   far { 11, 64 * ChunkedMaze::chunk_cells };
+    const int64_t base = int64_t(1) << 36;
+    if (!far.route({ base, base }, { base + 3 * side, base - 3 * side }, route)
+        || far.cached_chunks() > 64) {
+        throw std::runtime_error("World route failed far away!");
+    }
+    cout << "ChunkedMazeTest passed! (far route " << route.size() << " cells, "
+         << far.get_misses() << " chunks generated)" << endl;
+    cout << endl;
+}
+
+void RouteCacheTest() {
+    using Utility::RouteCache;
+    std::mt19937       rng(20230126);
+    Utility::Workspace ws;
+    Utility::Workspace cached_ws;
+
+    // skewed queries: most of them on a few hot pairs
+    for (auto& workload : Utility::WorkloadGenerator::corpus(61, 17)) {
+        auto       maze = Utility::Maze::create(workload.data, workload.entry, workload.exit);
+        const auto open = all_open_cells_of(workload.data);
+
+        vector<std::pair<coordinate, coordinate>> hot;
+        for (int i = 0; i < 16; ++i) {
+            hot.emplace_back(open[rng() % open.size()], open[rng() % open.size()]);
+        }
+        RouteCache cache { { 4, 256, 16 << 10 } };
+        for (int query = 0; query < 2000; ++query) {
+            auto [entry, exit] = rng() % 10 < 8
+                                   ? hot[rng() % hot.size()]
+                                   : std::pair { open[rng() % open.size()], open[rng() % open.size()] };
+            const bool found = maze.bfs_route(ws, entry, exit);
+            if (maze.cached_route(cache, cached_ws, entry, exit) != found
+                || (found && cached_ws.get_route().size() != ws.get_route().size())
+                || (found && !if_valid_route(maze, cached_ws.get_route(), entry, exit))) {
+                throw std::runtime_error("Cached route is wrong on " + workload.name + "!");
+            }
+        }
+        auto stats = cache.stats();
+        if (stats.hits + stats.misses != 2000 || stats.hit_rate() < 0.7
+            || stats.bytes > (16 << 10) || stats.entries > 256) {
+            throw std::runtime_error("Route cache counters are off on " + workload.name + "!");
+        }
+    }
+
+    // `set` / `reset` invalidate: the same endpoints on another maze
+    auto cache = std::make_shared<RouteCache>();
+    auto maze  = Utility::Maze::create(fixtures[0].to_matrix(), fixtures[0].entry, fixtures[0].exit);
+    maze.set_route_cache(cache);
+    auto first = maze.bfs_solution();
+    if (first != maze.bfs_solution() || cache->stats().hits != 1) {
+        throw std::runtime_error("Solution was not cached!");
+    }
+    matrix<int> split(23, vector<int>(23, 1));
+    for (auto& row : split) {
+        row[11] = 0;
+    }
+    maze.reset();
+    maze.set(split, fixtures[0].entry, { 0, 22 });
+    if (std::get<0>(maze.bfs_solution()) || cache->stats().misses != 2) {
+        throw std::runtime_error("Cache survived a new maze!");
+    }
+    maze.set(fixtures[0].to_matrix(), fixtures[0].entry, fixtures[0].exit);
+    if (maze.bfs_solution() != first || cache->stats().misses != 3) {
+        throw std::runtime_error("Cache survived a new maze!");
+    }
+
+    // shared by threads: readers never block, results stay exact
+    auto shared = Utility::Maze::create(fixtures[1].to_matrix(), fixtures[1].entry, fixtures[1].exit);
+    RouteCache                cache_mt { { 4, 64, 4 << 10 } };
+    const auto                open = all_open_cells_of(shared.get_data());
+    std::atomic<bool>         if_wrong = false;
+    vector<std::thread>       pool;
+    for (int t = 0; t < 4; ++t) {
+        pool.emplace_back([&, t]() {
+            std::mt19937       local(t);
+            Utility::Workspace mine;
+            Utility::Workspace check;
+            for (int query = 0; query < 5000; ++query) {
+                coordinate entry = open[local() % 8];
+                coordinate exit  = open[local() % open.size()];
+                shared.cached_route(cache_mt, mine, entry, exit);
+                shared.tree_route(check, entry, exit);
+                if (!std::ranges::equal(mine.get_route(), check.get_route())) {
+                    if_wrong = true;
+                }
+            }
+        });
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    if (if_wrong || cache_mt.stats().evictions == 0) {
+        throw std::runtime_error("Shared route cache went wrong!");
+    }
+
+    // churn on one shard under steady lookups: retired routes are freed in
+    // bounded time, so allocated routes never outgrow `max_bytes`
+    const int    side      = 301;
+    const size_t max_bytes = 64 << 10;
+    const auto   long_key  = RouteCache::Key { 1, 0, side * side - 1 };
+    auto         open_grid = Utility::Maze::create(matrix<int>(side, vector<int>(side, 1)), { 0, 0 }, { side - 1, side - 1 });
+    open_grid.bfs_route(ws, { 0, 0 }, { side - 1, side - 1 });
+    const vector<Utility::Maze::index_type> long_route(ws.get_route().begin(), ws.get_route().end());
+
+    RouteCache        churned { { 1, 256, max_bytes } };
+    std::atomic<bool> if_done = false;
+    pool.clear();
+    for (int t = 0; t < 4; ++t) {
+        pool.emplace_back([&]() {
+            Utility::Workspace mine;
+            while (!if_done.load()) {
+                auto hit = churned.lookup(long_key, side, mine);
+                if (hit.has_value() && (!*hit || !std::ranges::equal(mine.get_route(), long_route))) {
+                    if_wrong = true;
+                }
+            }
+        });
+    }
+    size_t peak = 0;
+    for (uint32_t store = 0; store < 20000; ++store) {
+        const auto key = store % 8 == 0 ? long_key : RouteCache::Key { 2 + store, 0, side * side - 1 };
+        churned.store(key, side, true, long_route);
+        peak = std::max(peak, churned.stats().bytes);
+    }
+    if_done = true;
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    if (if_wrong || peak > max_bytes || churned.stats().hits == 0) {
+        throw std::runtime_error("Route cache outgrew its bytes under churn!");
+    }
+    // a route over 3/4 of the shard is turned away, not kept at the cost of the others
+    RouteCache                              small { { 1, 256, 1024 } };
+    const vector<Utility::Maze::index_type> short_route = { 0, 1, 2 };
+    vector<Utility::Maze::index_type>       huge_route(4000);
+    std::iota(huge_route.begin(), huge_route.end(), 0);
+    small.store({ 1, 0, 2 }, 5000, true, short_route);
+    small.store({ 1, 1, 3 }, 5000, true, short_route);
+    small.store({ 1, 0, 3999 }, 5000, true, huge_route);
+    if (small.stats().rejected != 1 || small.stats().entries != 2 || small.stats().evictions != 0
+        || small.lookup({ 1, 0, 3999 }, 5000, ws).has_value()) {
+        throw std::runtime_error("Route cache evicted for a route it cannot keep!");
+    }
+    cout << "RouteCacheTest passed! (" << cache_mt.stats().hits << " hits, "
+         << cache_mt.stats().misses << " misses, " << cache_mt.stats().evictions << " evictions)" << endl;
+    cout << endl;
+}
+
+#if MAZE_HAS_UNIX_SOCKET
+void PartitionedBfsTest() {
+    using Utility::PartitionedBfs;
+    std::mt19937       rng(20230127);
+    Utility::Workspace ws;
+
+    // stitched routes are as short as bfs ones, whatever the stripes
+    size_t rounds = 0;
+    for (auto& workload : Utility::WorkloadGenerator::corpus(61, 5)) {
+        auto       maze = Utility::Maze::create(workload.data, workload.entry, workload.exit);
+        const auto open = all_open_cells_of(workload.data);
+        for (size_t workers = 1; workers <= 4; ++workers) {
+            for (int query = 0; query < 3; ++query) {
+                coordinate entry  = open[rng() % open.size()];
+                coordinate exit   = open[rng() % open.size()];
+                auto       result = PartitionedBfs::route(
+                    maze.get_cells(), maze.get_size(), maze.to_index(entry), maze.to_index(exit), workers
+                );
+                const bool found = maze.bfs_route(ws, entry, exit);
+                if (result.found != found || result.workers != workers
+                    || (found && (result.route.size() != ws.get_route().size() || !if_valid_route(maze, result.route, entry, exit)))) {
+                    throw std::runtime_error("Partitioned bfs disagrees with bfs!");
+                }
+                rounds += result.rounds;
+            }
+        }
+    }
+
+    // a wall across the middle stripe: every worker runs dry, nobody hangs
+    matrix<int> split(31, vector<int>(31, 1));
+    split[15] = vector<int>(31, 0);
+    auto maze = Utility::Maze::create(split, { 0, 0 }, { 30, 30 });
+    if (PartitionedBfs::route(maze.get_cells(), 31, 0, 30 * 31 + 30, 3).found) {
+        throw std::runtime_error("Partitioned bfs crossed a wall!");
+    }
+    // more workers than rows, and a route inside one stripe
+    auto small = PartitionedBfs::route(maze.get_cells(), 31, 0, 2, 100);
+    if (!small.found || small.workers != 31 || small.route.size() != 3) {
+        throw std::runtime_error("Partitioned bfs mishandled tiny stripes!");
+    }
+    cout << "PartitionedBfsTest passed! (" << rounds << " rounds)" << endl;
+    cout << endl;
+}
+#endif
+
+#if MAZE_HAS_UNIX_SOCKET
+void RouteServiceTest() {
+    static const auto path = FileManager::Dir::Root / "RouteServiceTest.sock";
+
+    std::mt19937       rng(20230119);
+    Utility::Workspace ws;
+
+    Utility::WorkloadConfig config;
+    config.size  = 101;
+    config.braid = 0.5;
+    auto maze    = std::make_shared<const Utility::Maze>([&]() {
+        auto workload = Utility::WorkloadGenerator::generate(config);
+        return Utility::Maze::create(workload.data, workload.entry, workload.exit);
+    }());
+
+    Utility::RouteServer server { path, { maze }, 4 };
+    std::thread          serving([&]() {
+        server.run();
+    });
+    {
+        // pipeline every query first, then collect the answers by id
+        Utility::RouteClient          client { path };
+        vector<Utility::RouteRequest> requests;
+        const auto                    open = all_open_cells_of(maze->get_data());
+        for (uint32_t id = 0; id < 200; ++id) {
+            coordinate entry = open[rng() % open.size()];
+            coordinate exit  = open[rng() % open.size()];
+            requests.push_back({ id, Utility::route_op::route, 0, entry.first, entry.second, exit.first, exit.second });
+            client.send(requests.back());
+        }
+        for (size_t i = 0; i < requests.size(); ++i) {
+            auto        reply   = client.receive();
+            const auto& request = requests.at(reply.id);
+            coordinate  entry   = { request.entry_x, request.entry_y };
+            coordinate  exit    = { request.exit_x, request.exit_y };
+            maze->bfs_route(ws, entry, exit);
+            if (reply.status != Utility::route_status::found
+                || reply.route.size() != ws.get_route().size()
+                || !if_valid_route(*maze, reply.route, entry, exit)) {
+                throw std::runtime_error("Route server disagrees with bfs!");
+            }
+        }
+
+        auto bad = client.query({ 7, Utility::route_op::route, 1, 0, 0, 0, 0 });
+        if (bad.id != 7 || bad.status != Utility::route_status::bad_request) {
+            throw std::runtime_error("Route server accepted an unknown maze!");
+        }
+        auto stop = client.query({ 8, Utility::route_op::shutdown });
+        if (stop.status != Utility::route_status::stopping) {
+            throw std::runtime_error("Route server did not acknowledge the shutdown!");
+        }
+    }
+    serving.join();
+    cout << "RouteServiceTest passed!" << endl;
+    cout << endl;
+}
+#endif
+
+} // namespace Test
@@ -0,0 +1,153 @@
+/**
+ * @file AsyncSolve.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Solve on a background thread, with cancellation and a deadline
+ * @version 0.1
+ * @date 2023-01-13
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "Maze.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+
+namespace Utility {
+
+using std::shared_ptr;
+
+/**
+ * @brief shared flag to cancel a solve from another thread (cheap to copy)
+ *
+ */
+class CancellationToken {
+    shared_ptr<std::atomic<bool>> flag = std::make_shared<std::atomic<bool>>(false);
+
+public:
+    void cancel() {
+        flag->store(true, std::memory_order_relaxed);
+    }
+    bool is_cancelled() const {
+        return flag->load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief progress of a running solve, readable from any thread
+ *
+ */
+struct SolveProgress {
+    std::atomic<size_t> expanded = 0;
+};
+
+/**
+ * @brief limits of an asynchronous solve
+ *
+ */
+struct SolveBudget {
+    using clock = std::chrono::steady_clock;
+
+    /// @brief solve gives up (with a partial result) once this passes
+    clock::time_point deadline = clock::time_point::max();
+
+    /// @brief expanded cells between two check-ins (token, deadline, progress),
+    ///     0 is taken as 1
+    size_t check_interval = 1024;
+
+    static SolveBudget within(clock::duration duration) {
+        return { clock::now() + duration };
+    }
+};
+
+/**
+ * @brief outcome of an asynchronous solve
+ *
+ */
+struct AsyncResult {
+    enum class state {
+        solved,
+        no_route,
+        cancelled,
+        timed_out,
+    };
+
+    state status = state::no_route;
+
+    /// @brief full route if solved, otherwise the best partial one
+    vector<coordinate> route = {};
+
+    /// @brief cells expanded before the solve ended
+    size_t expanded = 0;
+};
+
+/**
+ * @brief start a `bfs` solve on its own thread
+ *
+ * The search checks in every `budget.check_interval` expansions: it publishes
+ *  `progress`, then stops if `token` was cancelled or the deadline passed. A
+ *  stopped solve still returns the route to the cell closest to `exit`.
+ *
+ * @attention `maze` must not be `set`/`reset` while the solve is running
+ * @return std::future<AsyncResult>
+ */
+inline std::future<AsyncResult> solve_async(
+    shared_ptr<const Maze>    maze,
+    coordinate                entry,
+    coordinate                exit,
+    CancellationToken         token    = {},
+    SolveBudget               budget   = {},
+    shared_ptr<SolveProgress> progress = std::make_shared<SolveProgress>()
+) {
+    budget.check_interval = std::max<size_t>(budget.check_interval, 1);
+    return std::async(std::launch::async, [=]() {
+        using state = AsyncResult::state;
+
+        Workspace   ws;
+        AsyncResult ret;
+
+        auto if_continue = [&](size_t expanded) {
+            ret.expanded = expanded;
+            if (expanded % budget.check_interval != 0) {
+                return true;
+            }
+            progress->expanded.store(expanded, std::memory_order_relaxed);
+            if (token.is_cancelled()) {
+                ret.status = state::cancelled;
+                return false;
+            }
+            if (SolveBudget::clock::now() >= budget.deadline) {
+                ret.status = state::timed_out;
+                return false;
+            }
+            return true;
+        };
+
+        switch (maze->bfs_search(ws, entry, exit, if_continue)) {
+        case Maze::search_status::found:
+            ret.status = state::solved;
+            break;
+        case Maze::search_status::no_route:
+            ret.status = state::no_route;
+            break;
+        case Maze::search_status::stopped:
+            /* status was set by the monitor */
+            break;
+        }
+        progress->expanded.store(ret.expanded, std::memory_order_relaxed);
+
+        ret.route.reserve(ws.get_route().size());
+        for (Maze::index_type idx : ws.get_route()) {
+            ret.route.push_back(maze->to_coordinate(idx));
+        }
+        return ret;
+    });
+}
+
+} // namespace Utility
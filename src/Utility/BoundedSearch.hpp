@@ -0,0 +1,245 @@
+/**
+ * @file BoundedSearch.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Optimal search in a fixed memory budget (IDA* with a transposition table)
+ * @version 0.1
+ * @date 2023-01-30
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "Heading.hpp"
+#include "Search.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace Utility {
+
+using std::vector;
+
+/**
+ * @brief limits of an `IdaStar` search
+ *
+ */
+struct BoundedConfig {
+    /// @brief bytes for the transposition table and the path, together
+    size_t memory_budget = size_t(4) << 20;
+
+    /// @brief give up after that many expansions (re-expansions included),
+    ///     0 for 8 per cell of the maze: iterations of a perfect maze take
+    ///     about 4, but re-expansions through loops grow exponentially once
+    ///     the transposition table is too small, better stop early
+    uint64_t max_expanded = 0;
+};
+
+/**
+ * @brief outcome of an `IdaStar` search
+ *
+ */
+struct BoundedStats {
+    /// @brief `stopped` once the path outgrew its share of the budget, or
+    ///     `max_expanded` was reached
+    search_status status = search_status::no_route;
+
+    uint64_t expanded   = 0;
+    size_t   iterations = 0;
+
+    /// @brief transposition table, path and longest route kept, in bytes
+    size_t peak_bytes = 0;
+};
+
+/**
+ * @brief IDA*: depth-first, f-bounded iterations, so memory follows the
+ *      length of the route instead of the area of the maze
+ *
+ * - The bound grows geometrically (twice the last excess over h(entry), at
+ *   least the smallest f that was cut), so there are O(log route) iterations
+ *   instead of one per f value. Within an iteration, a route of cost c found
+ *   under the bound cuts everything with f >= c (branch and bound), so the
+ *   last route found is still the shortest.
+ * - A direct-mapped transposition table remembers the best g of cells, a
+ *   cell reached again no cheaper is cut. It takes 3/4 of the budget,
+ *   whatever the size of the maze; when it is too small entries are just
+ *   overwritten, which costs re-expansions but never memory.
+ * - The path (and the best route so far) grows as deep as the search goes,
+ *   up to the last 1/4 of the budget. A search that would need a longer path
+ *   (or more than `max_expanded` expansions) stops, reporting
+ *   `search_status::stopped`, and the caller can fall back to another
+ *   solver.
+ *
+ * Neighbours are tried closest to the exit first.
+ */
+class IdaStar {
+public:
+    using index_type = uint32_t;
+
+    static constexpr index_type npos = UINT32_MAX;
+
+private:
+    struct Entry {
+        index_type idx       = npos;
+        uint32_t   g         = 0;
+        uint32_t   iteration = 0;
+    };
+    struct Frame {
+        index_type idx   = 0;
+        uint32_t   g     = 0;
+        uint8_t    order = 0; /* the 4 headings, 2 bits each, best first */
+        uint8_t    next  = 0; /* open headings left to try */
+    };
+
+public:
+    /**
+     * @brief shortest route from `source` to `target` over `cells` (a `size`
+     *      x `size` row-major grid, non-zero for path)
+     *
+     * @param route  receives the cells, entry first (empty unless found)
+     * @note exhausts everything reachable when there's no route, check
+     *      connectivity first where it's known
+     */
+    static BoundedStats route(
+        std::span<const uint8_t> cells,
+        size_t                   size,
+        index_type               source,
+        index_type               target,
+        const BoundedConfig&     config,
+        vector<index_type>&      route
+    ) {
+        BoundedStats ret;
+        route.clear();
+
+        // the path and its copy in `route` share the last quarter
+        const size_t path_cap   = std::max<size_t>(1, config.memory_budget / 4 / (sizeof(Frame) + sizeof(index_type)));
+        const size_t table_size = std::bit_floor(std::max<size_t>(
+            1, (config.memory_budget - config.memory_budget / 4) / sizeof(Entry)
+        ));
+        const auto     table        = std::make_unique<Entry[]>(table_size);
+        const uint64_t max_expanded = config.max_expanded != 0 ? config.max_expanded : 8 * uint64_t(cells.size());
+
+        const int64_t tx     = target / size;
+        const int64_t ty     = target % size;
+        auto          h_cost = [&](index_type idx) -> uint32_t {
+            return static_cast<uint32_t>(std::abs(static_cast<int64_t>(idx / size) - tx)
+                                         + std::abs(static_cast<int64_t>(idx % size) - ty));
+        };
+        auto slot_of = [&](index_type idx) -> Entry& {
+            return table[(idx * uint64_t(0x9E3779B97F4A7C15) >> 32) & (table_size - 1)];
+        };
+        auto frame_of = [&](index_type idx, uint32_t g) {
+            static constexpr std::array<heading, 4> all_headings = {
+                heading::north, heading::south, heading::west, heading::east
+            };
+            // neighbour cost per heading, walls last
+            std::array<uint32_t, 4> cost {};
+            const size_t            x = idx / size;
+            const size_t            y = idx % size;
+            for (size_t k = 0; k < 4; ++k) {
+                const heading dir = all_headings[k];
+                const bool    if_inside
+                    = !((dir == heading::north && x == 0) || (dir == heading::south && x + 1 == size)
+                        || (dir == heading::west && y == 0) || (dir == heading::east && y + 1 == size));
+                cost[k] = if_inside && cells[step(idx, dir, size)] ? h_cost(step(idx, dir, size)) : UINT32_MAX;
+            }
+            std::array<heading, 4> sorted = all_headings;
+            std::stable_sort(sorted.begin(), sorted.end(), [&](heading lhs, heading rhs) {
+                return cost[static_cast<size_t>(lhs)] < cost[static_cast<size_t>(rhs)];
+            });
+            Frame frame { idx, g };
+            for (size_t k = 0; k < 4; ++k) {
+                if (cost[static_cast<size_t>(sorted[k])] != UINT32_MAX) {
+                    frame.order |= static_cast<uint8_t>(static_cast<uint8_t>(sorted[k]) << (2 * frame.next++));
+                }
+            }
+            return frame;
+        };
+
+        const uint32_t h_source = h_cost(source);
+        uint32_t       bound    = h_source;
+        uint32_t       best     = UINT32_MAX; /* cost of `route` */
+        size_t         longest  = 0; /* of the routes kept, the first one */
+        vector<Frame>  path;
+        auto           finish = [&](search_status status) {
+            ret.status     = status;
+            ret.peak_bytes = table_size * sizeof(Entry) + path.capacity() * sizeof(Frame) + longest * sizeof(index_type);
+            if (status != search_status::found) {
+                route.clear();
+            }
+            return ret;
+        };
+
+        while (true) {
+            const auto iteration  = static_cast<uint32_t>(++ret.iterations);
+            uint32_t   next_bound = UINT32_MAX;
+
+            path.clear();
+            path.push_back(frame_of(source, 0));
+            slot_of(source) = { source, 0, iteration };
+            while (!path.empty()) {
+                Frame& top = path.back();
+                if (top.idx == target) {
+                    // pushed only if cheaper than `best`, from now on cut anything not cheaper
+                    best = top.g;
+                    route.clear();
+                    route.resize(path.size()); /* exactly, routes found later are shorter */
+                    std::transform(path.begin(), path.end(), route.begin(), [](const Frame& frame) {
+                        return frame.idx;
+                    });
+                    longest = std::max(longest, route.size());
+                    path.pop_back();
+                    continue;
+                }
+                if (top.next == 0) {
+                    path.pop_back();
+                    continue;
+                }
+                const auto dir = static_cast<heading>(top.order & 0b11);
+                top.order >>= 2;
+                --top.next;
+
+                const index_type to = step(top.idx, dir, size);
+                const uint32_t   g  = top.g + 1;
+                const uint32_t   f  = g + h_cost(to);
+                if (f >= best) {
+                    continue;
+                }
+                if (f > bound) {
+                    next_bound = std::min(next_bound, f);
+                    continue;
+                }
+                Entry& entry = slot_of(to);
+                if (entry.idx == to && (entry.g < g || (entry.g == g && entry.iteration == iteration))) {
+                    continue; /* reached as cheaply before */
+                }
+                entry = { to, g, iteration };
+
+                if (path.size() >= path_cap || ++ret.expanded > max_expanded) {
+                    return finish(search_status::stopped);
+                }
+                if (path.size() == path.capacity()) {
+                    path.reserve(std::min(path_cap, 2 * path.size())); /* doubling, but not past the cap */
+                }
+                path.push_back(frame_of(to, g));
+            }
+
+            if (best != UINT32_MAX) {
+                return finish(search_status::found);
+            }
+            if (next_bound == UINT32_MAX) {
+                return finish(search_status::no_route);
+            }
+            bound = std::max(next_bound, h_source + 2 * (bound - h_source));
+        }
+    }
+};
+
+} // namespace Utility
@@ -0,0 +1,292 @@
+/**
+ * @file ChunkedMaze.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Unbounded maze generated chunk by chunk on first access
+ * @version 0.1
+ * @date 2023-01-24
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "Maze.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Utility {
+
+using std::vector;
+
+/// @brief cell of an unbounded maze, any sign
+using world_coordinate = std::pair<int64_t, int64_t>;
+
+/**
+ * @brief a maze over the whole plane, made of square chunks
+ *
+ * A chunk is `chunk_side` x `chunk_side` cells. Like `Generator`, cells on
+ *  even local coordinates are path and a dfs over them carves a perfect maze,
+ *  seeded by (seed, chunk coordinates) only, so a chunk is the same whenever
+ *  and in whichever order it's generated. The last row and column of a chunk
+ *  are its south and east border walls, each with one door at an even offset
+ *  drawn from (seed, chunk, side). A border belongs to exactly one chunk, so
+ *  two neighbours always agree on their door, and the whole plane is one
+ *  connected maze.
+ *
+ * Chunks are generated on first access and kept in an LRU cache bounded like
+ *  `TiledGrid`'s, an evicted chunk is simply generated again. Memory follows
+ *  the area a search explores, not the size of the world.
+ *
+ * @note not thread-safe, every access may generate or evict a chunk. Chunk
+ *      coordinates are keyed on 32 bits, so the world repeats itself every
+ *      2^38 cells
+ */
+class ChunkedMaze {
+public:
+    static constexpr int64_t chunk_side  = 64;
+    static constexpr size_t  chunk_cells = chunk_side * chunk_side;
+
+private:
+    uint64_t seed       = 0;
+    size_t   max_chunks = 1;
+
+    /* LRU cache of chunks, front is the most recently used */
+    using chunk_bytes = std::unique_ptr<uint8_t[]>;
+    std::list<std::pair<uint64_t, chunk_bytes>> lru = {};
+    std::unordered_map<
+        uint64_t,
+        std::list<std::pair<uint64_t, chunk_bytes>>::iterator>
+        cached = {};
+
+    uint64_t hits   = 0;
+    uint64_t misses = 0;
+
+    /// @brief splitmix64 finalizer, a well mixed hash of `value`
+    static uint64_t mix(uint64_t value) {
+        value += 0x9E3779B97F4A7C15;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+        return value ^ (value >> 31);
+    }
+    static int64_t floor_div(int64_t value, int64_t divisor) {
+        return value / divisor - (value % divisor < 0);
+    }
+    static uint64_t key_of(int64_t cx, int64_t cy) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32)
+             | static_cast<uint32_t>(cy);
+    }
+
+    /// @brief the maze of chunk `key` into `cells` (row-major, local)
+    void generate(uint64_t key, uint8_t* cells) const {
+        static constexpr int64_t rooms = chunk_side / 2; /* cells per side */
+        static constexpr std::array<std::pair<int, int>, 4> steps = { {
+            { -1, 0 },
+            { 1, 0 },
+            { 0, -1 },
+            { 0, 1 },
+        } };
+
+        std::fill_n(cells, chunk_cells, 0);
+        // no std distribution: their output differs between standard libraries
+        std::mt19937_64 rng(mix(seed ^ mix(key)));
+
+        vector<std::pair<int, int>> stack = { { 0, 0 } };
+        cells[0]                          = 1;
+        while (!stack.empty()) {
+            auto [x, y] = stack.back();
+
+            std::array<int, 4> options {};
+            int                count = 0;
+            for (int k = 0; k < 4; ++k) {
+                int nx = x + steps[k].first;
+                int ny = y + steps[k].second;
+                if (nx >= 0 && nx < rooms && ny >= 0 && ny < rooms && !cells[(2 * nx) * chunk_side + 2 * ny]) {
+                    options[count++] = k;
+                }
+            }
+            if (count == 0) {
+                stack.pop_back();
+                continue;
+            }
+            auto [dx, dy] = steps[options[rng() % count]];
+            cells[(2 * x + dx) * chunk_side + 2 * y + dy] = 1;
+            cells[(2 * (x + dx)) * chunk_side + 2 * (y + dy)] = 1;
+            stack.push_back({ x + dx, y + dy });
+        }
+
+        // the doors of the two borders this chunk owns
+        const int64_t south = 2 * static_cast<int64_t>(mix(seed ^ mix(key) ^ 1) % rooms);
+        const int64_t east  = 2 * static_cast<int64_t>(mix(seed ^ mix(key) ^ 2) % rooms);
+        cells[(chunk_side - 1) * chunk_side + south] = 1;
+        cells[east * chunk_side + chunk_side - 1]    = 1;
+    }
+
+    const uint8_t* load(int64_t cx, int64_t cy) {
+        const uint64_t key = key_of(cx, cy);
+        if (auto it = cached.find(key); it != cached.end()) {
+            ++hits;
+            lru.splice(lru.begin(), lru, it->second);
+            return it->second->second.get();
+        }
+        ++misses;
+        chunk_bytes bytes;
+        if (lru.size() >= max_chunks) {
+            // recycle the least recently used buffer
+            bytes = std::move(lru.back().second);
+            cached.erase(lru.back().first);
+            lru.pop_back();
+        } else {
+            bytes = std::make_unique<uint8_t[]>(chunk_cells);
+        }
+        generate(key, bytes.get());
+        lru.emplace_front(key, std::move(bytes));
+        cached[key] = lru.begin();
+        return lru.front().second.get();
+    }
+
+public:
+    /**
+     * @brief the world of `seed`, caching at most `memory_cap` bytes of chunks
+     *
+     */
+    ChunkedMaze(uint64_t seed, size_t memory_cap)
+        : seed(seed)
+        , max_chunks(std::max<size_t>(1, memory_cap / chunk_cells)) { }
+
+    uint64_t get_hits() const {
+        return hits;
+    }
+    uint64_t get_misses() const {
+        return misses;
+    }
+    size_t cached_chunks() const {
+        return lru.size();
+    }
+
+    /**
+     * @brief whether cell (x, y) is path (generates its chunk if needed)
+     *
+     */
+    bool is_open(int64_t x, int64_t y) {
+        const int64_t cx = floor_div(x, chunk_side);
+        const int64_t cy = floor_div(y, chunk_side);
+        return load(cx, cy)[(x - cx * chunk_side) * chunk_side + (y - cy * chunk_side)] != 0;
+    }
+    bool is_open(const world_coordinate& cord) {
+        return is_open(cord.first, cord.second);
+    }
+
+    /**
+     * @brief the `size` x `size` cells from (x, y), e.g. for `Maze::create`
+     *
+     */
+    matrix<int> window(int64_t x, int64_t y, size_t size) {
+        matrix<int> ret(size, vector<int>(size, 0));
+        for (size_t i = 0; i < size; ++i) {
+            for (size_t j = 0; j < size; ++j) {
+                ret[i][j] = is_open(x + static_cast<int64_t>(i), y + static_cast<int64_t>(j));
+            }
+        }
+        return ret;
+    }
+
+    /**
+     * @brief shortest route from `entry` to `exit` (a*, manhattan), chunks
+     *      fetched as the search reaches them
+     *
+     * @param route         receives the cells, entry first
+     * @param max_expanded  give up after expanding that many cells
+     * @return true if found within `max_expanded`
+     * @note the visited cells live in hash maps, so memory is O(explored)
+     *      whatever the coordinates
+     */
+    bool route(
+        const world_coordinate&   entry,
+        const world_coordinate&   exit,
+        vector<world_coordinate>& route,
+        size_t                    max_expanded = SIZE_MAX
+    ) {
+        struct CoordinateHash {
+            size_t operator()(const world_coordinate& cord) const {
+                return mix(static_cast<uint64_t>(cord.first) ^ mix(static_cast<uint64_t>(cord.second)));
+            }
+        };
+        struct Node {
+            uint64_t         g      = 0;
+            world_coordinate parent = {};
+        };
+        // { f, ~g (deeper first), cell }, smallest on top
+        using entry_type = std::tuple<uint64_t, uint64_t, world_coordinate>;
+
+        route.clear();
+        if (!is_open(entry) || !is_open(exit)) {
+            return false;
+        }
+        auto h_cost = [&](const world_coordinate& cord) {
+            auto distance = [](int64_t lhs, int64_t rhs) {
+                return lhs > rhs ? static_cast<uint64_t>(lhs - rhs) : static_cast<uint64_t>(rhs - lhs);
+            };
+            return distance(cord.first, exit.first) + distance(cord.second, exit.second);
+        };
+
+        std::unordered_map<world_coordinate, Node, CoordinateHash> nodes;
+        vector<entry_type>                                        heap;
+        auto push = [&](uint64_t g, const world_coordinate& cord) {
+            heap.emplace_back(g + h_cost(cord), ~g, cord);
+            std::push_heap(heap.begin(), heap.end(), std::greater<> {});
+        };
+        nodes[entry] = { 0, entry };
+        push(0, entry);
+
+        size_t expanded = 0;
+        while (!heap.empty() && expanded < max_expanded) {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<> {});
+            auto [f, not_g, from] = heap.back();
+            heap.pop_back();
+            const uint64_t g = ~not_g;
+            if (nodes[from].g != g) {
+                continue; /* stale, `from` was reached cheaper since */
+            }
+            if (from == exit) {
+                for (auto curr = exit; curr != entry; curr = nodes[curr].parent) {
+                    route.push_back(curr);
+                }
+                route.push_back(entry);
+                std::reverse(route.begin(), route.end());
+                return true;
+            }
+            ++expanded;
+            auto [x, y] = from;
+            for (world_coordinate to : { world_coordinate { x - 1, y },
+                                         world_coordinate { x + 1, y },
+                                         world_coordinate { x, y - 1 },
+                                         world_coordinate { x, y + 1 } }) {
+                if (!is_open(to)) {
+                    continue;
+                }
+                auto [it, if_new] = nodes.try_emplace(to, Node { g + 1, from });
+                if (!if_new) {
+                    if (it->second.g <= g + 1) {
+                        continue;
+                    }
+                    it->second = { g + 1, from };
+                }
+                push(g + 1, to);
+            }
+        }
+        return false;
+    }
+};
+
+} // namespace Utility
@@ -0,0 +1,216 @@
+/**
+ * @file Components.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Label connected components of a maze, answer reachability in O(1)
+ * @version 0.1
+ * @date 2023-01-11
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace Utility {
+
+using std::vector;
+
+/**
+ * @brief connected components of the open cells, labelled once on load
+ *
+ * Rows are split into stripes, each stripe is labelled by its own thread with
+ *  a union-find, then the stripe borders are merged and every cell gets a
+ *  compact component id.
+ */
+class Components {
+public:
+    using label_type = uint32_t;
+
+    static constexpr label_type npos = UINT32_MAX;
+
+private:
+    /// @brief grids smaller than this are labelled on the calling thread
+    static constexpr size_t parallel_threshold = 1 << 16;
+
+    vector<label_type> labels = {}; /* cell -> component (npos for wall) */
+    size_t             count  = 0;
+
+    static label_type find(vector<label_type>& parent, label_type idx) {
+        while (parent[idx] != idx) {
+            parent[idx] = parent[parent[idx]]; /* path halving */
+            idx         = parent[idx];
+        }
+        return idx;
+    }
+    static label_type find_root(const vector<label_type>& parent, label_type idx) {
+        while (parent[idx] != idx) {
+            idx = parent[idx];
+        }
+        return idx;
+    }
+    static void unite(vector<label_type>& parent, label_type lhs, label_type rhs) {
+        lhs = find(parent, lhs);
+        rhs = find(parent, rhs);
+        if (lhs == rhs) {
+            return;
+        }
+        // smaller index wins, so roots never move into another stripe
+        if (lhs < rhs) {
+            parent[rhs] = lhs;
+        } else {
+            parent[lhs] = rhs;
+        }
+    }
+
+    static void label_stripe(
+        const vector<uint8_t>& cells,
+        size_t                 size,
+        vector<label_type>&    parent,
+        size_t                 row_begin,
+        size_t                 row_end
+    ) {
+        for (size_t x = row_begin; x < row_end; ++x) {
+            for (size_t y = 0; y < size; ++y) {
+                auto idx = static_cast<label_type>(x * size + y);
+                if (!cells[idx]) {
+                    continue;
+                }
+                if (y > 0 && cells[idx - 1]) {
+                    unite(parent, idx, idx - 1);
+                }
+                if (x > row_begin && cells[idx - size]) {
+                    unite(parent, idx, static_cast<label_type>(idx - size));
+                }
+            }
+        }
+    }
+
+    template <class Fn>
+    static void for_each_stripe(size_t rows, size_t threads, Fn&& fn) {
+        vector<std::thread> pool;
+        pool.reserve(threads);
+        for (size_t t = 0; t < threads; ++t) {
+            size_t begin = rows * t / threads;
+            size_t end   = rows * (t + 1) / threads;
+            pool.emplace_back(fn, begin, end);
+        }
+        for (auto& thread : pool) {
+            thread.join();
+        }
+    }
+
+public:
+    /**
+     * @brief Default constructor (nothing labelled)
+     *
+     */
+    Components() = default;
+
+    /**
+     * @brief label a square `size * size` grid
+     *
+     * @param cells    flat row-major grid, non-zero for path
+     * @param size
+     * @param threads  0 => pick by grid size and `hardware_concurrency`
+     * @return Components
+     */
+    static Components label(
+        const vector<uint8_t>& cells,
+        size_t                 size,
+        size_t                 threads = 0
+    ) {
+        if (threads == 0) {
+            threads = cells.size() < parallel_threshold
+                ? 1
+                : std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        threads = std::clamp<size_t>(threads, 1, std::max<size_t>(1, size));
+
+        vector<label_type> parent(cells.size());
+        for (size_t i = 0; i < parent.size(); ++i) {
+            parent[i] = static_cast<label_type>(i);
+        }
+
+        // 1. every stripe on its own (stripes never touch each other's cells)
+        auto stripe = [&](size_t row_begin, size_t row_end) {
+            label_stripe(cells, size, parent, row_begin, row_end);
+        };
+        if (threads == 1) {
+            stripe(0, size);
+        } else {
+            for_each_stripe(size, threads, stripe);
+        }
+
+        // 2. stitch the borders between stripes
+        for (size_t t = 1; t < threads; ++t) {
+            size_t x = size * t / threads;
+            for (size_t y = 0; y < size; ++y) {
+                auto idx = static_cast<label_type>(x * size + y);
+                if (cells[idx] && cells[idx - size]) {
+                    unite(parent, idx, static_cast<label_type>(idx - size));
+                }
+            }
+        }
+
+        // 3. resolve roots in parallel (read-only), then number them
+        Components ret;
+        ret.labels.assign(cells.size(), npos);
+        auto resolve = [&](size_t row_begin, size_t row_end) {
+            for (size_t idx = row_begin * size; idx < row_end * size; ++idx) {
+                if (cells[idx]) {
+                    ret.labels[idx] = find_root(parent, static_cast<label_type>(idx));
+                }
+            }
+        };
+        if (threads == 1) {
+            resolve(0, size);
+        } else {
+            for_each_stripe(size, threads, resolve);
+        }
+        // a root is the smallest index of its component, so it's met first
+        for (size_t idx = 0; idx < cells.size(); ++idx) {
+            if (ret.labels[idx] == idx) {
+                parent[idx] = static_cast<label_type>(ret.count++);
+            }
+            if (ret.labels[idx] != npos) {
+                ret.labels[idx] = parent[ret.labels[idx]];
+            }
+        }
+        return ret;
+    }
+
+    bool empty() const {
+        return labels.empty();
+    }
+
+    /**
+     * @brief number of connected components
+     *
+     */
+    size_t component_count() const {
+        return count;
+    }
+
+    /**
+     * @brief component id of a cell (npos for wall)
+     *
+     */
+    label_type get_label(size_t idx) const {
+        return labels[idx];
+    }
+
+    /**
+     * @brief O(1) reachability between two cells
+     *
+     */
+    bool connected(size_t lhs, size_t rhs) const {
+        return labels[lhs] != npos && labels[lhs] == labels[rhs];
+    }
+};
+
+} // namespace Utility
@@ -0,0 +1,328 @@
+/**
+ * @file CorridorGraph.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Contract the corridors of a maze into a small weighted graph
+ * @version 0.1
+ * @date 2023-01-10
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "Heading.hpp"
+#include "Workspace.hpp"
+
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+namespace Utility {
+
+using std::vector;
+
+/**
+ * @brief graph of junctions, dead ends and endpoints of a maze
+ *
+ * Every open cell with exactly two open neighbours is a corridor cell and is
+ *  folded into an edge. An edge keeps the corridor length and the corridor
+ *  itself run-length encoded as { heading, steps }, so the cells are only
+ *  expanded again when a route is reconstructed.
+ */
+class CorridorGraph {
+public:
+    using index_type = Workspace::index_type;
+
+    static constexpr index_type npos = Workspace::npos;
+
+    using heading = Utility::heading;
+
+    /// @brief `steps` consecutive moves towards `dir`
+    struct Run {
+        heading  dir   = heading::north;
+        uint32_t steps = 0;
+    };
+
+    /// @brief a corridor, stored once, from `from_cell` to `to_cell`
+    struct Corridor {
+        index_type from_cell = npos;
+        index_type to_cell   = npos;
+        uint32_t   length    = 0;
+        uint32_t   run_begin = 0;
+        uint32_t   run_end   = 0;
+    };
+
+    /// @brief directed edge between two nodes, backed by a corridor
+    struct Edge {
+        index_type from     = npos;
+        index_type to       = npos;
+        uint32_t   length   = 0;
+        uint32_t   corridor = 0;
+        bool       reversed = false;
+    };
+
+private:
+    size_t size = 0;
+
+    vector<index_type> node_cells = {}; /* node -> cell */
+    vector<index_type> node_of    = {}; /* cell -> node (or npos) */
+    vector<uint32_t>   offsets    = {}; /* node -> first edge (CSR) */
+    vector<Edge>       edges      = {};
+    vector<Corridor>   corridors  = {};
+    vector<Run>        runs       = {};
+
+    index_type step(index_type idx, heading dir) const {
+        return Utility::step(idx, dir, size);
+    }
+    template <class Fn>
+    void for_each_open_heading(
+        const vector<uint8_t>& cells,
+        index_type             idx,
+        Fn&&                   fn
+    ) const {
+        const size_t x = idx / size;
+        const size_t y = idx % size;
+        if (x > 0 && cells[idx - size]) {
+            fn(heading::north);
+        }
+        if (x + 1 < size && cells[idx + size]) {
+            fn(heading::south);
+        }
+        if (y > 0 && cells[idx - 1]) {
+            fn(heading::west);
+        }
+        if (y + 1 < size && cells[idx + 1]) {
+            fn(heading::east);
+        }
+    }
+    int degree(const vector<uint8_t>& cells, index_type idx) const {
+        int ret = 0;
+        for_each_open_heading(cells, idx, [&](heading) { ++ret; });
+        return ret;
+    }
+
+    void register_nodes(
+        const vector<uint8_t>&            cells,
+        std::initializer_list<index_type> endpoints
+    ) {
+        node_of.assign(cells.size(), npos);
+        for (index_type idx = 0; idx < cells.size(); ++idx) {
+            if (cells[idx] && degree(cells, idx) != 2) {
+                node_of[idx] = static_cast<index_type>(node_cells.size());
+                node_cells.push_back(idx);
+            }
+        }
+        for (index_type idx : endpoints) {
+            if (idx < cells.size() && cells[idx] && node_of[idx] == npos) {
+                node_of[idx] = static_cast<index_type>(node_cells.size());
+                node_cells.push_back(idx);
+            }
+        }
+    }
+    /**
+     * @brief follow the corridor leaving `start` towards `first`
+     *
+     * @note a corridor is kept only when walked from its smaller end,
+     *      so every corridor ends up stored exactly once
+     */
+    void walk_corridor(
+        const vector<uint8_t>& cells,
+        index_type             start,
+        heading                first
+    ) {
+        const auto run_begin = static_cast<uint32_t>(runs.size());
+        uint32_t   length    = 0;
+        heading    last      = first;
+        index_type curr      = start;
+
+        auto advance = [&](heading dir) {
+            if (length != 0 && runs.back().dir == dir) {
+                ++runs.back().steps;
+            } else {
+                runs.push_back({ dir, 1 });
+            }
+            curr = step(curr, dir);
+            last = dir;
+            ++length;
+        };
+
+        advance(first);
+        while (node_of[curr] == npos) {
+            // a corridor cell has exactly one way out besides the way in
+            heading next = last;
+            for_each_open_heading(cells, curr, [&](heading dir) {
+                if (dir != reverse(last)) {
+                    next = dir;
+                }
+            });
+            advance(next);
+        }
+
+        bool if_keep = start < curr
+            || (start == curr && first < reverse(last));
+        if (!if_keep) {
+            runs.resize(run_begin);
+            return;
+        }
+        corridors.push_back({
+            start,
+            curr,
+            length,
+            run_begin,
+            static_cast<uint32_t>(runs.size()),
+        });
+    }
+    void build_adjacency() {
+        const size_t node_count = node_cells.size();
+        offsets.assign(node_count + 1, 0);
+        for (const Corridor& c : corridors) {
+            ++offsets[node_of[c.from_cell] + 1];
+            ++offsets[node_of[c.to_cell] + 1];
+        }
+        for (size_t i = 0; i < node_count; ++i) {
+            offsets[i + 1] += offsets[i];
+        }
+        edges.resize(offsets.back());
+        vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (uint32_t id = 0; id < corridors.size(); ++id) {
+            const Corridor& c    = corridors[id];
+            index_type      from = node_of[c.from_cell];
+            index_type      to   = node_of[c.to_cell];
+            edges[cursor[from]++] = { from, to, c.length, id, false };
+            edges[cursor[to]++]   = { to, from, c.length, id, true };
+        }
+    }
+
+    /**
+     * @brief append the cells of `edge`, from its `to` end back towards
+     *      (but excluding) its `from` end
+     */
+    void expand_backwards(Workspace& ws, const Edge& edge) const {
+        const Corridor& c = corridors[edge.corridor];
+        if (edge.reversed) {
+            // corridor was recorded from `edge.to`, so replay it forwards
+            index_type curr = c.from_cell;
+            for (uint32_t r = c.run_begin; r < c.run_end; ++r) {
+                for (uint32_t i = 0; i < runs[r].steps; ++i) {
+                    ws.append_route(curr);
+                    curr = step(curr, runs[r].dir);
+                }
+            }
+        } else {
+            index_type curr = c.to_cell;
+            for (uint32_t r = c.run_end; r-- > c.run_begin;) {
+                for (uint32_t i = 0; i < runs[r].steps; ++i) {
+                    ws.append_route(curr);
+                    curr = step(curr, reverse(runs[r].dir));
+                }
+            }
+        }
+    }
+
+public:
+    /**
+     * @brief Default constructor (an empty graph)
+     *
+     */
+    CorridorGraph() = default;
+
+    /**
+     * @brief contract the open cells of a square `size * size` grid
+     *
+     * @param cells      flat row-major grid, non-zero for path
+     * @param size
+     * @param endpoints  cells that must stay nodes (e.g. entry and exit)
+     * @return CorridorGraph
+     */
+    static CorridorGraph build(
+        const vector<uint8_t>&            cells,
+        size_t                            size,
+        std::initializer_list<index_type> endpoints
+    ) {
+        CorridorGraph ret;
+        ret.size = size;
+        ret.register_nodes(cells, endpoints);
+        for (index_type node_cell : ret.node_cells) {
+            ret.for_each_open_heading(cells, node_cell, [&](heading dir) {
+                ret.walk_corridor(cells, node_cell, dir);
+            });
+        }
+        ret.build_adjacency();
+        ret.node_of.shrink_to_fit();
+        return ret;
+    }
+
+    bool empty() const {
+        return node_cells.empty();
+    }
+    size_t node_count() const {
+        return node_cells.size();
+    }
+    size_t edge_count() const {
+        return corridors.size();
+    }
+    bool contains(index_type cell) const {
+        return cell < node_of.size() && node_of[cell] != npos;
+    }
+
+    /**
+     * @brief dijkstra over the nodes, then expand corridors into `ws`
+     *
+     * @note both cells must be nodes (see `contains`)
+     * @param cell_count  number of cells in the grid (sizes the workspace)
+     * @return true if a route exists, the cells are left in `ws.get_route()`
+     */
+    bool route(
+        Workspace& ws,
+        size_t     cell_count,
+        index_type source_cell,
+        index_type target_cell
+    ) const {
+        const index_type source = node_of[source_cell];
+        const index_type target = node_of[target_cell];
+
+        // node ids are used as workspace indices, parents are edge ids
+        ws.begin(cell_count);
+        ws.visit(source, npos);
+        ws.set_distance(source, 0);
+        ws.heap_push(0, source);
+
+        bool if_found = false;
+        while (!ws.heap_empty()) {
+            auto [dist, node] = ws.heap_pop();
+            if (dist > ws.get_distance(node)) {
+                continue;
+            }
+            if (node == target) {
+                if_found = true;
+                break;
+            }
+            for (uint32_t e = offsets[node]; e < offsets[node + 1]; ++e) {
+                const Edge& edge = edges[e];
+                index_type  next = static_cast<index_type>(dist) + edge.length;
+                if (ws.visited(edge.to) && ws.get_distance(edge.to) <= next) {
+                    continue;
+                }
+                ws.visit(edge.to, e);
+                ws.set_distance(edge.to, next);
+                ws.heap_push(next, edge.to);
+            }
+        }
+        if (!if_found) {
+            return false;
+        }
+
+        ws.clear_route();
+        for (index_type node = target; node != source;) {
+            const Edge& edge = edges[ws.parent(node)];
+            expand_backwards(ws, edge);
+            node = edge.from;
+        }
+        ws.append_route(source_cell);
+        ws.reverse_route();
+        return true;
+    }
+};
+
+} // namespace Utility
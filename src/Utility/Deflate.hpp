@@ -0,0 +1,394 @@
+/**
+ * @file Deflate.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Minimal streaming zlib encoder (LZ77 + fixed Huffman), its decoder, CRC-32
+ * @version 0.1
+ * @date 2023-01-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace Utility {
+
+using std::vector;
+
+/**
+ * @brief CRC-32 (the one of PNG chunks), fed incrementally
+ *
+ */
+class Crc32 {
+    static constexpr std::array<uint32_t, 256> table = []() {
+        std::array<uint32_t, 256> ret {};
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            ret[n] = c;
+        }
+        return ret;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFu;
+
+public:
+    void update(std::span<const uint8_t> bytes) {
+        for (uint8_t byte : bytes) {
+            crc = table[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+        }
+    }
+    uint32_t value() const {
+        return crc ^ 0xFFFFFFFFu;
+    }
+};
+
+/**
+ * @brief zlib stream encoder, output is drained by the caller as it grows
+ *
+ * Input is compressed in chunks with LZ77 over a 32 KiB window (hash chains
+ *  of bounded length) and coded with the fixed Huffman tables, so there are
+ *  no tables to build or store. Memory is the window plus one chunk.
+ */
+class Deflater {
+    friend class Inflater;
+
+    static constexpr size_t   window    = size_t(1) << 15;
+    static constexpr size_t   chunk     = size_t(1) << 16;
+    static constexpr size_t   min_match = 3;
+    static constexpr size_t   max_match = 258;
+    static constexpr int      hash_bits = 15;
+    static constexpr int      max_chain = 16;
+    static constexpr uint64_t none      = UINT64_MAX;
+
+    static constexpr std::array<uint16_t, 29> length_base = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27,
+        31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258,
+    };
+    static constexpr std::array<uint8_t, 29> length_extra = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+        2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0,
+    };
+    static constexpr std::array<uint16_t, 30> distance_base = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+        193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577,
+    };
+    static constexpr std::array<uint8_t, 30> distance_extra = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+        6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13,
+    };
+
+    /* `history[0]` is byte `base` of the stream, compressed up to `pending` */
+    vector<uint8_t> history = {};
+    uint64_t        base    = 0;
+    size_t          pending = 0;
+
+    vector<uint64_t> head = vector<uint64_t>(size_t(1) << hash_bits, none);
+    vector<uint64_t> prev = vector<uint64_t>(window, none);
+
+    vector<uint8_t> out       = {};
+    uint64_t        bits      = 0;
+    int             bit_count = 0;
+
+    uint32_t adler_a     = 1;
+    uint32_t adler_b     = 0;
+    bool     if_finished = false;
+
+    void put_bits(uint32_t value, int count) {
+        bits |= static_cast<uint64_t>(value) << bit_count;
+        bit_count += count;
+        while (bit_count >= 8) {
+            out.push_back(static_cast<uint8_t>(bits));
+            bits >>= 8;
+            bit_count -= 8;
+        }
+    }
+    /// @brief Huffman codes go out most significant bit first
+    void put_code(uint32_t code, int length) {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; ++i) {
+            reversed = (reversed << 1) | ((code >> i) & 1);
+        }
+        put_bits(reversed, length);
+    }
+    void put_symbol(uint32_t symbol) {
+        if (symbol < 144) {
+            put_code(0x30 + symbol, 8);
+        } else if (symbol < 256) {
+            put_code(0x190 + symbol - 144, 9);
+        } else if (symbol < 280) {
+            put_code(symbol - 256, 7);
+        } else {
+            put_code(0xC0 + symbol - 280, 8);
+        }
+    }
+    void put_match(size_t length, size_t distance) {
+        size_t l = std::upper_bound(length_base.begin(), length_base.end(), length) - length_base.begin() - 1;
+        put_symbol(static_cast<uint32_t>(257 + l));
+        put_bits(static_cast<uint32_t>(length - length_base[l]), length_extra[l]);
+
+        size_t d = std::upper_bound(distance_base.begin(), distance_base.end(), distance) - distance_base.begin() - 1;
+        put_code(static_cast<uint32_t>(d), 5);
+        put_bits(static_cast<uint32_t>(distance - distance_base[d]), distance_extra[d]);
+    }
+
+    uint32_t hash_at(size_t i) const {
+        uint32_t key = history[i] | (history[i + 1] << 8) | (history[i + 2] << 16);
+        return (key * 2654435761u) >> (32 - hash_bits);
+    }
+    void insert(size_t i) {
+        const uint64_t at = base + i;
+        const uint32_t h  = hash_at(i);
+        prev[at & (window - 1)] = head[h];
+        head[h]                 = at;
+    }
+
+    /// @brief code `history[pending..]` as one fixed-Huffman block
+    void compress_pending() {
+        const size_t end = history.size();
+        if (pending == end) {
+            return;
+        }
+        put_bits(0, 1); /* not final */
+        put_bits(1, 2); /* fixed Huffman */
+
+        size_t i = pending;
+        while (i < end) {
+            size_t best_length   = 0;
+            size_t best_distance = 0;
+            if (i + min_match <= end) {
+                const uint64_t at        = base + i;
+                const size_t   max_len   = std::min(max_match, end - i);
+                uint64_t       candidate = head[hash_at(i)];
+                for (int chain = 0; chain < max_chain && candidate != none; ++chain) {
+                    if (candidate >= at || at - candidate > window || candidate < base) {
+                        break;
+                    }
+                    const size_t from   = static_cast<size_t>(candidate - base);
+                    size_t       length = 0;
+                    while (length < max_len && history[from + length] == history[i + length]) {
+                        ++length;
+                    }
+                    if (length > best_length) {
+                        best_length   = length;
+                        best_distance = static_cast<size_t>(at - candidate);
+                        if (length == max_len) {
+                            break;
+                        }
+                    }
+                    const uint64_t next = prev[candidate & (window - 1)];
+                    if (next >= candidate) {
+                        break; /* slot reused by a newer position */
+                    }
+                    candidate = next;
+                }
+            }
+            if (best_length >= min_match) {
+                put_match(best_length, best_distance);
+                for (size_t k = 0; k < best_length; ++k, ++i) {
+                    if (i + min_match <= end) {
+                        insert(i);
+                    }
+                }
+            } else {
+                put_symbol(history[i]);
+                if (i + min_match <= end) {
+                    insert(i);
+                }
+                ++i;
+            }
+        }
+        put_symbol(256); /* end of block */
+
+        // keep the last window as history for the next chunk
+        pending = end;
+        if (history.size() > window) {
+            const size_t drop = history.size() - window;
+            history.erase(history.begin(), history.begin() + static_cast<std::ptrdiff_t>(drop));
+            base += drop;
+            pending -= drop;
+        }
+    }
+
+public:
+    Deflater() {
+        out.push_back(0x78); /* deflate, 32 KiB window */
+        out.push_back(0x01); /* no dictionary, fastest (header check % 31) */
+        history.reserve(window + chunk);
+    }
+
+    void write(std::span<const uint8_t> bytes) {
+        if (if_finished) {
+            throw std::logic_error("Deflater has been finished!");
+        }
+        // 5552 bytes is the longest run whose sums cannot overflow
+        for (size_t i = 0; i < bytes.size();) {
+            const size_t run_end = std::min(bytes.size(), i + 5552);
+            for (; i < run_end; ++i) {
+                adler_a += bytes[i];
+                adler_b += adler_a;
+            }
+            adler_a %= 65521;
+            adler_b %= 65521;
+        }
+        history.insert(history.end(), bytes.begin(), bytes.end());
+        if (history.size() - pending >= chunk) {
+            compress_pending();
+        }
+    }
+
+    /**
+     * @brief compress what's left, close the stream, append the checksum
+     *
+     */
+    void finish() {
+        if (if_finished) {
+            return;
+        }
+        compress_pending();
+        put_bits(1, 1); /* final, empty block */
+        put_bits(1, 2);
+        put_symbol(256);
+        if (bit_count > 0) {
+            put_bits(0, 8 - bit_count);
+        }
+        const uint32_t adler = (adler_b << 16) | adler_a;
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<uint8_t>(adler >> shift));
+        }
+        if_finished = true;
+    }
+
+    /// @brief compressed bytes not taken yet
+    const vector<uint8_t>& output() const {
+        return out;
+    }
+    void clear_output() {
+        out.clear();
+    }
+};
+
+/**
+ * @brief zlib stream decoder for stored and fixed-Huffman blocks, enough to
+ *      read back what `Deflater` writes
+ *
+ */
+class Inflater {
+    std::span<const uint8_t> in        = {};
+    size_t                   bit_index = 0;
+
+    uint32_t get_bits(int count) {
+        uint32_t value = 0;
+        for (int i = 0; i < count; ++i, ++bit_index) {
+            if (bit_index / 8 >= in.size()) {
+                throw std::runtime_error("Deflate stream is truncated!");
+            }
+            value |= static_cast<uint32_t>((in[bit_index / 8] >> (bit_index % 8)) & 1) << i;
+        }
+        return value;
+    }
+    /// @brief Huffman codes come in most significant bit first
+    uint32_t get_code(int length) {
+        uint32_t code = 0;
+        for (int i = 0; i < length; ++i) {
+            code = (code << 1) | get_bits(1);
+        }
+        return code;
+    }
+    uint32_t get_symbol() {
+        uint32_t code = get_code(7);
+        if (code < 24) {
+            return 256 + code;
+        }
+        code = (code << 1) | get_bits(1);
+        if (code >= 0x30 && code < 0xC0) {
+            return code - 0x30;
+        }
+        if (code >= 0xC0 && code < 0xC8) {
+            return 280 + code - 0xC0;
+        }
+        code = (code << 1) | get_bits(1);
+        if (code >= 0x190) {
+            return 144 + code - 0x190;
+        }
+        throw std::runtime_error("Bad fixed Huffman code!");
+    }
+
+    explicit Inflater(std::span<const uint8_t> in)
+        : in(in) { }
+
+public:
+    /**
+     * @brief decompress the whole zlib stream `in`, checksum verified
+     *
+     * @throw std::runtime_error on dynamic-Huffman blocks, or a bad stream
+     */
+    static vector<uint8_t> inflate(std::span<const uint8_t> in) {
+        if (in.size() < 6 || (in[0] & 0x0F) != 8 || ((in[0] << 8) | in[1]) % 31 != 0) {
+            throw std::runtime_error("Bad zlib header!");
+        }
+        Inflater        reader { in.subspan(2, in.size() - 6) };
+        vector<uint8_t> out;
+        bool            if_final = false;
+        while (!if_final) {
+            if_final        = reader.get_bits(1);
+            const auto type = reader.get_bits(2);
+            if (type == 0) {
+                reader.bit_index = (reader.bit_index + 7) / 8 * 8;
+                const uint32_t length = reader.get_bits(16);
+                if ((reader.get_bits(16) ^ length) != 0xFFFF) {
+                    throw std::runtime_error("Bad stored block length!");
+                }
+                for (uint32_t i = 0; i < length; ++i) {
+                    out.push_back(static_cast<uint8_t>(reader.get_bits(8)));
+                }
+                continue;
+            }
+            if (type != 1) {
+                throw std::runtime_error("Only stored and fixed Huffman blocks are supported!");
+            }
+            for (uint32_t symbol = reader.get_symbol(); symbol != 256; symbol = reader.get_symbol()) {
+                if (symbol < 256) {
+                    out.push_back(static_cast<uint8_t>(symbol));
+                    continue;
+                }
+                const size_t l = symbol - 257;
+                const size_t d = reader.get_code(5);
+                if (l >= Deflater::length_base.size() || d >= Deflater::distance_base.size()) {
+                    throw std::runtime_error("Bad length or distance code!");
+                }
+                const size_t length   = Deflater::length_base[l] + reader.get_bits(Deflater::length_extra[l]);
+                const size_t distance = Deflater::distance_base[d] + reader.get_bits(Deflater::distance_extra[d]);
+                if (distance > out.size()) {
+                    throw std::runtime_error("Distance reaches before the stream!");
+                }
+                for (size_t i = 0; i < length; ++i) {
+                    out.push_back(out[out.size() - distance]);
+                }
+            }
+        }
+
+        uint32_t adler_a = 1, adler_b = 0;
+        for (uint8_t byte : out) {
+            adler_a = (adler_a + byte) % 65521;
+            adler_b = (adler_b + adler_a) % 65521;
+        }
+        const size_t tail  = in.size() - 4;
+        const auto   adler = static_cast<uint32_t>(in[tail] << 24 | in[tail + 1] << 16 | in[tail + 2] << 8 | in[tail + 3]);
+        if (adler != ((adler_b << 16) | adler_a)) {
+            throw std::runtime_error("Adler-32 of the inflated stream mismatches!");
+        }
+        return out;
+    }
+};
+
+} // namespace Utility
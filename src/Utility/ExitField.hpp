@@ -0,0 +1,144 @@
+/**
+ * @file ExitField.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Distance to the nearest of many exits, for every cell at once
+ * @version 0.1
+ * @date 2023-01-21
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "Heading.hpp"
+#include "Workspace.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Utility {
+
+using std::vector;
+
+/**
+ * @brief multi-source bfs field: distance and heading towards the nearest exit
+ *
+ * One bfs seeded with every exit at distance 0 labels each cell with its
+ *  distance to the closest exit, and with the heading of its parent, which is
+ *  one step closer to that exit. After that, the nearest exit of any entry and
+ *  the route to it are read in O(route length), like `RouteIndex` does for a
+ *  single target, but in memory.
+ */
+class ExitField {
+public:
+    using index_type = Workspace::index_type;
+
+    static constexpr uint32_t unreachable = UINT32_MAX;
+
+private:
+    size_t           size      = 0;
+    vector<uint32_t> distances = {};
+    vector<uint8_t>  parents   = {}; /* heading to the parent, 2 bits each */
+
+    heading parent_heading(index_type idx) const {
+        return static_cast<heading>((parents[idx / 4] >> (idx % 4 * 2)) & 0b11);
+    }
+
+public:
+    /**
+     * @brief Default constructor (empty, see `build`)
+     *
+     */
+    ExitField() = default;
+
+    /**
+     * @brief bfs from all `exits` at once
+     *
+     * @param cells  flat row-major grid, non-zero for path
+     * @param size
+     * @param exits  flat indices of open cells (duplicates are fine)
+     * @return ExitField
+     */
+    static ExitField build(
+        std::span<const uint8_t>    cells,
+        size_t                      size,
+        std::span<const index_type> exits
+    ) {
+        ExitField ret;
+        ret.size = size;
+        ret.distances.assign(cells.size(), unreachable);
+        ret.parents.assign((cells.size() + 3) / 4, 0);
+
+        Workspace ws;
+        ws.begin(cells.size());
+        for (index_type exit : exits) {
+            if (!ws.visited(exit)) {
+                ws.visit(exit, exit);
+                ws.push(exit);
+                ret.distances[exit] = 0;
+            }
+        }
+
+        while (!ws.frontier_empty()) {
+            index_type from = ws.pop();
+            size_t     x    = from / size;
+            size_t     y    = from % size;
+
+            auto relax = [&](bool if_in_range, heading dir) {
+                if (!if_in_range) {
+                    return;
+                }
+                index_type to = step(from, dir, size);
+                if (!cells[to] || ws.visited(to)) {
+                    return;
+                }
+                ws.visit(to, from);
+                ws.push(to);
+                ret.distances[to] = ret.distances[from] + 1;
+                auto code         = static_cast<uint8_t>(reverse(dir));
+                ret.parents[to / 4] |= static_cast<uint8_t>(code << (to % 4 * 2));
+            };
+            relax(x > 0, heading::north);
+            relax(x + 1 < size, heading::south);
+            relax(y > 0, heading::west);
+            relax(y + 1 < size, heading::east);
+        }
+        return ret;
+    }
+
+    bool empty() const {
+        return distances.empty();
+    }
+
+    /**
+     * @brief distance from `idx` to its nearest exit (`unreachable` if none)
+     *
+     */
+    uint32_t get_distance(index_type idx) const {
+        return distances[idx];
+    }
+
+    /**
+     * @brief the route from `source` to its nearest exit
+     *
+     * @return true if an exit is reachable, the cells are left in
+     *      `ws.get_route()` and the exit is the last one
+     */
+    bool route(Workspace& ws, index_type source) const {
+        ws.begin(distances.size());
+        if (distances[source] == unreachable) {
+            return false;
+        }
+        index_type curr = source;
+        while (distances[curr] != 0) {
+            ws.append_route(curr);
+            curr = step(curr, parent_heading(curr), size);
+        }
+        ws.append_route(curr);
+        return true;
+    }
+};
+
+} // namespace Utility
@@ -0,0 +1,313 @@
+/**
+ * @file ExternalBfs.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Out-of-core bfs over a `TiledGrid`, for mazes larger than RAM
+ * @version 0.1
+ * @date 2023-01-15
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "Heading.hpp"
+#include "RunFile.hpp"
+#include "TiledGrid.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace Utility {
+
+using std::vector;
+
+/**
+ * @brief level-synchronous bfs whose state lives in sequential run files
+ *
+ * Every level of the bfs is one run file of records `key << 2 | heading`,
+ *  sorted by the tile-major key, where `heading` points back to the parent.
+ *  Level `d + 1` is the sorted neighbours of level `d`, minus levels `d` and
+ *  `d - 1` (enough for an undirected graph), minus walls. Candidates are
+ *  sorted tile-major, so the wall check of a level loads each tile through
+ *  the cache at most once, and all other I/O is sequential. The route is read
+ *  back from the level files, last level first.
+ *
+ * Memory: half of `memory_cap` is the tile cache, the other half is shared
+ *  by the streams of a level (4 buffers of 1/8 each) and the sorter of its
+ *  candidates, which merges as many runs at once as its share allows. Every
+ *  solve keeps its files in a directory of its own under `scratch_dir`, so
+ *  solves can share it.
+ */
+class ExternalBfs {
+public:
+    using xy = std::pair<uint64_t, uint64_t>;
+
+    struct Config {
+        /// @brief where run files are kept (created, a solve removes its own)
+        std::filesystem::path scratch_dir = "ExternalBfs";
+
+        /// @brief bytes for tile cache + stream and sort buffers (split in half)
+        size_t memory_cap = size_t(256) << 20;
+    };
+
+    struct Result {
+        bool     found       = false;
+        uint64_t levels      = 0; /* route length - 1 when found */
+        uint64_t reached     = 0; /* cells discovered */
+        uint64_t tile_hits   = 0;
+        uint64_t tile_misses = 0;
+
+        /// @brief from entry to exit (empty if not found)
+        vector<xy> route = {};
+    };
+
+private:
+    static constexpr std::array<heading, 4> all_headings = {
+        heading::north,
+        heading::south,
+        heading::west,
+        heading::east,
+    };
+
+    /// @brief smallest `memory_cap`: streams of 8 records (64 bytes)
+    static constexpr size_t min_memory_cap = 16 * 8 * sizeof(uint64_t);
+
+    /// @brief walks a sorted level file alongside the candidates
+    struct Cursor {
+        RunReader* reader = nullptr;
+        uint64_t   key    = 0;
+        bool       valid  = false;
+
+        explicit Cursor(RunReader* reader)
+            : reader(reader) {
+            read();
+        }
+        void read() {
+            uint64_t record = 0;
+            valid           = reader != nullptr && reader->next(record);
+            key             = record >> 2;
+        }
+        /// @brief whether `target` is in the file (targets must not decrease)
+        bool holds(uint64_t target) {
+            while (valid && key < target) {
+                read();
+            }
+            return valid && key == target;
+        }
+    };
+
+    /// @brief a fresh directory under `parent`, removed with everything in it
+    class ScratchDir {
+        std::filesystem::path path = {};
+
+    public:
+        explicit ScratchDir(const std::filesystem::path& parent) {
+            std::filesystem::create_directories(parent);
+            // a random start, so other processes don't walk the same names
+            static std::atomic<uint64_t> next = std::random_device {}();
+            while (!std::filesystem::create_directory(path = parent / ("bfs" + std::to_string(next++)))) { }
+        }
+        ~ScratchDir() {
+            std::error_code ignored;
+            std::filesystem::remove_all(path, ignored);
+        }
+        ScratchDir(const ScratchDir&)            = delete;
+        ScratchDir& operator=(const ScratchDir&) = delete;
+
+        const std::filesystem::path& get() const {
+            return path;
+        }
+    };
+
+    TiledGrid&       grid;
+    const Config     config;
+    const ScratchDir scratch;
+    const size_t     stream_records; /* 1/8 of the stream half */
+
+    std::filesystem::path level_path(uint64_t level) const {
+        return scratch.get() / ("level" + std::to_string(level) + ".run");
+    }
+
+    /// @return false if moving `dir` from `from` leaves the maze
+    bool neighbour(const xy& from, heading dir, xy& to) const {
+        auto [x, y] = from;
+        switch (dir) {
+        case heading::north:
+            to = { x - 1, y };
+            return x > 0;
+        case heading::south:
+            to = { x + 1, y };
+            return x + 1 < grid.get_size();
+        case heading::west:
+            to = { x, y - 1 };
+            return y > 0;
+        default:
+            to = { x, y + 1 };
+            return y + 1 < grid.get_size();
+        }
+    }
+
+    /**
+     * @brief expand `level` into level + 1
+     *
+     * @return number of cells in the new level, `found` set if it has `target`
+     */
+    uint64_t expand(uint64_t level, uint64_t target, bool& found) {
+        const auto   candidates   = scratch.get() / "candidates.run";
+        const size_t stream_bytes = stream_records * sizeof(uint64_t);
+
+        // 1. every neighbour of the level, heading back to it, sorted
+        {
+            RunReader      current { level_path(level), stream_records };
+            ExternalSorter sorter {
+                scratch.get(), "candidates", config.memory_cap / 2 - stream_bytes, stream_records
+            };
+            for (uint64_t record = 0; current.next(record);) {
+                xy from = grid.to_xy(record >> 2);
+                xy to   = {};
+                for (heading dir : all_headings) {
+                    if (neighbour(from, dir, to)) {
+                        uint64_t key = grid.to_key(to.first, to.second);
+                        sorter.push(key << 2 | static_cast<uint64_t>(reverse(dir)));
+                    }
+                }
+            }
+            sorter.finish(candidates);
+        }
+
+        // 2. merge against the last two levels, drop walls
+        RunReader candidate { candidates, stream_records };
+        RunReader current { level_path(level), stream_records };
+        RunWriter next { level_path(level + 1), stream_records };
+
+        std::unique_ptr<RunReader> previous = nullptr;
+        if (level > 0) {
+            previous = std::make_unique<RunReader>(level_path(level - 1), stream_records);
+        }
+        Cursor in_current { &current };
+        Cursor in_previous { previous.get() };
+
+        bool     if_started = false;
+        uint64_t last_key   = 0;
+        for (uint64_t record = 0; candidate.next(record);) {
+            const uint64_t key = record >> 2;
+            if (if_started && key == last_key) {
+                continue; /* same cell reached from another parent */
+            }
+            if_started = true;
+            last_key   = key;
+            if (in_current.holds(key) || in_previous.holds(key)) {
+                continue;
+            }
+            if (!grid.is_open(key)) {
+                continue;
+            }
+            next.push(record);
+            if (key == target) {
+                found = true;
+            }
+        }
+        next.flush();
+        std::filesystem::remove(candidates);
+        return next.get_count();
+    }
+
+    /// @brief heading stored with `key` in the level file
+    heading parent_of(uint64_t level, uint64_t key) const {
+        RunReader reader { level_path(level), stream_records };
+        for (uint64_t record = 0; reader.next(record);) {
+            if ((record >> 2) == key) {
+                return static_cast<heading>(record & 0b11);
+            }
+        }
+        throw std::runtime_error("Cell is missing from its bfs level!");
+    }
+
+    ExternalBfs(TiledGrid& grid, Config config)
+        : grid(grid)
+        , config(std::move(config))
+        , scratch(this->config.scratch_dir)
+        , stream_records(std::clamp<size_t>(this->config.memory_cap / 16 / sizeof(uint64_t), 8, default_run_buffer)) { }
+
+public:
+    /**
+     * @brief solve from `entry` to `exit` on a tiled grid
+     *
+     * @note memory use is bounded by `config.memory_cap` (plus the route)
+     * @return Result
+     */
+    static Result solve(
+        const std::filesystem::path& tiled_path,
+        const xy&                    entry,
+        const xy&                    exit,
+        Config                       config
+    ) {
+        if (config.memory_cap < min_memory_cap) {
+            throw std::invalid_argument("Memory cap of external bfs is too small!");
+        }
+        TiledGrid   grid { tiled_path, config.memory_cap / 2 };
+        ExternalBfs bfs { grid, std::move(config) };
+        Result      ret;
+
+        const uint64_t source = grid.to_key(entry.first, entry.second);
+        const uint64_t target = grid.to_key(exit.first, exit.second);
+        if (!grid.is_open(source) || !grid.is_open(target)) {
+            throw std::invalid_argument("Coordinate is not `connected`!");
+        }
+
+        {
+            RunWriter first { bfs.level_path(0), bfs.stream_records };
+            first.push(source << 2);
+        }
+        ret.reached = 1;
+        ret.found   = source == target;
+
+        uint64_t level = 0;
+        while (!ret.found) {
+            uint64_t count = bfs.expand(level, target, ret.found);
+            ++level;
+            ret.reached += count;
+            if (count == 0) {
+                break;
+            }
+        }
+
+        if (ret.found) {
+            ret.levels = level;
+            // walk the parents back, one sequential scan per level
+            uint64_t key = target;
+            ret.route.push_back(grid.to_xy(key));
+            for (uint64_t l = level; l > 0; --l) {
+                xy parent = {};
+                bfs.neighbour(grid.to_xy(key), bfs.parent_of(l, key), parent);
+                key = grid.to_key(parent.first, parent.second);
+                ret.route.push_back(parent);
+            }
+            std::reverse(ret.route.begin(), ret.route.end());
+        }
+
+        ret.tile_hits   = grid.get_hits();
+        ret.tile_misses = grid.get_misses();
+        return ret;
+    }
+    static Result solve(
+        const std::filesystem::path& tiled_path,
+        const xy&                    entry,
+        const xy&                    exit
+    ) {
+        return solve(tiled_path, entry, exit, Config {});
+    }
+};
+
+} // namespace Utility
@@ -25,16 +25,23 @@ namespace fs = std::filesystem;
 namespace Dir {
     /* root */
     static const fs::path Root = "Files";
+    /* scratch files of out-of-core solves */
+    static const fs::path Scratch = Root / "Scratch";
 } // namespace Path
 
 namespace Filename {
-    static const fs::path MazeData = Dir::Root / "MazeData.txt";
-    static const fs::path Solved   = Dir::Root / "Solved.txt";
+    static const fs::path MazeData   = Dir::Root / "MazeData.txt";
+    static const fs::path Solved     = Dir::Root / "Solved.txt";
+    static const fs::path SolvedPng  = Dir::Root / "Solved.png";
+    static const fs::path RouteIndex = Dir::Root / "MazeData.idx";
+    static const fs::path MazeGrid   = Dir::Root / "MazeData.grid";
+    static const fs::path MazeTiles  = Dir::Root / "MazeData.tiles";
 } // namespace Filename
 
 /* all_path in a vec */
 static const std::vector<fs::path> all_path {
     Dir::Root,
+    Dir::Scratch,
 };
 
 static void create_all_dir() {
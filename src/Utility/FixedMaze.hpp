@@ -0,0 +1,301 @@
+/**
+ * @file FixedMaze.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Compile-time sized maze, solved without any heap allocation
+ * @version 0.1
+ * @date 2023-01-08
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "Maze.hpp"
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+
+namespace Utility {
+
+/**
+ * @brief maze whose size is known at compile time
+ *
+ * @tparam W width  (number of columns, `coordinate::second`)
+ * @tparam H height (number of rows, `coordinate::first`)
+ *
+ * Cells, visited bits, parents and the bfs queue all live in `std::array`,
+ * so the whole object (and a solve on it) stays on the stack.
+ */
+template <size_t W, size_t H>
+class FixedMaze {
+public:
+    static constexpr size_t width  = W;
+    static constexpr size_t height = H;
+    static constexpr size_t cells  = W * H;
+
+    static_assert(W > 0 && H > 0, "FixedMaze cannot be empty");
+
+    /// @brief smallest unsigned type which could hold a cell index
+    using index_type = std::conditional_t<
+        (cells <= UINT16_MAX),
+        uint16_t,
+        uint32_t>;
+
+    using direction    = Maze::direction;
+    using result_tuple = Maze::result_tuple;
+
+private:
+    std::array<uint8_t, cells>    data    = {};
+    std::array<direction, cells>  parents = {};
+    std::array<index_type, cells> queue   = {};
+    std::array<index_type, cells> route   = {};
+    std::bitset<cells>            visited = {};
+
+    size_t     route_length     = 0;
+    index_type entry            = 0;
+    index_type exit             = 0;
+    bool       if_have_solution = false;
+
+    static constexpr index_type to_index(const coordinate& cord) {
+        return static_cast<index_type>(cord.first * W + cord.second);
+    }
+    static constexpr coordinate to_coordinate(index_type idx) {
+        return { static_cast<int>(idx / W), static_cast<int>(idx % W) };
+    }
+    static constexpr bool if_in_range(const coordinate& cord) {
+        return cord.first >= 0 && cord.first < static_cast<int>(H)
+            && cord.second >= 0 && cord.second < static_cast<int>(W);
+    }
+
+    void assert_coordinate_connectivity(const coordinate& input) const {
+        if (!if_in_range(input)) {
+            throw std::out_of_range("Coordinate out of range!");
+        }
+        if (data[to_index(input)] == 0) {
+            throw std::invalid_argument("Coordinate is not `connected`!");
+        }
+    }
+
+    /**
+     * @brief visit every open neighbour of `idx`
+     *
+     * @note the stencil is spelled out instead of looping over offsets,
+     *      `dir` is the direction leading from the neighbour back to `idx`
+     *      (same convention as `Maze::trace_direction`)
+     */
+    template <class Fn>
+    void for_each_adj(index_type idx, Fn&& fn) const {
+        const size_t x = idx / W;
+        const size_t y = idx % W;
+        if (x > 0 && data[idx - W]) {
+            fn(static_cast<index_type>(idx - W), direction::right);
+        }
+        if (x + 1 < H && data[idx + W]) {
+            fn(static_cast<index_type>(idx + W), direction::left);
+        }
+        if (y > 0 && data[idx - 1]) {
+            fn(static_cast<index_type>(idx - 1), direction::up);
+        }
+        if (y + 1 < W && data[idx + 1]) {
+            fn(static_cast<index_type>(idx + 1), direction::down);
+        }
+    }
+    static constexpr index_type step(index_type idx, direction dir) {
+        switch (dir) {
+        case direction::up:
+            return idx + 1;
+        case direction::down:
+            return idx - 1;
+        case direction::right:
+            return idx + W;
+        case direction::left:
+            return idx - W;
+        default:
+            return idx;
+        }
+    }
+
+    void bfs_algo() {
+        visited.reset();
+        size_t head = 0;
+        size_t tail = 0;
+
+        queue[tail++] = entry;
+        visited.set(entry);
+
+        while (head != tail) {
+            index_type from = queue[head++];
+            if (from == exit) {
+                if_have_solution = true;
+                return;
+            }
+            for_each_adj(from, [&](index_type to, direction dir) {
+                if (visited.test(to)) {
+                    return;
+                }
+                visited.set(to);
+                parents[to]   = dir;
+                queue[tail++] = to;
+            });
+        }
+
+        // if reached here, no route found
+        if_have_solution = false;
+    }
+    void trace_route() {
+        route_length = 0;
+        if (!if_have_solution) {
+            return;
+        }
+        // walk back from exit, then reverse in place
+        index_type cord = exit;
+        while (cord != entry) {
+            route[route_length++] = cord;
+            cord                  = step(cord, parents[cord]);
+        }
+        route[route_length++] = entry;
+        std::reverse(route.begin(), route.begin() + route_length);
+    }
+
+public:
+    /**
+     * @brief Default constructor
+     *
+     */
+    FixedMaze() = default;
+
+    /**
+     * @brief create from { matrix, entry, exit }
+     *
+     * @param matrix  must be exactly `H` rows of `W` columns
+     * @param entry
+     * @param exit
+     * @return FixedMaze
+     */
+    static FixedMaze create(
+        const matrix<int>& matrix,
+        const coordinate&  entry,
+        const coordinate&  exit
+    ) {
+        FixedMaze ret;
+        ret.set(matrix, entry, exit);
+        return ret;
+    }
+
+    /**
+     * @brief set => { matrix, entry, exit }
+     *
+     * @param matrix
+     * @param entry
+     * @param exit
+     */
+    void set(
+        const matrix<int>& matrix,
+        const coordinate&  entry,
+        const coordinate&  exit
+    ) {
+        if (matrix.size() != H) {
+            throw std::invalid_argument("Matrix height mismatches FixedMaze!");
+        }
+        for (size_t i = 0; i < H; ++i) {
+            if (matrix[i].size() != W) {
+                throw std::invalid_argument("Matrix width mismatches FixedMaze!");
+            }
+            for (size_t j = 0; j < W; ++j) {
+                data[i * W + j] = matrix[i][j] != 0;
+            }
+        }
+        assert_coordinate_connectivity(entry);
+        assert_coordinate_connectivity(exit);
+        this->entry = to_index(entry);
+        this->exit  = to_index(exit);
+    }
+
+    /**
+     * @brief solve by `bfs`, touching nothing but the inline arrays
+     *
+     * @return true if a route exists
+     */
+    bool solve() {
+        bfs_algo();
+        trace_route();
+        return if_have_solution;
+    }
+
+    /**
+     * @brief number of cells on the route (0 if there's none)
+     *
+     */
+    size_t get_route_length() const {
+        return route_length;
+    }
+
+    /**
+     * @brief coordinate of the `i`_th cell on the route, from entry to exit
+     *
+     */
+    coordinate get_route_at(size_t i) const {
+        return to_coordinate(route[i]);
+    }
+
+    /**
+     * @brief solve the maze, then export it like `Maze::bfs_solution`
+     *
+     * @note only exporting the matrix allocates, the search itself does not
+     * @return tuple<bool, matrix<int>, coordinate, coordinate>
+     */
+    result_tuple bfs_solution() {
+        solve();
+        matrix<int> ret(H, vector<int>(W, 0));
+        for (size_t i = 0; i < H; ++i) {
+            for (size_t j = 0; j < W; ++j) {
+                ret[i][j] = data[i * W + j];
+            }
+        }
+        for (size_t i = 0; i < route_length; ++i) {
+            auto [x, y] = get_route_at(i);
+            ret[x][y]   = 2;
+        }
+        return { if_have_solution, ret, to_coordinate(entry), to_coordinate(exit) };
+    }
+};
+
+/**
+ * @brief try the square `FixedMaze` specializations in `Sizes...`
+ *
+ * @param route  if not null, receives the route as flat row-major indices
+ * @return solved tuple if `matrix.size()` is one of `Sizes`, otherwise nullopt
+ *      (caller should then fall back to the runtime-sized `Maze`)
+ */
+template <size_t... Sizes>
+std::optional<Maze::result_tuple> fixed_bfs_solution(
+    const matrix<int>&        matrix,
+    const coordinate&         entry,
+    const coordinate&         exit,
+    vector<Maze::index_type>* route = nullptr
+) {
+    std::optional<Maze::result_tuple> ret = std::nullopt;
+    auto try_size = [&]<size_t Size>() {
+        if (ret.has_value() || matrix.size() != Size) {
+            return;
+        }
+        auto maze = FixedMaze<Size, Size>::create(matrix, entry, exit);
+        ret       = maze.bfs_solution();
+        if (route != nullptr) {
+            route->clear();
+            for (size_t i = 0; i < maze.get_route_length(); ++i) {
+                auto [x, y] = maze.get_route_at(i);
+                route->push_back(static_cast<Maze::index_type>(x * Size + y));
+            }
+        }
+    };
+    (try_size.template operator()<Sizes>(), ...);
+    return ret;
+}
+
+} // namespace Utility
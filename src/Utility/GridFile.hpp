@@ -0,0 +1,183 @@
+/**
+ * @file GridFile.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Binary, memory-mappable maze file (one byte per cell)
+ * @version 0.1
+ * @date 2023-01-14
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "GridLayout.hpp"
+#include "MappedFile.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Utility {
+
+/**
+ * @brief maze stored as `Header` + one byte per cell, in the order of
+ *      `Header::layout` (row-major unless asked otherwise)
+ *
+ * Only bit 0 of a cell is data (1 for path). The other bits are spare, so
+ *  solvers could keep per-cell marks inside the mapped file itself (see
+ *  `LowMemorySolver.hpp`).
+ */
+class GridFile {
+public:
+    using index_type = uint32_t;
+
+    static constexpr uint8_t open_bit = 0b1;
+
+    struct Header {
+        char     magic[8] = { 'M', 'A', 'Z', 'E', 'G', 'R', 'I', 'D' };
+        uint32_t version  = 2;
+        uint32_t size     = 0;
+        int32_t  entry_x  = -1;
+        int32_t  entry_y  = -1;
+        int32_t  exit_x   = -1;
+        int32_t  exit_y   = -1;
+        uint32_t layout   = 0; /* `Utility::layout` */
+        uint32_t reserved = 0;
+    };
+
+private:
+    MappedFile file   = {};
+    Header     header = {};
+
+public:
+    /**
+     * @brief Default constructor (no file)
+     *
+     */
+    GridFile() = default;
+
+    /**
+     * @brief write a square grid (cells are non-zero for path)
+     *
+     * @param cells   row-major, whatever `order` is
+     * @param order   layout of the cells in the file
+     */
+    static void write(
+        const std::filesystem::path& path,
+        std::span<const uint8_t>     cells,
+        size_t                       size,
+        std::pair<int, int>          entry,
+        std::pair<int, int>          exit,
+        layout                       order = layout::row_major
+    ) {
+        if (cells.size() != size * size) {
+            throw std::invalid_argument("Grid is not square!");
+        }
+        Header header;
+        header.size    = static_cast<uint32_t>(size);
+        header.entry_x = entry.first;
+        header.entry_y = entry.second;
+        header.exit_x  = exit.first;
+        header.exit_y  = exit.second;
+        header.layout  = static_cast<uint32_t>(order);
+
+        std::vector<uint8_t> laid;
+        if (order == layout::tiled_morton) {
+            laid  = to_layout<TiledMortonLayout>(cells, size);
+            cells = laid;
+        }
+
+        std::ofstream file { path, std::ios::binary | std::ios::trunc };
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot create grid file!");
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        std::vector<char> chunk;
+        chunk.reserve(std::min<size_t>(cells.size(), 1 << 16));
+        for (size_t i = 0; i < cells.size(); ++i) {
+            chunk.push_back(static_cast<char>(cells[i] != 0 ? open_bit : 0));
+            if (chunk.size() == chunk.capacity() || i + 1 == cells.size()) {
+                file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                chunk.clear();
+            }
+        }
+        if (!file.good()) {
+            throw std::runtime_error("Cannot write grid file!");
+        }
+    }
+
+    /**
+     * @brief map a grid file
+     *
+     * @param path
+     * @param mode  `read_write` if a solver is going to mark cells
+     * @return GridFile
+     */
+    static GridFile open(
+        const std::filesystem::path& path,
+        MappedFile::access           mode = MappedFile::access::read_only
+    ) {
+        GridFile ret;
+        ret.file = MappedFile(path, mode);
+        if (ret.file.get_size() < sizeof(Header)) {
+            throw std::runtime_error("Grid file is too short!");
+        }
+        std::memcpy(&ret.header, ret.file.get_data(), sizeof(Header));
+        if (std::memcmp(ret.header.magic, Header {}.magic, sizeof(Header::magic)) != 0
+            || ret.header.version != Header {}.version
+            || ret.header.layout > static_cast<uint32_t>(layout::tiled_morton)) {
+            throw std::runtime_error("Not a grid file!");
+        }
+        if (ret.file.get_size() != sizeof(Header) + ret.cell_count()) {
+            throw std::runtime_error("Grid file size mismatches its header!");
+        }
+        return ret;
+    }
+
+    size_t get_size() const {
+        return header.size;
+    }
+    /// @brief cells stored, padding included
+    size_t cell_count() const {
+        if (get_layout() == layout::tiled_morton) {
+            return TiledMortonLayout { header.size }.cell_count();
+        }
+        return static_cast<size_t>(header.size) * header.size;
+    }
+    layout get_layout() const {
+        return static_cast<layout>(header.layout);
+    }
+    std::pair<int, int> get_entry() const {
+        return { header.entry_x, header.entry_y };
+    }
+    std::pair<int, int> get_exit() const {
+        return { header.exit_x, header.exit_y };
+    }
+
+    /**
+     * @brief the mapped cells (read-only), in `get_layout()` order
+     *
+     */
+    std::span<const uint8_t> get_cells() const {
+        auto base = reinterpret_cast<const uint8_t*>(file.get_data() + sizeof(Header));
+        return { base, cell_count() };
+    }
+
+    /**
+     * @brief the mapped cells, writable if opened `read_write`
+     *
+     */
+    std::span<uint8_t> get_mutable_cells() {
+        auto base = reinterpret_cast<uint8_t*>(file.get_mutable_data() + sizeof(Header));
+        return { base, cell_count() };
+    }
+};
+
+} // namespace Utility
@@ -0,0 +1,244 @@
+/**
+ * @file GridLayout.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Policies mapping grid coordinates to flat cell indices
+ * @version 0.1
+ * @date 2023-01-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace Utility {
+
+/**
+ * @brief order of the cells in flat storage (stored in `GridFile` headers)
+ *
+ */
+enum class layout : uint32_t {
+    row_major    = 0, /* x * size + y */
+    tiled_morton = 1, /* 32 x 32 tiles in row-major order, Z-order inside */
+};
+
+/**
+ * @brief the classic layout, a vertical step is `size` cells away
+ *
+ */
+class RowMajorLayout {
+public:
+    using index_type = uint32_t;
+
+    static constexpr layout tag = layout::row_major;
+
+private:
+    size_t size = 0;
+
+public:
+    explicit RowMajorLayout(size_t size)
+        : size(size) { }
+
+    size_t cell_count() const {
+        return size * size;
+    }
+    index_type to_index(size_t x, size_t y) const {
+        return static_cast<index_type>(x * size + y);
+    }
+    std::pair<size_t, size_t> to_xy(index_type idx) const {
+        return { idx / size, idx % size };
+    }
+
+    /**
+     * @brief call `fn(adj)` on every open neighbour of `idx`
+     *      (order: x - 1, x + 1, y - 1, y + 1)
+     *
+     */
+    template <class Fn>
+    void for_each_adj(std::span<const uint8_t> cells, index_type idx, Fn&& fn) const {
+        const size_t x = idx / size;
+        const size_t y = idx % size;
+        if (x > 0 && cells[idx - size]) {
+            fn(static_cast<index_type>(idx - size));
+        }
+        if (x + 1 < size && cells[idx + size]) {
+            fn(static_cast<index_type>(idx + size));
+        }
+        if (y > 0 && cells[idx - 1]) {
+            fn(static_cast<index_type>(idx - 1));
+        }
+        if (y + 1 < size && cells[idx + 1]) {
+            fn(static_cast<index_type>(idx + 1));
+        }
+    }
+};
+
+/**
+ * @brief 32 x 32 tiles stored one after another, Z-order (Morton) inside
+ *
+ * A tile is 1024 cells, i.e. 1 KiB of cells or one 4 KiB page of a
+ *  `uint32_t` table such as the workspace stamps, so a frontier spreading in
+ *  2D stays within few cache lines and pages. The grid is padded to whole
+ *  tiles, padding cells are walls.
+ *
+ * Inside a tile the index is `x` and `y` interleaved (x on the odd bits), so
+ *  a step is a masked increment / decrement of the local index and only
+ *  tile borders need the tile arithmetic.
+ */
+class TiledMortonLayout {
+public:
+    using index_type = uint32_t;
+
+    static constexpr layout tag = layout::tiled_morton;
+
+    static constexpr size_t     tile_bits  = 5;
+    static constexpr size_t     tile_side  = size_t(1) << tile_bits;
+    static constexpr size_t     tile_cells = tile_side * tile_side;
+    static constexpr index_type local_mask = tile_cells - 1;
+    static constexpr index_type x_mask     = 0x2AA & local_mask; /* odd bits */
+    static constexpr index_type y_mask     = 0x155 & local_mask; /* even bits */
+
+private:
+    size_t     tiles_side = 0;
+    index_type row_stride = 0; /* cells between vertically adjacent tiles */
+    index_type last_row   = 0; /* index of the first tile of the last row */
+
+    static index_type spread(index_type value, index_type mask) {
+#if defined(__BMI2__)
+        return _pdep_u32(value, mask);
+#else
+        // bits 0..4 => bits 0, 2, 4, 6, 8, shifted onto the odd bits for x
+        value = (value | (value << 4)) & 0x0F0F;
+        value = (value | (value << 2)) & 0x3333;
+        value = (value | (value << 1)) & 0x5555;
+        return mask == x_mask ? value << 1 : value;
+#endif
+    }
+    static index_type gather(index_type local, index_type mask) {
+#if defined(__BMI2__)
+        return _pext_u32(local, mask);
+#else
+        index_type value = (mask == x_mask ? local >> 1 : local) & 0x5555;
+        value = (value | (value >> 1)) & 0x3333;
+        value = (value | (value >> 2)) & 0x0F0F;
+        value = (value | (value >> 4)) & 0x00FF;
+        return value;
+#endif
+    }
+
+public:
+    explicit TiledMortonLayout(size_t size)
+        : tiles_side((size + tile_side - 1) / tile_side)
+        , row_stride(static_cast<index_type>(tiles_side * tile_cells))
+        , last_row(static_cast<index_type>(
+              tiles_side == 0 ? 0 : (tiles_side - 1) * tiles_side * tile_cells
+          )) { }
+
+    size_t cell_count() const {
+        return tiles_side * tiles_side * tile_cells;
+    }
+    index_type to_index(size_t x, size_t y) const {
+        const size_t tile = (x >> tile_bits) * tiles_side + (y >> tile_bits);
+        return static_cast<index_type>(tile * tile_cells)
+             | spread(static_cast<index_type>(x & (tile_side - 1)), x_mask)
+             | spread(static_cast<index_type>(y & (tile_side - 1)), y_mask);
+    }
+    std::pair<size_t, size_t> to_xy(index_type idx) const {
+        const size_t     tile  = idx >> (2 * tile_bits);
+        const index_type local = idx & local_mask;
+        return {
+            (tile / tiles_side) * tile_side + gather(local, x_mask),
+            (tile % tiles_side) * tile_side + gather(local, y_mask),
+        };
+    }
+
+    /**
+     * @brief call `fn(adj)` on every open neighbour of `idx`
+     *      (order: x - 1, x + 1, y - 1, y + 1)
+     *
+     */
+    template <class Fn>
+    void for_each_adj(std::span<const uint8_t> cells, index_type idx, Fn&& fn) const {
+        const index_type base  = idx & ~local_mask;
+        const index_type local = idx & local_mask;
+        const index_type lx    = local & x_mask;
+        const index_type ly    = local & y_mask;
+
+        // x - 1
+        if (lx != 0) {
+            index_type adj = base | (((lx - 2) & x_mask) | ly);
+            if (cells[adj]) {
+                fn(adj);
+            }
+        } else if (base >= row_stride) {
+            index_type adj = (base - row_stride) | x_mask | ly;
+            if (cells[adj]) {
+                fn(adj);
+            }
+        }
+        // x + 1 (cells below the maze are padding, i.e. walls)
+        if (lx != x_mask) {
+            index_type adj = base | ((((local | y_mask) + 1) & x_mask) | ly);
+            if (cells[adj]) {
+                fn(adj);
+            }
+        } else if (base < last_row) {
+            index_type adj = (base + row_stride) | ly;
+            if (cells[adj]) {
+                fn(adj);
+            }
+        }
+        // y - 1
+        if (ly != 0) {
+            index_type adj = base | (lx | ((ly - 1) & y_mask));
+            if (cells[adj]) {
+                fn(adj);
+            }
+        } else if ((base / tile_cells) % tiles_side != 0) {
+            index_type adj = (base - static_cast<index_type>(tile_cells)) | lx | y_mask;
+            if (cells[adj]) {
+                fn(adj);
+            }
+        }
+        // y + 1 (cells right of the maze are padding, i.e. walls)
+        if (ly != y_mask) {
+            index_type adj = base | (lx | (((local | x_mask) + 1) & y_mask));
+            if (cells[adj]) {
+                fn(adj);
+            }
+        } else if ((base / tile_cells) % tiles_side + 1 != tiles_side) {
+            index_type adj = (base + static_cast<index_type>(tile_cells)) | lx;
+            if (cells[adj]) {
+                fn(adj);
+            }
+        }
+    }
+};
+
+/**
+ * @brief copy row-major `cells` (`size` x `size`) into `Layout` order
+ *
+ */
+template <class Layout>
+std::vector<uint8_t> to_layout(std::span<const uint8_t> cells, size_t size) {
+    const Layout         grid { size };
+    std::vector<uint8_t> ret(grid.cell_count(), 0);
+    for (size_t x = 0; x < size; ++x) {
+        for (size_t y = 0; y < size; ++y) {
+            ret[grid.to_index(x, y)] = cells[x * size + y];
+        }
+    }
+    return ret;
+}
+
+} // namespace Utility
@@ -0,0 +1,64 @@
+/**
+ * @file Heading.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief The four moves on a flat, row-major grid
+ * @version 0.1
+ * @date 2023-01-12
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Utility {
+
+/**
+ * @brief one step on the grid, fits in 2 bits
+ *
+ */
+enum class heading : uint8_t {
+    north, /* x - 1 */
+    south, /* x + 1 */
+    west,  /* y - 1 */
+    east,  /* y + 1 */
+};
+
+/**
+ * @brief the opposite heading
+ *
+ */
+constexpr heading reverse(heading dir) {
+    switch (dir) {
+    case heading::north:
+        return heading::south;
+    case heading::south:
+        return heading::north;
+    case heading::west:
+        return heading::east;
+    default:
+        return heading::west;
+    }
+}
+
+/**
+ * @brief flat index reached by moving `dir` from `idx` on a `width`-wide grid
+ *
+ */
+constexpr uint32_t step(uint32_t idx, heading dir, size_t width) {
+    switch (dir) {
+    case heading::north:
+        return idx - static_cast<uint32_t>(width);
+    case heading::south:
+        return idx + static_cast<uint32_t>(width);
+    case heading::west:
+        return idx - 1;
+    default:
+        return idx + 1;
+    }
+}
+
+} // namespace Utility
@@ -0,0 +1,246 @@
+/**
+ * @file ImageExport.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Stream a maze and its route into a PBM / PGM / PNG image
+ * @version 0.1
+ * @date 2023-01-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "Deflate.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Utility {
+
+using std::vector;
+
+enum class image_format {
+    pbm, /* 1 bit per pixel, walls black (the route is not shown) */
+    pgm, /* 8 bits per pixel gray */
+    png, /* 2 bits per pixel gray, deflated */
+};
+
+/**
+ * @brief render a maze row by row, never holding more than one image row
+ *
+ * The maze is read from flat row-major `cells` (bit 0 for path, as in `Maze`
+ *  or a mapped `GridFile`) plus the route as flat indices, so no overlay
+ *  matrix is needed. With `scale > 1` every pixel covers a `scale` x `scale`
+ *  block of cells, showing the route if any cell of it is on the route, else
+ *  path if any cell is open.
+ */
+class ImageExport {
+public:
+    using index_type = uint32_t;
+
+private:
+    /* rendered pixels, by priority when downscaling */
+    static constexpr uint8_t wall  = 0;
+    static constexpr uint8_t path  = 1;
+    static constexpr uint8_t route = 2;
+
+    /* gray levels per pixel kind */
+    static constexpr std::array<uint8_t, 3> gray_8bit = { 0, 255, 160 };
+    static constexpr std::array<uint8_t, 3> gray_2bit = { 0, 3, 2 };
+
+    std::span<const uint8_t> cells;
+    size_t                   size;
+    size_t                   scale;
+    vector<index_type>       sorted_route;
+
+    size_t          next_route = 0;
+    size_t          next_x     = 0;
+    vector<uint8_t> pixels     = {};
+
+    ImageExport(
+        std::span<const uint8_t>    cells,
+        size_t                      size,
+        std::span<const index_type> route,
+        size_t                      scale
+    )
+        : cells(cells)
+        , size(size)
+        , scale(scale)
+        , sorted_route(route.begin(), route.end()) {
+        if (cells.size() != size * size) {
+            throw std::invalid_argument("Grid is not square!");
+        }
+        if (scale == 0) {
+            throw std::invalid_argument("Scale cannot be 0!");
+        }
+        std::sort(sorted_route.begin(), sorted_route.end());
+        pixels.resize(width());
+    }
+
+    size_t width() const {
+        return (size + scale - 1) / scale;
+    }
+
+    /// @brief render the next image row into `pixels`
+    const vector<uint8_t>& next_row() {
+        std::fill(pixels.begin(), pixels.end(), wall);
+        const size_t row_end = std::min(size, next_x + scale);
+        for (; next_x < row_end; ++next_x) {
+            const size_t offset = next_x * size;
+            for (size_t y = 0; y < size; ++y) {
+                uint8_t kind = (cells[offset + y] & 1) ? path : wall;
+                // the route is sorted row-major, so it's merged in passing
+                while (next_route < sorted_route.size() && sorted_route[next_route] < offset + y) {
+                    ++next_route;
+                }
+                if (next_route < sorted_route.size() && sorted_route[next_route] == offset + y) {
+                    kind = route;
+                }
+                uint8_t& pixel = pixels[y / scale];
+                pixel          = std::max(pixel, kind);
+            }
+        }
+        return pixels;
+    }
+
+    static std::ofstream open_output(const std::filesystem::path& path) {
+        std::ofstream file { path, std::ios::binary | std::ios::trunc };
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot create image file!");
+        }
+        return file;
+    }
+    static void put(std::ofstream& file, std::span<const uint8_t> bytes) {
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    void write_pnm(std::ofstream& file, bool if_bitmap) {
+        const std::string header = if_bitmap
+                                     ? "P4\n" + std::to_string(width()) + " " + std::to_string(width()) + "\n"
+                                     : "P5\n" + std::to_string(width()) + " " + std::to_string(width()) + "\n255\n";
+        file << header;
+
+        vector<uint8_t> line(if_bitmap ? (width() + 7) / 8 : width());
+        for (size_t r = 0; r < width(); ++r) {
+            const auto& row = next_row();
+            if (if_bitmap) {
+                std::fill(line.begin(), line.end(), 0);
+                for (size_t y = 0; y < row.size(); ++y) {
+                    if (row[y] == wall) {
+                        line[y / 8] |= static_cast<uint8_t>(0x80 >> (y % 8));
+                    }
+                }
+            } else {
+                for (size_t y = 0; y < row.size(); ++y) {
+                    line[y] = gray_8bit[row[y]];
+                }
+            }
+            put(file, line);
+        }
+    }
+
+    static void put_chunk(std::ofstream& file, const char (&type)[5], std::span<const uint8_t> data) {
+        const auto                   length       = static_cast<uint32_t>(data.size());
+        const std::array<uint8_t, 4> length_bytes = {
+            static_cast<uint8_t>(length >> 24),
+            static_cast<uint8_t>(length >> 16),
+            static_cast<uint8_t>(length >> 8),
+            static_cast<uint8_t>(length),
+        };
+        const std::span<const uint8_t> type_bytes { reinterpret_cast<const uint8_t*>(type), 4 };
+
+        Crc32 crc;
+        crc.update(type_bytes);
+        crc.update(data);
+        const uint32_t               value     = crc.value();
+        const std::array<uint8_t, 4> crc_bytes = {
+            static_cast<uint8_t>(value >> 24),
+            static_cast<uint8_t>(value >> 16),
+            static_cast<uint8_t>(value >> 8),
+            static_cast<uint8_t>(value),
+        };
+        put(file, length_bytes);
+        put(file, type_bytes);
+        put(file, data);
+        put(file, crc_bytes);
+    }
+
+    void write_png(std::ofstream& file) {
+        static constexpr std::array<uint8_t, 8> signature = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        static constexpr size_t                 idat_size = size_t(1) << 16;
+
+        put(file, signature);
+
+        const auto              side = static_cast<uint32_t>(width());
+        std::array<uint8_t, 13> ihdr = {
+            static_cast<uint8_t>(side >> 24), static_cast<uint8_t>(side >> 16),
+            static_cast<uint8_t>(side >> 8), static_cast<uint8_t>(side),
+            static_cast<uint8_t>(side >> 24), static_cast<uint8_t>(side >> 16),
+            static_cast<uint8_t>(side >> 8), static_cast<uint8_t>(side),
+            2, /* bit depth */
+            0, /* grayscale */
+            0, /* deflate */
+            0, /* adaptive filtering */
+            0, /* not interlaced */
+        };
+        put_chunk(file, "IHDR", ihdr);
+
+        Deflater        deflater;
+        vector<uint8_t> line(1 + (width() + 3) / 4);
+        for (size_t r = 0; r < width(); ++r) {
+            const auto& row = next_row();
+            std::fill(line.begin(), line.end(), 0); /* filter byte 0: none */
+            for (size_t y = 0; y < row.size(); ++y) {
+                line[1 + y / 4] |= static_cast<uint8_t>(gray_2bit[row[y]] << (6 - 2 * (y % 4)));
+            }
+            deflater.write(line);
+            if (deflater.output().size() >= idat_size) {
+                put_chunk(file, "IDAT", deflater.output());
+                deflater.clear_output();
+            }
+        }
+        deflater.finish();
+        put_chunk(file, "IDAT", deflater.output());
+        put_chunk(file, "IEND", {});
+    }
+
+public:
+    /**
+     * @brief write the maze with its route into an image at `path`
+     *
+     * @param cells   flat row-major cells, bit 0 for path
+     * @param size    the maze is `size` x `size`
+     * @param route   flat indices of the route, in any order (may be empty)
+     * @param format
+     * @param scale   cells per pixel side, the image is `ceil(size / scale)` wide
+     */
+    static void write(
+        const std::filesystem::path& path,
+        std::span<const uint8_t>     cells,
+        size_t                       size,
+        std::span<const index_type>  route,
+        image_format                 format,
+        size_t                       scale = 1
+    ) {
+        ImageExport   image { cells, size, route, scale };
+        std::ofstream file = open_output(path);
+        if (format == image_format::png) {
+            image.write_png(file);
+        } else {
+            image.write_pnm(file, format == image_format::pbm);
+        }
+        if (!file.good()) {
+            throw std::runtime_error("Cannot write image file!");
+        }
+    }
+};
+
+} // namespace Utility
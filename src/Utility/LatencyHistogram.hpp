@@ -0,0 +1,120 @@
+/**
+ * @file LatencyHistogram.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Log-linear histogram of latencies, for percentiles of a replay
+ * @version 0.1
+ * @date 2023-01-23
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace Utility {
+
+/**
+ * @brief HDR-style histogram of non-negative integer values (nanoseconds)
+ *
+ * Values below `2 * sub_buckets` have a bucket each, above that every power
+ *  of two is split into `sub_buckets` equal buckets, so any value is kept
+ *  within 1 / `sub_buckets` (0.4%) of itself over the whole 64-bit range, in
+ *  a fixed 116 KiB. Recording is a bit scan and an increment; histograms of
+ *  several threads are merged by adding counts.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int      sub_bucket_bits = 8;
+    static constexpr uint64_t sub_buckets     = uint64_t(1) << sub_bucket_bits;
+
+private:
+    static constexpr size_t bucket_count = sub_buckets * (64 - sub_bucket_bits + 1);
+
+    std::vector<uint64_t> counts = std::vector<uint64_t>(bucket_count, 0);
+
+    uint64_t total   = 0;
+    uint64_t lowest  = UINT64_MAX;
+    uint64_t highest = 0;
+    double   sum     = 0;
+
+    static int shift_of(uint64_t value) {
+        return std::max(0, static_cast<int>(std::bit_width(value)) - sub_bucket_bits - 1);
+    }
+    static size_t bucket_of(uint64_t value) {
+        const int shift = shift_of(value);
+        return static_cast<size_t>(sub_buckets * shift + (value >> shift));
+    }
+    /// @brief the largest value that falls into `bucket`
+    static uint64_t highest_in(size_t bucket) {
+        const int shift = bucket < 2 * sub_buckets
+                            ? 0
+                            : static_cast<int>(bucket / sub_buckets) - 1;
+        const uint64_t low = (bucket - sub_buckets * shift) << shift;
+        return low + ((uint64_t(1) << shift) - 1);
+    }
+
+public:
+    void record(uint64_t value) {
+        ++counts[bucket_of(value)];
+        ++total;
+        lowest  = std::min(lowest, value);
+        highest = std::max(highest, value);
+        sum += static_cast<double>(value);
+    }
+
+    /// @brief add every value recorded by `other`
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < bucket_count; ++i) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        lowest  = std::min(lowest, other.lowest);
+        highest = std::max(highest, other.highest);
+        sum += other.sum;
+    }
+
+    uint64_t count() const {
+        return total;
+    }
+    uint64_t min() const {
+        return total == 0 ? 0 : lowest;
+    }
+    uint64_t max() const {
+        return highest;
+    }
+    double mean() const {
+        return total == 0 ? 0 : sum / static_cast<double>(total);
+    }
+
+    /**
+     * @brief the value at `percentile` (in [0, 100]) of the recorded values
+     *
+     * @note like HdrHistogram, the highest value equivalent to the one
+     *      ranked `ceil(percentile% * count)`, capped by the real maximum
+     */
+    uint64_t value_at(double percentile) const {
+        if (total == 0) {
+            return 0;
+        }
+        const double clamped = std::clamp(percentile, 0.0, 100.0);
+        const auto   rank    = std::max<uint64_t>(
+            1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(total)))
+        );
+        uint64_t seen = 0;
+        for (size_t i = 0; i < bucket_count; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return std::min(highest_in(i), highest);
+            }
+        }
+        return highest;
+    }
+};
+
+} // namespace Utility
@@ -0,0 +1,274 @@
+/**
+ * @file LowMemorySolver.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Solvers needing O(1) / O(route) extra memory (wall follower, Trémaux)
+ * @version 0.1
+ * @date 2023-01-14
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "GridFile.hpp"
+#include "Heading.hpp"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Utility {
+
+using std::vector;
+
+/**
+ * @brief solvers which keep no per-cell tables of their own
+ *
+ * Both work on a flat row-major grid (e.g. the cells of a mapped `GridFile`),
+ *  where bit 0 of a cell means path. Neither route is guaranteed shortest.
+ *
+ * - wall follower: read-only, O(route) memory, correct when the maze has no
+ *      loops (e.g. every maze of `Generator`)
+ * - Trémaux: works on any maze, keeps its marks in the spare bits of the grid
+ *      (2 bits per edge: the south edge in bits 2-3, the east one in 4-5)
+ */
+class LowMemorySolver {
+public:
+    using index_type = uint32_t;
+
+private:
+    static constexpr uint8_t open_bit   = GridFile::open_bit;
+    static constexpr int     south_mark = 2;
+    static constexpr int     east_mark  = 4;
+
+    static constexpr std::array<heading, 4> all_headings = {
+        heading::north,
+        heading::south,
+        heading::west,
+        heading::east,
+    };
+
+    static constexpr heading turn_left(heading dir) {
+        switch (dir) {
+        case heading::north:
+            return heading::west;
+        case heading::west:
+            return heading::south;
+        case heading::south:
+            return heading::east;
+        default:
+            return heading::north;
+        }
+    }
+    static constexpr heading turn_right(heading dir) {
+        return reverse(turn_left(dir));
+    }
+
+    static bool if_open_towards(
+        std::span<const uint8_t> cells,
+        size_t                   size,
+        index_type               idx,
+        heading                  dir
+    ) {
+        const size_t x = idx / size;
+        const size_t y = idx % size;
+        switch (dir) {
+        case heading::north:
+            return x > 0 && (cells[idx - size] & open_bit);
+        case heading::south:
+            return x + 1 < size && (cells[idx + size] & open_bit);
+        case heading::west:
+            return y > 0 && (cells[idx - 1] & open_bit);
+        default:
+            return y + 1 < size && (cells[idx + 1] & open_bit);
+        }
+    }
+
+    /// @brief { owner cell, bit shift } of the edge leaving `idx` towards `dir`
+    static std::pair<index_type, int> edge_of(size_t size, index_type idx, heading dir) {
+        switch (dir) {
+        case heading::north:
+            return { static_cast<index_type>(idx - size), south_mark };
+        case heading::south:
+            return { idx, south_mark };
+        case heading::west:
+            return { idx - 1, east_mark };
+        default:
+            return { idx, east_mark };
+        }
+    }
+    static int marks(std::span<const uint8_t> cells, size_t size, index_type idx, heading dir) {
+        auto [owner, shift] = edge_of(size, idx, dir);
+        return (cells[owner] >> shift) & 0b11;
+    }
+    static void add_mark(std::span<uint8_t> cells, size_t size, index_type idx, heading dir) {
+        auto [owner, shift] = edge_of(size, idx, dir);
+        int  count          = ((cells[owner] >> shift) & 0b11) + 1;
+        cells[owner]        = static_cast<uint8_t>((cells[owner] & ~(0b11 << shift)) | (count << shift));
+    }
+
+public:
+    /**
+     * @brief drop every mark (one sequential pass, no memory)
+     *
+     */
+    static void clear_marks(std::span<uint8_t> cells) {
+        for (uint8_t& cell : cells) {
+            cell &= open_bit;
+        }
+    }
+
+    /**
+     * @brief follow the left-hand wall from `source` until `target`
+     *
+     * @note backtracking out of a dead end pops the route, so on a loop-free
+     *      maze the route is the unique simple one
+     * @return false once the walker is back in its first state
+     */
+    static bool wall_follower_route(
+        std::span<const uint8_t> cells,
+        size_t                   size,
+        index_type               source,
+        index_type               target,
+        vector<index_type>&      route
+    ) {
+        route.clear();
+        route.push_back(source);
+
+        heading    dir  = heading::north;
+        index_type curr = source;
+
+        auto advance = [&]() {
+            for (heading next : { turn_left(dir), dir, turn_right(dir), reverse(dir) }) {
+                if (if_open_towards(cells, size, curr, next)) {
+                    dir  = next;
+                    curr = step(curr, dir, size);
+                    if (route.size() >= 2 && route[route.size() - 2] == curr) {
+                        route.pop_back();
+                    } else {
+                        route.push_back(curr);
+                    }
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        if (curr == target) {
+            return true;
+        }
+        if (!advance()) {
+            route.clear();
+            return false;
+        }
+        // the walk is deterministic and reversible, so it can only loop
+        // back through this very state
+        const index_type first_cell = curr;
+        const heading    first_dir  = dir;
+        while (curr != target) {
+            advance();
+            if (curr == first_cell && dir == first_dir) {
+                route.clear();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Trémaux's algorithm, marks kept inside `cells`
+     *
+     * @note marks are cleared before searching, afterwards the edges marked
+     *      exactly once form the route, which is read out into `route`
+     * @return true if a route exists
+     */
+    static bool tremaux_route(
+        std::span<uint8_t>  cells,
+        size_t              size,
+        index_type          source,
+        index_type          target,
+        vector<index_type>& route
+    ) {
+        clear_marks(cells);
+        route.clear();
+
+        index_type curr     = source;
+        heading    came     = heading::north; /* towards the previous cell */
+        bool       has_came = false;
+
+        while (curr != target) {
+            bool if_turn_back = false;
+            if (has_came && marks(cells, size, curr, came) == 1) {
+                // been here before through another edge => it's a loop
+                for (heading dir : all_headings) {
+                    if (dir != came
+                        && if_open_towards(cells, size, curr, dir)
+                        && marks(cells, size, curr, dir) > 0) {
+                        if_turn_back = true;
+                        break;
+                    }
+                }
+            }
+
+            heading next = came;
+            if (!if_turn_back) {
+                // fewest marks wins, the way back only if nothing else is left
+                int  best_rank = 0;
+                bool if_found  = false;
+                for (heading dir : all_headings) {
+                    if (!if_open_towards(cells, size, curr, dir)) {
+                        continue;
+                    }
+                    int count = marks(cells, size, curr, dir);
+                    if (count >= 2) {
+                        continue;
+                    }
+                    int rank = 2 * count + (has_came && dir == came ? 1 : 0);
+                    if (!if_found || rank < best_rank) {
+                        next      = dir;
+                        best_rank = rank;
+                        if_found  = true;
+                    }
+                }
+                if (!if_found) {
+                    // every edge is marked twice, the search is exhausted
+                    return false;
+                }
+            }
+
+            add_mark(cells, size, curr, next);
+            curr     = step(curr, next, size);
+            came     = reverse(next);
+            has_came = true;
+        }
+
+        // read out the once-marked path
+        route.push_back(source);
+        has_came = false;
+        for (curr = source; curr != target;) {
+            bool if_moved = false;
+            for (heading dir : all_headings) {
+                if ((!has_came || dir != came)
+                    && if_open_towards(cells, size, curr, dir)
+                    && marks(cells, size, curr, dir) == 1) {
+                    curr     = step(curr, dir, size);
+                    came     = reverse(dir);
+                    has_came = true;
+                    if_moved = true;
+                    break;
+                }
+            }
+            if (!if_moved) {
+                throw std::runtime_error("Trémaux marks are inconsistent!");
+            }
+            route.push_back(curr);
+        }
+        return true;
+    }
+};
+
+} // namespace Utility
@@ -0,0 +1,174 @@
+/**
+ * @file MappedFile.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Memory mapping of a whole file
+ * @version 0.1
+ * @date 2023-01-12
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAZE_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define MAZE_HAS_MMAP 0
+#endif
+
+namespace Utility {
+
+/**
+ * @brief a file mapped into memory (move-only)
+ *
+ * @note on platforms without `mmap` the file is read into a buffer instead
+ *      (and written back on destruction if it was mapped `read_write`)
+ */
+class MappedFile {
+public:
+    enum class access {
+        read_only,
+        read_write, /* writes go straight to the file */
+    };
+
+private:
+    std::byte* data   = nullptr;
+    size_t     length = 0;
+
+#if MAZE_HAS_MMAP
+    void* mapping = nullptr;
+#else
+    std::vector<std::byte> buffer = {};
+    std::filesystem::path  origin = {};
+    access                 mode   = access::read_only;
+#endif
+
+    void release() {
+#if MAZE_HAS_MMAP
+        if (mapping != nullptr) {
+            ::munmap(mapping, length);
+        }
+        mapping = nullptr;
+#else
+        if (mode == access::read_write && !buffer.empty()) {
+            std::ofstream file { origin, std::ios::binary | std::ios::trunc };
+            file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        }
+        buffer.clear();
+#endif
+        data   = nullptr;
+        length = 0;
+    }
+
+public:
+    /**
+     * @brief Default constructor (maps nothing)
+     *
+     */
+    MappedFile() = default;
+
+    /**
+     * @brief map the whole file at `path`
+     *
+     * @throw std::runtime_error if the file can't be opened or mapped
+     */
+    explicit MappedFile(
+        const std::filesystem::path& path,
+        access                       mode = access::read_only
+    ) {
+#if MAZE_HAS_MMAP
+        const bool if_writable = mode == access::read_write;
+
+        int fd = ::open(path.c_str(), if_writable ? O_RDWR : O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open file to map!");
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot stat file to map!");
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length != 0) {
+            int protection = if_writable ? PROT_READ | PROT_WRITE : PROT_READ;
+            mapping        = ::mmap(nullptr, length, protection, MAP_SHARED, fd, 0);
+            if (mapping == MAP_FAILED) {
+                mapping = nullptr;
+                ::close(fd);
+                throw std::runtime_error("Cannot map file!");
+            }
+            data = static_cast<std::byte*>(mapping);
+        }
+        ::close(fd);
+#else
+        std::ifstream file { path, std::ios::binary };
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open file to map!");
+        }
+        buffer.resize(std::filesystem::file_size(path));
+        file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+        data         = buffer.data();
+        length       = buffer.size();
+        this->origin = path;
+        this->mode   = mode;
+#endif
+    }
+
+    ~MappedFile() {
+        release();
+    }
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept {
+        *this = std::move(other);
+    }
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            release();
+            data   = other.data;
+            length = other.length;
+#if MAZE_HAS_MMAP
+            mapping       = other.mapping;
+            other.mapping = nullptr;
+#else
+            buffer = std::move(other.buffer);
+            origin = std::move(other.origin);
+            mode   = other.mode;
+            other.buffer.clear();
+#endif
+            other.data   = nullptr;
+            other.length = 0;
+        }
+        return *this;
+    }
+
+    const std::byte* get_data() const {
+        return data;
+    }
+    /// @attention only write through this if mapped `read_write`
+    std::byte* get_mutable_data() {
+        return data;
+    }
+    size_t get_size() const {
+        return length;
+    }
+    bool empty() const {
+        return length == 0;
+    }
+};
+
+} // namespace Utility
@@ -11,23 +11,36 @@
 
 #pragma once
 
+#include "BoundedSearch.hpp"
+#include "Components.hpp"
+#include "CorridorGraph.hpp"
+#include "ExitField.hpp"
+#include "GridLayout.hpp"
+#include "RouteCache.hpp"
+#include "RouteIndex.hpp"
+#include "Search.hpp"
+#include "TreeIndex.hpp"
+#include "Workspace.hpp"
+
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <cstdlib>
+#include <filesystem>
 #include <functional>
 #include <iostream>
-#include <list>
-#include <queue>
-#include <ranges>
+#include <memory>
+#include <span>
 #include <stdexcept>
+#include <tuple>
+#include <type_traits>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 namespace Utility {
 
-using std::list;
 using std::pair;
-using std::queue;
 using std::tuple;
 using std::unordered_set;
 using std::vector;
@@ -41,6 +54,8 @@ using coordinate = pair<int, int>;
 
 class Maze {
 public:
+    using index_type = Workspace::index_type;
+
     enum class direction {
         nil, /* special case */
         up,
@@ -57,35 +72,106 @@ public:
         };
     };
 
+    using search_status = Utility::search_status;
+    using no_monitor    = Utility::no_monitor;
+    using result_tuple  = tuple<bool, matrix<int>, coordinate, coordinate>;
+
 private:
-    matrix<int>       data             = {};
-    matrix<direction> route_data       = {};
-    coordinate        entry            = { -1, -1 };
-    coordinate        exit             = { -1, -1 };
-    size_t            size             = 0;
-    bool              if_have_solution = true;
+    matrix<int>     data             = {};
+    vector<uint8_t> cells            = {};
+    coordinate      entry            = { -1, -1 };
+    coordinate      exit             = { -1, -1 };
+    size_t          size             = 0;
+    bool            if_have_solution = true;
+
+    /// @brief scratch memory reused by every solve on this maze
+    Workspace workspace = {};
+
+    /// @brief contracted junction graph (empty until `contract_corridors`)
+    CorridorGraph corridors = {};
+
+    /// @brief connected components, labelled whenever the data is set
+    Components components = {};
+
+    /// @brief mapped shortest-path tree towards `exit` (see `load_route_index`)
+    RouteIndex route_index = {};
+
+    /// @brief lca index of the spanning tree, empty unless the maze is perfect
+    TreeIndex tree = {};
+
+    /// @brief layout searched by `bfs_search`, `cells` stay row-major
+    layout cell_layout = layout::row_major;
+
+    /// @brief `cells` in `cell_layout` order (empty when row-major)
+    vector<uint8_t> laid_cells = {};
+
+    /// @brief landmark distances for `alt_search` (see `prepare_landmarks`)
+    Landmarks landmarks = {};
+
+    /// @brief unique per content, a new one on every `set_data` / `reset_data`
+    uint64_t version = 0;
+
+    /// @brief shared source of `version`, 0 is never handed out
+    static inline std::atomic<uint64_t> last_version = 0;
+
+    /// @brief outcome of the last `bounded_solution`
+    BoundedStats bounded_stats = {};
+
+    /// @brief route of the last `bounded_solution`, exported instead of `workspace`'s
+    vector<index_type> bounded_cells = {};
+
+    /// @brief whether the last `*_solution` left its route in `bounded_cells`
+    bool if_bounded_solution = false;
+
+    /// @brief results of `bfs_solution` (see `set_route_cache`)
+    std::shared_ptr<RouteCache> route_cache = nullptr;
 
     void init_size() {
         size = data.size();
     }
-    void init_route_data() {
-        route_data.reserve(size);
-        auto temp = sub_matrix<direction>(
-            size,
-            direction::nil
-        );
+    void init_cells() {
+        cells.assign(size * size, 0);
         for (size_t i = 0; i < size; ++i) {
-            route_data.emplace_back(temp);
+            for (size_t j = 0; j < size; ++j) {
+                cells[i * size + j] = data[i][j] != 0;
+            }
+        }
+    }
+    void init_laid_cells() {
+        if (cell_layout == layout::tiled_morton) {
+            laid_cells = to_layout<TiledMortonLayout>(cells, size);
+        } else {
+            laid_cells.clear();
         }
     }
     void set_data(const matrix<int>& matrix) {
         this->data = matrix;
         init_size();
-        init_route_data();
+        init_cells();
+        init_laid_cells();
+        init_components();
+        init_tree();
+        corridors   = {};
+        route_index = {};
+        landmarks   = {};
+        version     = ++last_version;
+    }
+    void init_components() {
+        components = Components::label(cells, size);
+    }
+    void init_tree() {
+        tree = TreeIndex::build(cells, size);
     }
     void reset_data() {
         data.clear();
-        route_data.clear();
+        cells.clear();
+        laid_cells.clear();
+        corridors   = {};
+        components  = {};
+        route_index = {};
+        tree        = {};
+        landmarks   = {};
+        version     = ++last_version;
         size = 0;
     }
     void assert_data_init() const {
@@ -93,9 +179,9 @@ private:
             throw std::runtime_error("Data Matrix has not been initialized!");
         }
     }
-    void assert_route_data_init() const {
-        if (route_data.size() == 0 || route_data.front().size() == 0) {
-            throw std::runtime_error("Route Data Matrix has not been initialized!");
+    void assert_cells_init() const {
+        if (cells.size() != size * size || cells.empty()) {
+            throw std::runtime_error("Cells have not been initialized!");
         }
     }
 
@@ -136,215 +222,93 @@ private:
         }
     }
 
-    vector<coordinate> get_all_adj(const coordinate& input) {
-        int                x = input.first;
-        int                y = input.second;
-        vector<coordinate> ret;
-        vector<coordinate> possible {
-            { x - 1, y },
-            { x + 1, y },
-            { x, y - 1 },
-            { x, y + 1 },
-        };
-
-        auto if_in_range = [this](const coordinate& input) {
-            int  x             = input.first;
-            int  y             = input.second;
-            bool if_x_in_range = x >= 0 && x < size;
-            bool if_y_in_range = y >= 0 && y < size;
-            return if_x_in_range && if_y_in_range;
-        };
-
-        for (const auto& cord : possible) {
-            if (if_in_range(cord)) {
-                auto x = cord.first;
-                auto y = cord.second;
-                if (data.at(x).at(y)) {
-                    ret.push_back(cord);
-                }
-            }
-        }
-        return ret;
-    };
-    int m_dist(const coordinate& lhs, const coordinate& rhs) {
+    /**
+     * @brief call `fn(adj_index)` on every open neighbour of `idx`
+     *
+     * @note replaces the old `get_all_adj`, which built a vector per call
+     */
+    template <class Fn>
+    void for_each_adj(index_type idx, Fn&& fn) const {
+        RowMajorLayout { size }.for_each_adj(cells, idx, fn);
+    }
+    int m_dist(const coordinate& lhs, const coordinate& rhs) const {
         int x_abs = std::abs(lhs.first - rhs.first);
         int y_abs = std::abs(lhs.second - rhs.second);
         return x_abs + y_abs;
     }
-    direction trace_direction(const coordinate& to, const coordinate& from) {
-        if (from.first + 1 == to.first) {
-            return direction::left;
-        }
-        if (to.first + 1 == from.first) {
-            return direction::right;
-        }
-        if (from.second + 1 == to.second) {
-            return direction::down;
-        }
-        if (to.second + 1 == from.second) {
-            return direction::up;
-        }
-        return direction::nil;
-    }
-    coordinate move_to(const coordinate& from, direction direction) {
-        int        x   = from.first;
-        int        y   = from.second;
-        coordinate ret = { x, y };
-        switch (direction) {
-        case direction::up:
-            ++ret.second;
-            break;
-        case direction::down:
-            --ret.second;
-            break;
-        case direction::right:
-            ++ret.first;
-            break;
-        case direction::left:
-            --ret.first;
-            break;
-        case direction::nil:
-            throw std::runtime_error("direction == nil, exception occurred!");
-            break;
-        }
-        return ret;
-    }
-    coordinate get_lowest_cost(const vector<coordinate>& input) {
-        struct cost_info {
-            coordinate cord {};
-            int        g_cost = 0;
-            int        h_cost = 0;
-            int        cost   = 0;
-            cost_info()       = delete;
-            explicit cost_info(coordinate cord)
-                : cord(std::move(cord)) { }
-        };
-        vector<cost_info> all_info;
-        all_info.reserve(input.size());
-        for (const coordinate& cord : input) {
-            all_info.emplace_back(cord);
-            cost_info& back = all_info.back();
-            back.g_cost     = m_dist(entry, back.cord);
-            back.h_cost     = m_dist(back.cord, exit);
-            back.cost       = back.g_cost + back.h_cost;
-        }
-        std::stable_sort(
-            all_info.begin(),
-            all_info.end(),
-            [](const cost_info& lhs, const cost_info& rhs) {
-                return lhs.cost < rhs.cost;
-            }
-        );
-        std::stable_sort(
-            all_info.begin(),
-            all_info.end(),
-            [](const cost_info& lhs, const cost_info& rhs) {
-                return lhs.h_cost < rhs.h_cost;
-            }
-        );
-        return all_info.front().cord;
-    }
-    list<coordinate> get_route() {
-        list<coordinate> ret  = {};
-        coordinate       cord = exit;
-        while (cord != entry) {
-            int x = cord.first;
-            int y = cord.second;
-            ret.push_front(cord);
-            cord = move_to(
-                cord,
-                route_data.at(x).at(y)
-            );
-        }
-        ret.push_front(entry);
-        return ret;
-    }
 
     void bfs_algo() {
-        unordered_set<coordinate, CoordinateHash> visited;
-        queue<coordinate>                         queue;
-        queue.push(entry);
-        visited.insert(entry);
-
-        auto if_unvisited = [&](const coordinate& cord) {
-            return !visited.contains(cord);
-        };
-
-        while (!queue.empty()) {
-            coordinate from = queue.front();
-            if (from == exit) {
-                return;
-            }
-            vector<coordinate> all_adj  = get_all_adj(from);
-            auto               filtered = all_adj | std::views::filter(if_unvisited);
-            vector<coordinate> all_unvisited_adj {
-                filtered.begin(),
-                filtered.end()
-            };
-            for (const coordinate& to : all_unvisited_adj) {
-                /* aliases */
-                int x = to.first;
-                int y = to.second;
-
-                /* trace the direction */
-                route_data.at(x).at(y) = trace_direction(to, from);
-
-                /* push unvisited adj into the queue */
-                queue.push(to);
-                visited.insert(to);
-            }
-            queue.pop();
+        if (route_cache) {
+            if_have_solution = cached_route(*route_cache, workspace, entry, exit);
+            return;
         }
-
-        // if reached here, no route found
-        // throw std::runtime_error("No route found!");
-        if_have_solution = false;
-        return;
+        if_have_solution = is_perfect()
+                             ? tree_route(workspace, entry, exit)
+                             : bfs_route(workspace, entry, exit);
+    }
+    void corridor_algo() {
+        if_have_solution = corridor_route(workspace, entry, exit);
+    }
+    void indexed_algo() {
+        if_have_solution = indexed_route(workspace, entry, exit);
     }
     void a_star_algo() {
-        unordered_set<coordinate, CoordinateHash> visited;
+        const index_type source = to_index(entry);
+        const index_type target = to_index(exit);
 
-        auto if_unvisited = [&](const coordinate& cord) {
-            return !visited.contains(cord);
-        };
+        if (!components.connected(source, target)) {
+            if_have_solution = false;
+            return;
+        }
 
-        coordinate curr = entry;
+        workspace.begin(cells.size());
+        workspace.visit(source, source);
 
-        while (curr != exit) {
-            vector<coordinate> all_adj  = get_all_adj(curr);
-            auto               filtered = all_adj | std::views::filter(if_unvisited);
-            vector<coordinate> all_unvisited_adj {
-                filtered.begin(),
-                filtered.end()
-            };
+        index_type curr = source;
+
+        while (curr != target) {
+            // pick the unvisited adj with the lowest h_cost,
+            // ties broken by the lowest (g_cost + h_cost), then by order
+            index_type lowest_cost = Workspace::npos;
+            int        best_h      = 0;
+            int        best_cost   = 0;
+            for_each_adj(curr, [&](index_type adj) {
+                if (workspace.visited(adj)) {
+                    return;
+                }
+                coordinate cord   = to_coordinate(adj);
+                int        h_cost = m_dist(cord, exit);
+                int        cost   = m_dist(entry, cord) + h_cost;
+                if (lowest_cost == Workspace::npos
+                    || h_cost < best_h
+                    || (h_cost == best_h && cost < best_cost)) {
+                    lowest_cost = adj;
+                    best_h      = h_cost;
+                    best_cost   = cost;
+                }
+            });
 
             // if no unvisited adj, no route found
-            if (all_unvisited_adj.empty()) {
-                // throw std::runtime_error("No route found!");
+            if (lowest_cost == Workspace::npos) {
                 if_have_solution = false;
                 return;
             }
 
-            coordinate lowest_cost = get_lowest_cost(all_unvisited_adj);
-
-            int x = lowest_cost.first;
-            int y = lowest_cost.second;
-
-            route_data.at(x).at(y) = trace_direction(lowest_cost, curr);
-
-            visited.insert(curr);
+            workspace.visit(lowest_cost, curr);
             curr = lowest_cost;
         }
+
+        workspace.trace(source, target);
+        if_have_solution = true;
     }
 
-    matrix<int> export_solved_maze() {
-        matrix<int> ret = data;
-        for (const coordinate& cord : get_route()) {
-            int x           = cord.first;
-            int y           = cord.second;
-            ret.at(x).at(y) = 2;
+    /// @brief tuple of a `*_solution`, its route stays in `bounded_cells` or `workspace`
+    result_tuple export_solution(bool if_bounded) {
+        if_bounded_solution = if_bounded;
+        if (!if_have_solution) {
+            return { false, data, entry, exit };
         }
-        return ret;
+        return { true, overlay_route(get_solution_route()), entry, exit };
     }
 
 public:
@@ -356,7 +320,7 @@ public:
 
     void assert_maze_initialized() {
         assert_data_init();
-        assert_route_data_init();
+        assert_cells_init();
         assert_entry_init();
         assert_exit_init();
     }
@@ -408,7 +372,713 @@ public:
         reset_exit();
     }
 
-    using result_tuple = tuple<bool, matrix<int>, coordinate, coordinate>;
+    /**
+     * @brief get the data matrix (0 for wall, 1 for path)
+     *
+     * @return const matrix<int>&
+     */
+    const matrix<int>& get_data() const {
+        return data;
+    }
+
+    /**
+     * @brief get the size (maze is always square)
+     *
+     * @return size_t
+     */
+    size_t get_size() const {
+        return size;
+    }
+
+    /**
+     * @brief get the flat row-major cells (1 for path)
+     *
+     * @return std::span<const uint8_t>
+     */
+    std::span<const uint8_t> get_cells() const {
+        return cells;
+    }
+
+    /**
+     * @brief choose the cell layout searched by `bfs_search`
+     *
+     * @note `tiled_morton` keeps a second, tiled copy of the cells (padded to
+     *      whole 32 x 32 tiles) and pays off on large mazes, where row-major
+     *      vertical steps miss the cache. Indices in the api stay row-major
+     */
+    void set_layout(layout target) {
+        cell_layout = target;
+        init_laid_cells();
+    }
+
+    /**
+     * @brief get the cell layout searched by `bfs_search`
+     *
+     * @return layout
+     */
+    layout get_layout() const {
+        return cell_layout;
+    }
+
+    /**
+     * @brief copy of the data with `route` marked as 2
+     *
+     * @param route  flat indices, e.g. `Workspace::get_route()`
+     * @return matrix<int>
+     */
+    matrix<int> overlay_route(std::span<const index_type> route) const {
+        matrix<int> ret = data;
+        for (index_type idx : route) {
+            auto [x, y]     = to_coordinate(idx);
+            ret.at(x).at(y) = 2;
+        }
+        return ret;
+    }
+
+    /**
+     * @brief get the entry
+     *
+     * @return const coordinate&
+     */
+    const coordinate& get_entry() const {
+        return entry;
+    }
+
+    /**
+     * @brief get the exit
+     *
+     * @return const coordinate&
+     */
+    const coordinate& get_exit() const {
+        return exit;
+    }
+
+    /**
+     * @brief move the query to another { entry, exit } on the same matrix
+     *
+     * @note the workspace is kept, so consecutive queries reuse its memory
+     * @param entry
+     * @param exit
+     */
+    void set_endpoints(
+        const coordinate& entry,
+        const coordinate& exit
+    ) {
+        set_entry(entry);
+        set_exit(exit);
+    }
+
+    /**
+     * @brief flat index of a coordinate (row-major)
+     *
+     */
+    index_type to_index(const coordinate& cord) const {
+        return static_cast<index_type>(cord.first * size + cord.second);
+    }
+
+    /**
+     * @brief coordinate of a flat index (row-major)
+     *
+     */
+    coordinate to_coordinate(index_type idx) const {
+        return { static_cast<int>(idx / size), static_cast<int>(idx % size) };
+    }
+
+    /**
+     * @brief the search made of the `Open` and `Visited` policies and
+     *      `heuristic` (see `grid_search`), from `entry` to `exit`
+     *
+     * @note dispatches on the cell layout, the route is always row-major.
+     *      `bfs_search` and `a_star_search` are two such combinations
+     */
+    template <class Open, class Visited = StampVisited, class Heuristic, class Monitor>
+    search_status policy_search(
+        Workspace&        ws,
+        const coordinate& entry,
+        const coordinate& exit,
+        const Heuristic&  heuristic,
+        Monitor&&         if_continue
+    ) const {
+        if (!components.connected(to_index(entry), to_index(exit))) {
+            ws.begin(cells.size());
+            return search_status::no_route;
+        }
+        const pair<size_t, size_t> from = { entry.first, entry.second };
+        const pair<size_t, size_t> to   = { exit.first, exit.second };
+        if (cell_layout == layout::tiled_morton) {
+            return grid_search<Open, Visited>(
+                TiledMortonLayout { size }, laid_cells, size, ws, from, to, heuristic, if_continue
+            );
+        }
+        return grid_search<Open, Visited>(
+            RowMajorLayout { size }, cells, size, ws, from, to, heuristic, if_continue
+        );
+    }
+
+    /**
+     * @brief `bfs` from `entry` to `exit`, asking `if_continue(expanded)`
+     *      after every expanded cell whether to go on
+     *
+     * @note when stopped, the route leads to the expanded cell closest
+     *      (manhattan) to `exit`, i.e. the best partial result so far
+     */
+    template <class Monitor>
+    search_status bfs_search(
+        Workspace&        ws,
+        const coordinate& entry,
+        const coordinate& exit,
+        Monitor&&         if_continue
+    ) const {
+        return policy_search<FifoOpen>(ws, entry, exit, NoHeuristic {}, if_continue);
+    }
+
+    /**
+     * @brief `bfs` from `entry` to `exit` inside a caller-owned workspace
+     *
+     * @note never mutates `this`, so one maze could serve several threads,
+     *      each with its own workspace. The route is left in `ws.get_route()`
+     * @return true if a route exists
+     */
+    bool bfs_route(
+        Workspace&        ws,
+        const coordinate& entry,
+        const coordinate& exit
+    ) const {
+        return bfs_search(ws, entry, exit, no_monitor {}) == search_status::found;
+    }
+
+    /**
+     * @brief optimal `a*` (manhattan heuristic) from `entry` to `exit`,
+     *      asking `if_continue(expanded)` after every expanded cell
+     *
+     * @note unlike `a_star_solution` (a greedy walk, kept as it was), the
+     *      route is a shortest one. Ties on `g + h` go to the deepest cell,
+     *      so open areas are crossed without flooding them. When stopped,
+     *      the route leads to the expanded cell closest to `exit`
+     */
+    template <class Monitor>
+    search_status a_star_search(
+        Workspace&        ws,
+        const coordinate& entry,
+        const coordinate& exit,
+        Monitor&&         if_continue
+    ) const {
+        ManhattanHeuristic heuristic {
+            static_cast<size_t>(exit.first),
+            static_cast<size_t>(exit.second),
+        };
+        return policy_search<HeapOpen>(ws, entry, exit, heuristic, if_continue);
+    }
+
+    /**
+     * @brief optimal `a*` inside a caller-owned workspace (see `bfs_route`)
+     *
+     * @return true if a route exists
+     */
+    bool a_star_route(
+        Workspace&        ws,
+        const coordinate& entry,
+        const coordinate& exit
+    ) const {
+        return a_star_search(ws, entry, exit, no_monitor {}) == search_status::found;
+    }
+
+    /**
+     * @brief pick `count` landmarks for `alt_search`, farthest-first from
+     *      the entry (or the first open cell)
+     *
+     * @note O(count * cells) time, 4 bytes per cell per landmark
+     */
+    void prepare_landmarks(size_t count = 4) {
+        assert_data_init();
+        index_type seed = 0;
+        if (entry.first >= 0 && data[entry.first][entry.second] != 0) {
+            seed = to_index(entry);
+        } else {
+            while (seed < cells.size() && !cells[seed]) {
+                ++seed;
+            }
+            if (seed == cells.size()) {
+                landmarks = {};
+                return;
+            }
+        }
+        landmarks = Landmarks::pick(cells, size, seed, count);
+    }
+
+    /**
+     * @brief optimal `a*` with the ALT heuristic (landmarks and triangle
+     *      inequality) on a bucket queue
+     *
+     * @note needs `prepare_landmarks` first; without landmarks the estimate
+     *      is 0 and this is a plain uniform-cost search
+     */
+    template <class Monitor>
+    search_status alt_search(
+        Workspace&        ws,
+        const coordinate& entry,
+        const coordinate& exit,
+        Monitor&&         if_continue
+    ) const {
+        AltHeuristic heuristic { landmarks, to_index(exit) };
+        return policy_search<BucketOpen>(ws, entry, exit, heuristic, if_continue);
+    }
+
+    /**
+     * @brief `alt_search` inside a caller-owned workspace (see `bfs_route`)
+     *
+     * @return true if a route exists
+     */
+    bool alt_route(
+        Workspace&        ws,
+        const coordinate& entry,
+        const coordinate& exit
+    ) const {
+        return alt_search(ws, entry, exit, no_monitor {}) == search_status::found;
+    }
+
+    const Landmarks& get_landmarks() const {
+        return landmarks;
+    }
+
+    /**
+     * @brief `bfs` from both ends at once, asking `if_continue(expanded)`
+     *      after every expanded cell
+     *
+     * @note `ws` searches from `entry` and receives the route, `back` from
+     *      `exit`. The smaller frontier grows by one whole level at a time,
+     *      and the level where both searches touch yields the shortest
+     *      route. When stopped, the route leads to the cell closest to `exit`
+     *      expanded from `entry`
+     */
+    template <class Monitor>
+    search_status bidirectional_search(
+        Workspace&        ws,
+        Workspace&        back,
+        const coordinate& entry,
+        const coordinate& exit,
+        Monitor&&         if_continue
+    ) const {
+        static constexpr bool if_monitored
+            = !std::is_same_v<std::decay_t<Monitor>, no_monitor>;
+
+        const index_type source = to_index(entry);
+        const index_type target = to_index(exit);
+
+        ws.begin(cells.size());
+        back.begin(cells.size());
+        if (!components.connected(source, target)) {
+            return search_status::no_route;
+        }
+        if (source == target) {
+            ws.trace(source, target);
+            return search_status::found;
+        }
+        ws.visit(source, source);
+        ws.set_distance(source, 0);
+        ws.push(source);
+        back.visit(target, target);
+        back.set_distance(target, 0);
+        back.push(target);
+
+        // best meeting edge so far: `meet_front` (from entry) -> `meet_back`
+        index_type meet_front = Workspace::npos;
+        index_type meet_back  = Workspace::npos;
+        index_type meet_cost  = Workspace::npos;
+
+        index_type best     = source;
+        int        best_h   = m_dist(entry, exit);
+        size_t     expanded = 0;
+
+        while (!ws.frontier_empty() && !back.frontier_empty()) {
+            const bool if_forward = ws.frontier_size() <= back.frontier_size();
+            Workspace& side       = if_forward ? ws : back;
+            Workspace& other      = if_forward ? back : ws;
+
+            for (size_t level = side.frontier_size(); level > 0; --level) {
+                index_type from = side.pop();
+                if constexpr (if_monitored) {
+                    if (if_forward) {
+                        int h_cost = m_dist(to_coordinate(from), exit);
+                        if (h_cost < best_h) {
+                            best   = from;
+                            best_h = h_cost;
+                        }
+                    }
+                    if (!if_continue(++expanded)) {
+                        ws.trace(source, best);
+                        return search_status::stopped;
+                    }
+                }
+                for_each_adj(from, [&](index_type to) {
+                    if (other.visited(to)) {
+                        // the cells of both sides never overlap
+                        index_type cost = side.get_distance(from) + 1 + other.get_distance(to);
+                        if (cost < meet_cost) {
+                            meet_cost  = cost;
+                            meet_front = if_forward ? from : to;
+                            meet_back  = if_forward ? to : from;
+                        }
+                        return;
+                    }
+                    if (side.visited(to)) {
+                        return;
+                    }
+                    side.visit(to, from);
+                    side.set_distance(to, side.get_distance(from) + 1);
+                    side.push(to);
+                });
+            }
+
+            if (meet_cost != Workspace::npos) {
+                // entry .. meet_front by `ws`, then meet_back .. exit by `back`
+                ws.trace(source, meet_front);
+                for (index_type curr = meet_back; curr != target; curr = back.parent(curr)) {
+                    ws.append_route(curr);
+                }
+                ws.append_route(target);
+                return search_status::found;
+            }
+        }
+
+        // if reached here, no route found
+        return search_status::no_route;
+    }
+
+    /**
+     * @brief bidirectional `bfs` inside two caller-owned workspaces, the
+     *      route is left in `ws` (see `bfs_route`)
+     *
+     * @return true if a route exists
+     */
+    bool bidirectional_route(
+        Workspace&        ws,
+        Workspace&        back,
+        const coordinate& entry,
+        const coordinate& exit
+    ) const {
+        return bidirectional_search(ws, back, entry, exit, no_monitor {}) == search_status::found;
+    }
+
+    /**
+     * @brief O(1) check whether `entry` and `exit` are in the same component
+     *
+     * @note labels are computed once in `set`, no search happens here
+     */
+    bool connected(
+        const coordinate& entry,
+        const coordinate& exit
+    ) const {
+        return components.connected(to_index(entry), to_index(exit));
+    }
+
+    /**
+     * @brief get the component labels
+     *
+     * @return const Components&
+     */
+    const Components& get_components() const {
+        return components;
+    }
+
+    /**
+     * @brief whether the open cells form one tree (one route between any
+     *      two cells), as every maze of `Generator` does
+     *
+     * @note detected in `set`, where the lca index is built for `tree_route`
+     */
+    bool is_perfect() const {
+        return !tree.empty();
+    }
+
+    /**
+     * @brief identifies the current content, changed by every `set` / `reset`
+     *
+     * @note unique across all mazes, so it can key caches shared by them
+     */
+    uint64_t get_version() const {
+        return version;
+    }
+
+    /**
+     * @brief answer `bfs_solution` from `cache` first (nullptr to stop)
+     *
+     * @note entries are keyed by `get_version`, so `set` / `reset` invalidate
+     *      them; one cache may serve many mazes
+     */
+    void set_route_cache(std::shared_ptr<RouteCache> cache) {
+        route_cache = std::move(cache);
+    }
+
+    /**
+     * @brief a shortest route looked up in `cache`, solved and stored there
+     *      on a miss (tree route on perfect mazes, bfs otherwise)
+     *
+     * @note const and lock-free on a hit, one cache may serve many threads
+     * @return true if a route exists, the cells are left in `ws.get_route()`
+     */
+    bool cached_route(
+        RouteCache&       cache,
+        Workspace&        ws,
+        const coordinate& entry,
+        const coordinate& exit
+    ) const {
+        const RouteCache::Key key { version, to_index(entry), to_index(exit) };
+        if (auto hit = cache.lookup(key, size, ws)) {
+            return *hit;
+        }
+        const bool found = is_perfect()
+                             ? tree_route(ws, entry, exit)
+                             : bfs_route(ws, entry, exit);
+        cache.store(key, size, found, ws.get_route());
+        return found;
+    }
+
+    /**
+     * @brief route on the spanning tree of a perfect maze, no search at all
+     *
+     * @note O(route length), falls back to `bfs_route` if not perfect
+     * @return true if a route exists (false if either end is a wall)
+     */
+    bool tree_route(
+        Workspace&        ws,
+        const coordinate& entry,
+        const coordinate& exit
+    ) const {
+        if (!is_perfect()) {
+            return bfs_route(ws, entry, exit);
+        }
+        return tree.route(ws, to_index(entry), to_index(exit));
+    }
+
+    /**
+     * @brief length (in steps) of the route between two cells, O(1) on a
+     *      perfect maze
+     *
+     * @return index_type  `Workspace::npos` if not perfect, or either end is a wall
+     */
+    index_type tree_distance(
+        const coordinate& entry,
+        const coordinate& exit
+    ) const {
+        return is_perfect() ? tree.distance(to_index(entry), to_index(exit)) : Workspace::npos;
+    }
+
+    /**
+     * @brief every open cell on the border, i.e. every possible exit
+     *
+     * @return vector<coordinate>  row-major order, no duplicates
+     */
+    vector<coordinate> border_cells() const {
+        vector<coordinate> ret;
+        const int          last = static_cast<int>(size) - 1;
+        for (int x = 0; x <= last; ++x) {
+            for (int y = 0; y <= last; ++y) {
+                if (y == 1 && x != 0 && x != last) {
+                    y = last; /* skip the inside of the row */
+                }
+                if (cells[to_index({ x, y })]) {
+                    ret.emplace_back(x, y);
+                }
+            }
+        }
+        return ret;
+    }
+
+    /**
+     * @brief shortest route from `entry` to the nearest of `exits`, by one
+     *      `bfs` that stops at the first exit reached
+     *
+     * @note costs at most one search, however many exits there are
+     * @return true if some exit is reachable, the route is left in
+     *      `ws.get_route()` and ends at that exit
+     */
+    bool nearest_route(
+        Workspace&                  ws,
+        const coordinate&           entry,
+        std::span<const coordinate> exits
+    ) const {
+        const index_type source = to_index(entry);
+
+        // exits are pre-visited with no parent, that's how they're told apart
+        ws.begin(cells.size());
+        bool if_any = false;
+        for (const auto& cord : exits) {
+            const index_type target = to_index(cord);
+            if (target == source) {
+                ws.trace(source, source);
+                return true;
+            }
+            if (components.connected(source, target)) {
+                ws.visit(target, Workspace::npos);
+                if_any = true;
+            }
+        }
+        if (!if_any) {
+            return false;
+        }
+        ws.visit(source, source);
+        ws.push(source);
+
+        index_type reached = Workspace::npos;
+        while (!ws.frontier_empty() && reached == Workspace::npos) {
+            index_type from = ws.pop();
+            for_each_adj(from, [&](index_type to) {
+                if (reached != Workspace::npos) {
+                    return;
+                }
+                if (!ws.visited(to)) {
+                    ws.visit(to, from);
+                    ws.push(to);
+                    return;
+                }
+                if (ws.parent(to) == Workspace::npos) {
+                    // cells are found in order of distance, the first is nearest
+                    ws.visit(to, from);
+                    reached = to;
+                }
+            });
+        }
+        ws.trace(source, reached);
+        return true;
+    }
+
+    /**
+     * @brief distance field towards the nearest of `exits`, for answering
+     *      many entries against the same exits (see `ExitField`)
+     *
+     */
+    ExitField exit_field(std::span<const coordinate> exits) const {
+        assert_cells_init();
+        vector<index_type> targets;
+        targets.reserve(exits.size());
+        for (const auto& cord : exits) {
+            targets.push_back(to_index(cord));
+        }
+        return ExitField::build(cells, size, targets);
+    }
+
+    /**
+     * @brief contract corridors into a junction graph (current entry and
+     *      exit are kept as nodes)
+     *
+     * @note one O(cells) pass, meant to be run once when the maze is loaded
+     */
+    void contract_corridors() {
+        assert_cells_init();
+        corridors = CorridorGraph::build(
+            cells,
+            size,
+            { to_index(entry), to_index(exit) }
+        );
+    }
+
+    /**
+     * @brief get the contracted graph (empty if never contracted)
+     *
+     * @return const CorridorGraph&
+     */
+    const CorridorGraph& get_corridors() const {
+        return corridors;
+    }
+
+    /**
+     * @brief shortest route searched on the corridor graph
+     *
+     * @note falls back to `bfs_route` if the graph is missing,
+     *      or if `entry`/`exit` are not nodes of it
+     * @return true if a route exists
+     */
+    bool corridor_route(
+        Workspace&        ws,
+        const coordinate& entry,
+        const coordinate& exit
+    ) const {
+        const index_type source = to_index(entry);
+        const index_type target = to_index(exit);
+        if (!components.connected(source, target)) {
+            ws.begin(cells.size());
+            return false;
+        }
+        if (!corridors.contains(source) || !corridors.contains(target)) {
+            return bfs_route(ws, entry, exit);
+        }
+        return corridors.route(ws, cells.size(), source, target);
+    }
+
+    /**
+     * @brief map the route index of the current `exit` at `path`
+     *
+     * @note the index is (re)built first if it's missing or stale,
+     *      otherwise loading costs one checksum pass over the cells
+     * @param path
+     */
+    void load_route_index(const std::filesystem::path& path) {
+        assert_cells_init();
+        assert_exit_init();
+        route_index = RouteIndex::open_or_build(path, cells, size, to_index(exit));
+    }
+
+    /**
+     * @brief route read from the index, no search at all
+     *
+     * @note falls back to `bfs_route` if no index is loaded for `exit`
+     * @return true if a route exists
+     */
+    bool indexed_route(
+        Workspace&        ws,
+        const coordinate& entry,
+        const coordinate& exit
+    ) const {
+        if (route_index.empty() || route_index.get_target() != to_index(exit)) {
+            return bfs_route(ws, entry, exit);
+        }
+        return route_index.route(ws, to_index(entry));
+    }
+
+    /**
+     * @brief shortest route by IDA*, within `config.memory_budget` bytes
+     *
+     * @param route  receives flat row-major indices, entry first
+     * @note no per-cell table, memory grows with the route, not the maze.
+     *      `stopped` when the budget or the expansion cap is reached
+     */
+    BoundedStats bounded_route(
+        vector<index_type>&  route,
+        const coordinate&    entry,
+        const coordinate&    exit,
+        const BoundedConfig& config = {}
+    ) const {
+        const index_type source = to_index(entry);
+        const index_type target = to_index(exit);
+        if (!components.connected(source, target)) {
+            route.clear();
+            return {};
+        }
+        return IdaStar::route(cells, size, source, target, config, route);
+    }
+
+    /**
+     * @brief outcome of the last `bounded_solution`
+     *
+     * @return const BoundedStats&
+     */
+    const BoundedStats& get_bounded_stats() const {
+        return bounded_stats;
+    }
+
+    /**
+     * @brief route of the last `*_solution`, from entry to exit
+     *
+     * @note empty if it found none, valid until the next solve on this maze
+     * @return std::span<const index_type>
+     */
+    std::span<const index_type> get_solution_route() const {
+        if (!if_have_solution) {
+            return {};
+        }
+        return if_bounded_solution ? std::span<const index_type>(bounded_cells) : workspace.get_route();
+    }
 
     /**
      * @brief solve the maze by `bfs` algorithm
@@ -419,10 +1089,7 @@ public:
         assert_entry_init();
         assert_exit_init();
         bfs_algo();
-        if (!if_have_solution) {
-            return { false, data, entry, exit };
-        }
-        return { true, export_solved_maze(), entry, exit };
+        return export_solution(false);
     }
 
     /**
@@ -434,11 +1101,53 @@ public:
         assert_entry_init();
         assert_exit_init();
         a_star_algo();
-        if (!if_have_solution) {
-            return { false, data, entry, exit };
+        return export_solution(false);
+    }
+
+    /**
+     * @brief solve the maze on the contracted corridor graph
+     *
+     * @return tuple<bool, matrix<int>, coordinate, coordinate>
+     */
+    result_tuple corridor_solution() {
+        assert_entry_init();
+        assert_exit_init();
+        corridor_algo();
+        return export_solution(false);
+    }
+
+    /**
+     * @brief solve the maze by IDA* within a memory budget
+     *
+     * @note falls back to `bfs_solution` when the search is `stopped`, see
+     *      `get_bounded_stats`. The search gives up within
+     *      `config.max_expanded` expansions (8 per cell by default), so a
+     *      fallback costs at most that much on top of the bfs, and the bfs
+     *      takes its O(cells) memory after the search has freed its own
+     * @return tuple<bool, matrix<int>, coordinate, coordinate>
+     */
+    result_tuple bounded_solution(const BoundedConfig& config = {}) {
+        assert_entry_init();
+        assert_exit_init();
+        bounded_stats = bounded_route(bounded_cells, entry, exit, config);
+        if (bounded_stats.status == search_status::stopped) {
+            return bfs_solution();
         }
-        return { true, export_solved_maze(), entry, exit };
+        if_have_solution = bounded_stats.status == search_status::found;
+        return export_solution(true);
+    }
+
+    /**
+     * @brief solve the maze by reading the persisted route index
+     *
+     * @return tuple<bool, matrix<int>, coordinate, coordinate>
+     */
+    result_tuple indexed_solution() {
+        assert_entry_init();
+        assert_exit_init();
+        indexed_algo();
+        return export_solution(false);
     }
 };
 
-} // namespace Utility
\ No newline at end of file
+} // namespace Utility
@@ -0,0 +1,518 @@
+/**
+ * @file MazeAnalytics.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Structural metrics of a maze (diameter, dead ends, corridors...)
+ * @version 0.1
+ * @date 2023-01-21
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "Heading.hpp"
+#include "Maze.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Utility {
+
+using std::vector;
+
+/**
+ * @brief limits of `MazeAnalytics::analyze`
+ *
+ */
+struct AnalyticsConfig {
+    /// @brief 0 for one per hardware thread
+    size_t threads = 0;
+
+    /// @brief most bfs sweeps spent on the diameter of a maze with loops,
+    ///     past that only bounds are reported
+    size_t max_sweeps = 32;
+};
+
+/**
+ * @brief metrics of one maze, see `MazeAnalytics`
+ *
+ */
+struct MazeMetrics {
+    size_t size       = 0;
+    size_t open_cells = 0;
+
+    /// @brief open cells in the component of the entry
+    size_t reachable_cells = 0;
+
+    size_t components = 0;
+
+    /// @brief open cells with one open neighbour
+    size_t dead_ends = 0;
+
+    /// @brief open cells with three or four open neighbours
+    size_t junctions = 0;
+
+    /// @brief runs of two-neighbour cells between dead ends / junctions
+    size_t corridors = 0;
+
+    /// @brief `corridor_lengths[k]`: corridors of [2^k, 2^(k+1)) steps
+    vector<size_t> corridor_lengths = {};
+
+    /// @brief longest shortest route in the component of the entry
+    ///     (a lower bound unless `diameter_exact`)
+    size_t diameter       = 0;
+    size_t diameter_upper = 0;
+    bool   diameter_exact = false;
+
+    /// @brief "double_sweep" (the component of the entry is a tree) or "ifub"
+    std::string diameter_method = {};
+
+    /// @brief bfs sweeps run for the diameter
+    size_t sweeps = 0;
+
+    double seconds = 0;
+
+    /**
+     * @brief one JSON object, keys in the order of the fields
+     *
+     */
+    std::string to_json() const {
+        std::ostringstream out;
+        out << "{"
+            << "\"size\": " << size
+            << ", \"open_cells\": " << open_cells
+            << ", \"reachable_cells\": " << reachable_cells
+            << ", \"components\": " << components
+            << ", \"dead_ends\": " << dead_ends
+            << ", \"junctions\": " << junctions
+            << ", \"corridors\": " << corridors
+            << ", \"corridor_lengths\": [";
+        for (size_t k = 0; k < corridor_lengths.size(); ++k) {
+            out << (k == 0 ? "" : ", ") << corridor_lengths[k];
+        }
+        out << "]"
+            << ", \"diameter\": " << diameter
+            << ", \"diameter_upper\": " << diameter_upper
+            << ", \"diameter_exact\": " << (diameter_exact ? "true" : "false")
+            << ", \"diameter_method\": \"" << diameter_method << "\""
+            << ", \"sweeps\": " << sweeps
+            << ", \"seconds\": " << seconds
+            << "}";
+        return out.str();
+    }
+};
+
+/**
+ * @brief one pass of structural metrics over a grid of open / closed cells
+ *
+ * Cell counts and corridors come from a single scan split into row stripes,
+ *  one thread each (a corridor is walked from the end with the smaller
+ *  index, so it's counted once whatever stripe it crosses). The first sweep
+ *  from the entry counts its component, and tells a tree (as many open
+ *  neighbours as 2 * (cells - 1)), whose diameter is exact with one more
+ *  sweep. On other mazes it's iFUB: sweep from a central cell, then from its
+ *  farthest cells level by level, several sweeps at once, until the bounds
+ *  meet or the sweep budget is spent. Sweeps keep a visited bitset and two
+ *  frontiers, not distances, so a grid needs about 1/8 byte per cell beside
+ *  its own cells.
+ *
+ * @note loops made only of two-neighbour cells are not corridors
+ */
+class MazeAnalytics {
+public:
+    using index_type = Maze::index_type;
+
+private:
+    /// @brief the only bit of a cell read, others may carry marks (see `GridFile`)
+    static constexpr uint8_t open_bit = 0b1;
+
+    std::span<const uint8_t> cells;
+    size_t                   size;
+    size_t                   threads;
+
+    /// @brief outcome of one bfs sweep
+    struct Sweep {
+        index_type farthest     = 0;
+        size_t     eccentricity = 0;
+
+        /// @brief cells of the component, and open neighbours met (twice its edges)
+        size_t cells   = 1;
+        size_t degrees = 0;
+    };
+
+    /// @brief scratch of one sweeping thread
+    struct Sweeper {
+        vector<uint64_t>   visited  = {};
+        vector<index_type> frontier = {};
+        vector<index_type> next     = {};
+    };
+
+    MazeAnalytics(std::span<const uint8_t> cells, size_t size, size_t threads)
+        : cells(cells)
+        , size(size)
+        , threads(threads) { }
+
+    template <class Fn>
+    void for_each_stripe(Fn&& fn) const {
+        vector<std::thread> pool;
+        pool.reserve(threads);
+        for (size_t t = 0; t < threads; ++t) {
+            pool.emplace_back(fn, size * t / threads, size * (t + 1) / threads);
+        }
+        for (auto& thread : pool) {
+            thread.join();
+        }
+    }
+
+    bool if_open(size_t idx) const {
+        return cells[idx] & open_bit;
+    }
+    bool if_open(index_type idx, heading dir) const {
+        const size_t x = idx / size;
+        const size_t y = idx % size;
+        switch (dir) {
+        case heading::north:
+            return x > 0 && if_open(idx - size);
+        case heading::south:
+            return x + 1 < size && if_open(idx + size);
+        case heading::west:
+            return y > 0 && if_open(idx - 1);
+        default:
+            return y + 1 < size && if_open(idx + 1);
+        }
+    }
+    int degree_of(index_type idx) const {
+        return if_open(idx, heading::north) + if_open(idx, heading::south)
+             + if_open(idx, heading::west) + if_open(idx, heading::east);
+    }
+
+    /// @brief `RowMajorLayout::for_each_adj`, reading the open bit only
+    template <class Fn>
+    void for_each_adj(index_type idx, Fn&& fn) const {
+        const size_t x = idx / size;
+        const size_t y = idx % size;
+        if (x > 0 && if_open(idx - size)) {
+            fn(static_cast<index_type>(idx - size));
+        }
+        if (x + 1 < size && if_open(idx + size)) {
+            fn(static_cast<index_type>(idx + size));
+        }
+        if (y > 0 && if_open(idx - 1)) {
+            fn(static_cast<index_type>(idx - 1));
+        }
+        if (y + 1 < size && if_open(idx + 1)) {
+            fn(static_cast<index_type>(idx + 1));
+        }
+    }
+
+    /**
+     * @brief bfs over the component of `source`
+     *
+     * @param on_visit  `fn(cell, parent, level)`, for every cell in bfs order
+     */
+    template <class Fn>
+    Sweep sweep(Sweeper& scratch, index_type source, Fn&& on_visit) const {
+        auto& visited = scratch.visited;
+        visited.assign((cells.size() + 63) / 64, 0);
+        auto if_first = [&](index_type idx) {
+            const uint64_t bit = uint64_t(1) << (idx % 64);
+            if (visited[idx / 64] & bit) {
+                return false;
+            }
+            visited[idx / 64] |= bit;
+            return true;
+        };
+
+        Sweep ret { source, 0 };
+        scratch.frontier.assign(1, source);
+        if_first(source);
+        on_visit(source, source, size_t(0));
+        for (size_t level = 1;; ++level) {
+            scratch.next.clear();
+            for (index_type from : scratch.frontier) {
+                for_each_adj(from, [&](index_type to) {
+                    ++ret.degrees;
+                    if (if_first(to)) {
+                        ++ret.cells;
+                        scratch.next.push_back(to);
+                        on_visit(to, from, level);
+                    }
+                });
+            }
+            if (scratch.next.empty()) {
+                return ret;
+            }
+            ret.farthest     = scratch.next.front();
+            ret.eccentricity = level;
+            std::swap(scratch.frontier, scratch.next);
+        }
+    }
+    Sweep sweep(Sweeper& scratch, index_type source) const {
+        return sweep(scratch, source, [](index_type, index_type, size_t) { });
+    }
+
+    /// @brief cell counts and corridors, one thread per stripe of rows
+    void scan(MazeMetrics& metrics) const {
+        std::mutex merge;
+        for_each_stripe([&](size_t row_begin, size_t row_end) {
+            MazeMetrics local;
+            local.corridor_lengths.assign(33, 0);
+            for (size_t idx = row_begin * size; idx < row_end * size; ++idx) {
+                if (!if_open(idx)) {
+                    continue;
+                }
+                const auto cell   = static_cast<index_type>(idx);
+                const int  degree = degree_of(cell);
+                ++local.open_cells;
+                local.dead_ends += degree == 1;
+                local.junctions += degree >= 3;
+                if (degree == 2 || degree == 0) {
+                    continue;
+                }
+                for (heading dir : { heading::north, heading::south, heading::west, heading::east }) {
+                    if (!if_open(cell, dir)) {
+                        continue;
+                    }
+                    index_type curr   = step(cell, dir, size);
+                    heading    last   = dir;
+                    size_t     length = 1;
+                    while (degree_of(curr) == 2) {
+                        for (heading next : { heading::north, heading::south, heading::west, heading::east }) {
+                            if (next != reverse(last) && if_open(curr, next)) {
+                                last = next;
+                                break;
+                            }
+                        }
+                        curr = step(curr, last, size);
+                        ++length;
+                    }
+                    // walked from both ends: keep the one from the smaller end
+                    if (cell < curr || (cell == curr && dir < reverse(last))) {
+                        ++local.corridors;
+                        ++local.corridor_lengths[std::bit_width(length) - 1];
+                    }
+                }
+            }
+
+            std::lock_guard lock { merge };
+            metrics.open_cells += local.open_cells;
+            metrics.dead_ends += local.dead_ends;
+            metrics.junctions += local.junctions;
+            metrics.corridors += local.corridors;
+            metrics.corridor_lengths.resize(local.corridor_lengths.size(), 0);
+            for (size_t k = 0; k < local.corridor_lengths.size(); ++k) {
+                metrics.corridor_lengths[k] += local.corridor_lengths[k];
+            }
+        });
+        while (!metrics.corridor_lengths.empty() && metrics.corridor_lengths.back() == 0) {
+            metrics.corridor_lengths.pop_back();
+        }
+    }
+
+    /// @brief flood fill the components not `visited` yet, a stack each
+    size_t count_components(vector<uint64_t> visited) const {
+        vector<index_type> stack;
+        size_t             ret = 0;
+        for (size_t idx = 0; idx < cells.size(); ++idx) {
+            if (!if_open(idx) || (visited[idx / 64] >> (idx % 64) & 1)) {
+                continue;
+            }
+            ++ret;
+            visited[idx / 64] |= uint64_t(1) << (idx % 64);
+            stack.assign(1, static_cast<index_type>(idx));
+            while (!stack.empty()) {
+                const index_type from = stack.back();
+                stack.pop_back();
+                for_each_adj(from, [&](index_type to) {
+                    const uint64_t bit = uint64_t(1) << (to % 64);
+                    if (!(visited[to / 64] & bit)) {
+                        visited[to / 64] |= bit;
+                        stack.push_back(to);
+                    }
+                });
+            }
+        }
+        return ret;
+    }
+
+    /// @brief a tree has its diameter between the ends of a double sweep
+    void tree_diameter(MazeMetrics& metrics, const Sweep& first) const {
+        Sweeper scratch;
+        Sweep   last = sweep(scratch, first.farthest);
+
+        metrics.diameter        = last.eccentricity;
+        metrics.diameter_upper  = last.eccentricity;
+        metrics.diameter_exact  = true;
+        metrics.diameter_method = "double_sweep";
+        metrics.sweeps          = 2;
+    }
+
+    /// @brief iFUB from the middle of a double-sweep route
+    void ifub_diameter(MazeMetrics& metrics, const Sweep& first, size_t max_sweeps) const {
+        Sweeper scratch;
+
+        // 1. double sweep: a lower bound, and a long route to find a center on
+        index_type start = first.farthest;
+        vector<uint8_t> parents((cells.size() + 3) / 4, 0);
+        Sweep far = sweep(scratch, start, [&](index_type idx, index_type from, size_t) {
+            const heading dir = from + size == idx ? heading::north
+                              : from == idx + size ? heading::south
+                              : from + 1 == idx    ? heading::west
+                                                   : heading::east;
+            parents[idx / 4] |= static_cast<uint8_t>(static_cast<uint8_t>(dir) << (idx % 4 * 2));
+        });
+        size_t lower  = far.eccentricity;
+        size_t sweeps = 2;
+
+        index_type center = far.farthest;
+        for (size_t k = 0; k < far.eccentricity / 2; ++k) {
+            center = step(center, static_cast<heading>((parents[center / 4] >> (center % 4 * 2)) & 0b11), size);
+        }
+        parents = {};
+
+        // 2. levels of the center, deepest first
+        vector<index_type> order;
+        vector<size_t>     level_begin = { 0 };
+        Sweep              middle      = sweep(scratch, center, [&](index_type idx, index_type, size_t level) {
+            if (level == level_begin.size()) {
+                level_begin.push_back(order.size());
+            }
+            order.push_back(idx);
+        });
+        level_begin.push_back(order.size());
+        ++sweeps;
+        lower        = std::max(lower, middle.eccentricity);
+        size_t upper = 2 * middle.eccentricity;
+
+        // 3. eccentricities of each fringe, in parallel, until bounds meet
+        for (size_t level = middle.eccentricity; level > 0 && lower < upper; --level) {
+            if (sweeps >= max_sweeps) {
+                break;
+            }
+            const size_t           begin = level_begin[level];
+            const size_t           end   = level_begin[level + 1];
+            std::atomic<size_t>    next  = begin;
+            std::atomic<size_t>    spent = sweeps;
+            std::atomic<size_t>    found = 0;
+            std::atomic<bool>      cut   = false;
+            vector<std::thread>    pool;
+            const size_t           count = std::min(threads, end - begin);
+            for (size_t t = 0; t < count; ++t) {
+                pool.emplace_back([&]() {
+                    Sweeper mine;
+                    for (size_t i = next++; i < end; i = next++) {
+                        if (spent++ >= max_sweeps) {
+                            cut = true;
+                            return;
+                        }
+                        size_t eccentricity = sweep(mine, order[i]).eccentricity;
+                        size_t seen         = found.load();
+                        while (eccentricity > seen && !found.compare_exchange_weak(seen, eccentricity)) { }
+                    }
+                });
+            }
+            for (auto& thread : pool) {
+                thread.join();
+            }
+            sweeps = std::min(spent.load(), max_sweeps);
+            lower  = std::max(lower, found.load());
+            if (cut) {
+                break; /* level not finished, `upper` stays at 2 * level */
+            }
+            if (lower > 2 * (level - 1)) {
+                upper = lower;
+                break;
+            }
+            upper = std::max(lower, 2 * (level - 1));
+        }
+
+        metrics.diameter        = lower;
+        metrics.diameter_upper  = upper;
+        metrics.diameter_exact  = lower == upper;
+        metrics.diameter_method = "ifub";
+        metrics.sweeps          = sweeps;
+    }
+
+public:
+    /**
+     * @brief compute every metric of a grid (the component of `entry` for
+     *      reachability and diameter)
+     *
+     * @param cells  flat row-major, open if bit 0 is set (as in a mapped
+     *      `GridFile`), read in place
+     * @return MazeMetrics
+     * @throw std::invalid_argument if `cells` is not `size * size`, or
+     *      `entry` is a wall
+     * @throw std::out_of_range if `entry` is out of the grid
+     */
+    static MazeMetrics analyze(
+        std::span<const uint8_t> cells,
+        size_t                   size,
+        const coordinate&        entry,
+        const AnalyticsConfig&   config = {}
+    ) {
+        using clock = std::chrono::steady_clock;
+        const auto start = clock::now();
+
+        if (cells.size() != size * size) {
+            throw std::invalid_argument("Cells must be a square grid!");
+        }
+        if (entry.first < 0 || static_cast<size_t>(entry.first) >= size
+            || entry.second < 0 || static_cast<size_t>(entry.second) >= size) {
+            throw std::out_of_range("Coordinate out of range!");
+        }
+        const auto source = static_cast<index_type>(static_cast<size_t>(entry.first) * size + static_cast<size_t>(entry.second));
+        if (!(cells[source] & open_bit)) {
+            throw std::invalid_argument("Coordinate is not `connected`!");
+        }
+
+        size_t threads = config.threads;
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        threads = std::clamp<size_t>(threads, 1, std::max<size_t>(1, size));
+
+        MazeAnalytics analytics { cells, size, threads };
+        MazeMetrics   metrics;
+        metrics.size = size;
+        analytics.scan(metrics);
+
+        // the first sweep visits the component of the entry, the others are
+        // counted around it
+        Sweeper     scratch;
+        const Sweep first       = analytics.sweep(scratch, source);
+        metrics.reachable_cells = first.cells;
+        metrics.components      = 1 + analytics.count_components(std::move(scratch.visited));
+        if (first.degrees == 2 * (first.cells - 1)) {
+            analytics.tree_diameter(metrics, first);
+        } else {
+            analytics.ifub_diameter(metrics, first, std::max<size_t>(config.max_sweeps, 3));
+        }
+
+        metrics.seconds = std::chrono::duration<double>(clock::now() - start).count();
+        return metrics;
+    }
+
+    /**
+     * @brief compute every metric of `maze`, see above
+     *
+     * @return MazeMetrics
+     */
+    static MazeMetrics analyze(const Maze& maze, const AnalyticsConfig& config = {}) {
+        return analyze(maze.get_cells(), maze.get_size(), maze.get_entry(), config);
+    }
+};
+
+} // namespace Utility
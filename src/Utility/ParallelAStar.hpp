@@ -0,0 +1,311 @@
+/**
+ * @file ParallelAStar.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Hash-distributed a* (HDA*): one open list per thread, nodes sent to their owner
+ * @version 0.1
+ * @date 2023-01-28
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "Heading.hpp"
+#include "Maze.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Utility {
+
+using std::vector;
+
+/**
+ * @brief outcome of `hda_star`
+ *
+ */
+struct ParallelAStarResult {
+    bool if_found = false;
+
+    /// @brief flat row-major indices from entry to exit (empty if not found)
+    vector<Maze::index_type> route = {};
+
+    /// @brief expansions over all threads (re-expansions included)
+    uint64_t expanded = 0;
+
+    /// @brief nodes sent to another thread
+    uint64_t messages = 0;
+
+    size_t threads = 0;
+};
+
+/**
+ * @brief shortest route by hash-distributed a* on `threads` threads
+ *
+ * Every cell has an owner thread, a hash of the 8 x 8 block it lies in, so
+ *  most steps stay inside one thread (blocks, not cells, as in abstraction
+ *  HDA*). A thread keeps the open list of its own cells only, and is the only
+ *  one to read or write their g and parent. Expanding a cell relaxes the
+ *  neighbours it owns in place, and batches the others to their owners'
+ *  inboxes: lock-free multi-producer, single-consumer stacks, drained whole.
+ *
+ * With a core per thread, threads never wait for one another. With more
+ *  threads than cores, they only expand the lowest f layer open anywhere (a
+ *  thread waiting for a core delays its messages, running ahead of it is
+ *  costly).
+ *
+ * The first route to the exit sets the incumbent cost C; threads go on until
+ *  no open node anywhere has f < C, so the route is optimal (manhattan is
+ *  consistent, and a cell reached cheaper later is simply reopened).
+ *
+ * Termination: `work` counts active threads plus messages in flight. A
+ *  sender counts a message before sending it, an idle receiver counts itself
+ *  active again before uncounting what it received, and a thread only goes
+ *  idle with an empty inbox, nothing to send and no node below C. So `work`
+ *  reaches 0 exactly once, when no thread can ever get work again.
+ *
+ * @param threads  0 for one per hardware thread
+ * @attention `maze` must not be `set`/`reset` during the search
+ */
+inline ParallelAStarResult hda_star(
+    const Maze&       maze,
+    const coordinate& entry,
+    const coordinate& exit,
+    size_t            threads = 0
+) {
+    using index_type = Maze::index_type;
+
+    struct Message {
+        index_type idx    = 0;
+        index_type parent = 0;
+        uint32_t   g      = 0;
+    };
+    struct Batch {
+        Batch*          next     = nullptr;
+        vector<Message> messages = {};
+    };
+    /* MPSC: producers push a batch, the owner takes the whole stack at once */
+    struct alignas(64) Inbox {
+        std::atomic<Batch*> head = nullptr;
+
+        void push(Batch* batch) {
+            batch->next = head.load(std::memory_order_relaxed);
+            while (!head.compare_exchange_weak(batch->next, batch, std::memory_order_release, std::memory_order_relaxed)) { }
+        }
+        Batch* take_all() {
+            return head.load(std::memory_order_relaxed) == nullptr ? nullptr : head.exchange(nullptr, std::memory_order_acquire);
+        }
+        ~Inbox() {
+            for (Batch* batch = head.load(); batch != nullptr;) {
+                delete std::exchange(batch, batch->next);
+            }
+        }
+    };
+
+    ParallelAStarResult ret;
+    const size_t        cores = std::max(1u, std::thread::hardware_concurrency());
+    if (threads == 0) {
+        threads = cores;
+    }
+    ret.threads = threads;
+
+    const index_type source = maze.to_index(entry);
+    const index_type target = maze.to_index(exit);
+    if (!maze.get_components().connected(source, target)) {
+        return ret;
+    }
+
+    const size_t                     size  = maze.get_size();
+    const std::span<const uint8_t>   cells = maze.get_cells();
+    const std::unique_ptr<uint32_t[]> g_of = std::make_unique_for_overwrite<uint32_t[]>(cells.size());
+    const std::unique_ptr<index_type[]> parent_of
+        = std::make_unique_for_overwrite<index_type[]>(cells.size());
+    std::fill_n(g_of.get(), cells.size(), UINT32_MAX);
+
+    auto owner_of = [&](index_type idx) -> size_t {
+        uint64_t block = (static_cast<uint64_t>(idx / size >> 3) << 32) | (idx % size >> 3);
+        block          = (block ^ (block >> 30)) * 0xBF58476D1CE4E5B9;
+        block          = (block ^ (block >> 27)) * 0x94D049BB133111EB;
+        return (block ^ (block >> 31)) % threads;
+    };
+    auto h_cost = [&](index_type idx) -> uint32_t {
+        const int64_t x = idx / size;
+        const int64_t y = idx % size;
+        return static_cast<uint32_t>(std::abs(x - exit.first) + std::abs(y - exit.second));
+    };
+
+    const auto                 inboxes   = std::make_unique<Inbox[]>(threads);
+    std::atomic<uint32_t>      incumbent = UINT32_MAX;
+    std::atomic<int64_t>       work      = static_cast<int64_t>(threads);
+    std::atomic<uint64_t>      expanded  = 0;
+    std::atomic<uint64_t>      messages  = 0;
+
+    // lowest f of each open list, UINT32_MAX when empty (as all are before the
+    // start); kept only with more threads than cores, see the slices below
+    const bool if_gated = threads > cores;
+    const auto lowest   = std::make_unique<std::atomic<uint32_t>[]>(threads);
+    for (size_t me = 0; me < threads; ++me) {
+        lowest[me].store(UINT32_MAX, std::memory_order_relaxed);
+    }
+
+    auto search = [&](size_t me) {
+        // { f, UINT32_MAX - g (deeper first) } and the cell, smallest on top
+        vector<std::pair<uint64_t, index_type>> heap;
+        vector<vector<Message>>                 outgoing(threads);
+        uint64_t                                own_expanded = 0;
+        uint64_t                                own_messages = 0;
+        bool                                    active       = true;
+
+        auto relax = [&](index_type idx, index_type parent, uint32_t g) {
+            if (g >= g_of[idx]) {
+                return;
+            }
+            g_of[idx]      = g;
+            parent_of[idx] = parent;
+            if (idx == target) {
+                uint32_t best = incumbent.load(std::memory_order_relaxed);
+                while (g < best && !incumbent.compare_exchange_weak(best, g, std::memory_order_relaxed)) { }
+                return;
+            }
+            heap.emplace_back(static_cast<uint64_t>(g + h_cost(idx)) << 32 | (UINT32_MAX - g), idx);
+            std::push_heap(heap.begin(), heap.end(), std::greater<> {});
+        };
+        if (owner_of(source) == me) {
+            relax(source, source, 0);
+        }
+
+        while (true) {
+            if (Batch* batch = inboxes[me].take_all(); batch != nullptr) {
+                if (!active) {
+                    work.fetch_add(1);
+                    active = true;
+                }
+                int64_t received = 0;
+                while (batch != nullptr) {
+                    for (const auto& message : batch->messages) {
+                        relax(message.idx, message.parent, message.g);
+                    }
+                    received += static_cast<int64_t>(batch->messages.size());
+                    delete std::exchange(batch, batch->next);
+                }
+                work.fetch_sub(received);
+            }
+
+            // a slice of expansions between two looks at the inbox. With more
+            // threads than cores, only inside the lowest f layer open anywhere:
+            // while a thread waits for its turn on a core, its messages wait
+            // too, and one alone on a core would run deep into f layers with g
+            // not yet final, re-expanding all it reached (several times the
+            // cells a* expands). With a core each, threads never wait for others
+            const uint32_t bound   = incumbent.load(std::memory_order_relaxed);
+            uint32_t       horizon = UINT32_MAX;
+            if (if_gated) {
+                lowest[me].store(heap.empty() ? UINT32_MAX : static_cast<uint32_t>(heap.front().first >> 32), std::memory_order_relaxed);
+                for (size_t other = 0; other < threads; ++other) {
+                    horizon = std::min(horizon, lowest[other].load(std::memory_order_relaxed));
+                }
+            }
+            bool if_ahead = false;
+            for (int slice = 0; slice < 64 && !heap.empty(); ++slice) {
+                const auto f = static_cast<uint32_t>(heap.front().first >> 32);
+                if (f >= bound) {
+                    heap.clear(); /* nothing left here can beat the incumbent */
+                    break;
+                }
+                if (f > horizon) {
+                    if_ahead = true;
+                    break;
+                }
+                std::pop_heap(heap.begin(), heap.end(), std::greater<> {});
+                auto [key, idx] = heap.back();
+                heap.pop_back();
+                const uint32_t g = UINT32_MAX - static_cast<uint32_t>(key);
+                if (g != g_of[idx]) {
+                    continue; /* stale, reached cheaper since */
+                }
+                ++own_expanded;
+                const size_t x = idx / size;
+                const size_t y = idx % size;
+                for (heading dir : { heading::north, heading::south, heading::west, heading::east }) {
+                    if ((dir == heading::north && x == 0) || (dir == heading::south && x + 1 == size)
+                        || (dir == heading::west && y == 0) || (dir == heading::east && y + 1 == size)) {
+                        continue;
+                    }
+                    const index_type to = step(idx, dir, size);
+                    if (!cells[to]) {
+                        continue;
+                    }
+                    if (const size_t owner = owner_of(to); owner == me) {
+                        relax(to, idx, g + 1);
+                    } else {
+                        outgoing[owner].push_back({ to, idx, g + 1 });
+                    }
+                }
+            }
+
+            for (size_t owner = 0; owner < threads; ++owner) {
+                if (outgoing[owner].empty()) {
+                    continue;
+                }
+                own_messages += outgoing[owner].size();
+                work.fetch_add(static_cast<int64_t>(outgoing[owner].size()));
+                inboxes[owner].push(new Batch { nullptr, std::move(outgoing[owner]) });
+                outgoing[owner].clear();
+            }
+
+            if (!heap.empty() && (heap.front().first >> 32) < incumbent.load(std::memory_order_relaxed)) {
+                if (if_ahead) {
+                    std::this_thread::yield();
+                }
+                continue;
+            }
+            heap.clear();
+            if (if_gated) {
+                lowest[me].store(UINT32_MAX, std::memory_order_relaxed);
+            }
+            if (active) {
+                active = false;
+                work.fetch_sub(1);
+            }
+            if (work.load() == 0) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+        expanded += own_expanded;
+        messages += own_messages;
+    };
+
+    vector<std::thread> workers;
+    workers.reserve(threads);
+    for (size_t me = 0; me < threads; ++me) {
+        workers.emplace_back(search, me);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    ret.expanded = expanded;
+    ret.messages = messages;
+    if (incumbent.load() == UINT32_MAX) {
+        return ret;
+    }
+    ret.if_found = true;
+    for (index_type curr = target; curr != source; curr = parent_of[curr]) {
+        ret.route.push_back(curr);
+    }
+    ret.route.push_back(source);
+    std::reverse(ret.route.begin(), ret.route.end());
+    return ret;
+}
+
+} // namespace Utility
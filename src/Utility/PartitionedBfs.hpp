@@ -0,0 +1,507 @@
+/**
+ * @file PartitionedBfs.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Level-synchronous bfs over horizontal stripes owned by worker processes
+ * @version 0.1
+ * @date 2023-01-27
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "GridFile.hpp"
+#include "Heading.hpp"
+#include "RouteService.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#if MAZE_HAS_UNIX_SOCKET
+#include <csignal>
+#include <sys/wait.h>
+#endif
+
+namespace Utility {
+
+using std::vector;
+
+/**
+ * @brief outcome of a `PartitionedBfs::route`
+ *
+ */
+struct PartitionedResult {
+    bool found = false;
+
+    /// @brief flat row-major indices, entry first
+    vector<uint32_t> route = {};
+
+    /// @brief bfs levels run (a barrier each)
+    size_t rounds = 0;
+
+    /// @brief frontier cells sent across stripe borders, all rounds
+    uint64_t exchanged = 0;
+
+    /// @brief worker processes actually used
+    size_t workers = 0;
+};
+
+#if MAZE_HAS_UNIX_SOCKET
+
+/**
+ * @brief shortest route by `workers` processes, each owning a stripe of rows
+ *
+ * Worker `i` owns rows [size * i / workers, size * (i + 1) / workers) and keeps
+ *  the visited bits and 2-bit parent headings of that stripe only. Each round
+ *  is one bfs level:
+ *
+ *  - every worker expands its frontier inside its stripe, and sends the cells
+ *    it reaches across a border to the neighbour owning them (the parent of
+ *    such a cell is implied: the row just above or below);
+ *  - it merges what its neighbours sent into the next frontier, and reports
+ *    the size of that frontier, and whether it holds the exit, to the
+ *    coordinator, which tells every worker to go on or stop.
+ *
+ * Once the exit is reached, the coordinator stitches the route: the owner of
+ *  the exit walks the parents back to its border and hands the first cell
+ *  beyond it to the next owner, and so on up to the entry.
+ *
+ * Workers are `fork`ed and talk over `socketpair`s: stripe neighbours
+ *  directly, everybody with the coordinator. Only file descriptors cross the
+ *  fork, so the same protocol runs over any stream socket. Cells are read
+ *  straight from the inherited span; with a mapped `GridFile` each worker
+ *  only faults in the pages of its stripe (plus one row on each side).
+ *
+ * Every level costs a barrier across all processes, so this pays off on
+ *  wide frontiers (braided or open grids too big for one process), not on
+ *  the long single corridors of perfect mazes.
+ *
+ * @note a worker is `fork`ed from a process that may run other threads, so
+ *      only the forking thread lives on in it, and any lock another thread
+ *      held stays locked. A worker allocates its stripe's bits and message
+ *      buffers after the fork (glibc's malloc re-initialises its locks in
+ *      the child), but takes no other lock: no streams, no locale. It ends
+ *      with `_exit`, an exception included, and never unwinds into the
+ *      caller's frames or runs its atexit handlers.
+ */
+class PartitionedBfs {
+    using index_type = uint32_t;
+
+    static constexpr index_type npos = UINT32_MAX;
+
+    enum class command : uint32_t {
+        next  = 0, /* run one more level */
+        stop  = 1, /* the search is over, traces may follow */
+        trace = 2, /* followed by a cell: walk its parents to the border */
+        quit  = 3,
+    };
+
+    struct Report {
+        uint64_t frontier  = 0; /* cells of the next level in the stripe */
+        uint64_t exchanged = 0; /* cells sent to the neighbours */
+        uint32_t found     = 0; /* the exit is visited */
+        uint32_t reserved  = 0;
+    };
+
+    static bool send_cells(int fd, const vector<index_type>& cells) {
+        const auto count = static_cast<uint32_t>(cells.size());
+        return Socket::write_all(fd, &count, sizeof(count))
+            && Socket::write_all(fd, cells.data(), cells.size() * sizeof(index_type));
+    }
+    static bool receive_cells(int fd, vector<index_type>& cells) {
+        uint32_t count = 0;
+        if (!Socket::read_exact(fd, &count, sizeof(count))) {
+            return false;
+        }
+        cells.resize(count);
+        return Socket::read_exact(fd, cells.data(), cells.size() * sizeof(index_type));
+    }
+
+    /* a neighbour stripe: cells to send and cells received this round */
+    struct Border {
+        int                fd  = -1;
+        vector<index_type> out = {}; /* cells sent across */
+        vector<index_type> in  = {}; /* cells received */
+    };
+
+    /**
+     * @brief send `out` to, and receive `in` from, both borders at once
+     *
+     * @note with blocking writes, two neighbours both sending more than a
+     *      socket buffer would wait on each other forever, so the frames
+     *      (a count, then the cells) go out as the sockets take them
+     */
+    static bool exchange(Border& up, Border& down) {
+#if defined(MSG_NOSIGNAL)
+        static constexpr int flags = MSG_DONTWAIT | MSG_NOSIGNAL;
+#else
+        static constexpr int flags = MSG_DONTWAIT;
+#endif
+        struct Progress {
+            Border*  border   = nullptr;
+            uint32_t counts[2] = {}; /* sent, received */
+            size_t   sent     = 0;   /* bytes, count included */
+            size_t   got      = 0;
+        };
+        Progress progress[2] = { { &up }, { &down } };
+        for (auto& each : progress) {
+            each.counts[0] = static_cast<uint32_t>(each.border->out.size());
+        }
+        auto out_bytes = [](const Progress& each) {
+            return sizeof(uint32_t) + each.counts[0] * sizeof(index_type);
+        };
+        auto in_bytes = [](const Progress& each) {
+            return each.got < sizeof(uint32_t) ? sizeof(uint32_t) : sizeof(uint32_t) + each.counts[1] * sizeof(index_type);
+        };
+        auto pending = [&](const Progress& each) {
+            return each.border->fd >= 0 && (each.sent < out_bytes(each) || each.got < in_bytes(each));
+        };
+
+        while (pending(progress[0]) || pending(progress[1])) {
+            pollfd fds[2] = {};
+            for (int k = 0; k < 2; ++k) {
+                fds[k].fd = pending(progress[k]) ? progress[k].border->fd : -1;
+                if (progress[k].sent < out_bytes(progress[k])) {
+                    fds[k].events |= POLLOUT;
+                }
+                if (progress[k].got < in_bytes(progress[k])) {
+                    fds[k].events |= POLLIN;
+                }
+            }
+            if (::poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            for (int k = 0; k < 2; ++k) {
+                auto& each = progress[k];
+                if (fds[k].revents & POLLOUT) {
+                    // the count first, then the cells
+                    const bool  if_count = each.sent < sizeof(uint32_t);
+                    const auto* bytes    = if_count ? reinterpret_cast<const char*>(&each.counts[0]) + each.sent
+                                                    : reinterpret_cast<const char*>(each.border->out.data()) + (each.sent - sizeof(uint32_t));
+                    const size_t left    = if_count ? sizeof(uint32_t) - each.sent : out_bytes(each) - each.sent;
+                    ssize_t      sent    = ::send(each.border->fd, bytes, left, flags);
+                    if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                        return false;
+                    }
+                    each.sent += static_cast<size_t>(std::max<ssize_t>(0, sent));
+                }
+                if (fds[k].revents & (POLLIN | POLLHUP | POLLERR)) {
+                    const bool if_count = each.got < sizeof(uint32_t);
+                    auto*      bytes    = if_count ? reinterpret_cast<char*>(&each.counts[1]) + each.got
+                                                   : reinterpret_cast<char*>(each.border->in.data()) + (each.got - sizeof(uint32_t));
+                    const size_t left   = if_count ? sizeof(uint32_t) - each.got : in_bytes(each) - each.got;
+                    ssize_t      got    = ::recv(each.border->fd, bytes, left, flags);
+                    if (got == 0 || (got < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                        return false;
+                    }
+                    each.got += static_cast<size_t>(std::max<ssize_t>(0, got));
+                    if (if_count && each.got == sizeof(uint32_t)) {
+                        each.border->in.resize(each.counts[1]);
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief the whole life of worker owning rows [first, last)
+     *
+     * @param up, down  sockets to the neighbour stripes, -1 at the edges
+     * @return exit code of the worker process
+     */
+    static int work(
+        std::span<const uint8_t> cells,
+        size_t                   size,
+        size_t                   first,
+        size_t                   last,
+        index_type               source,
+        index_type               target,
+        int                      control,
+        int                      up,
+        int                      down
+    ) {
+        const size_t     base  = first * size;
+        const size_t     count = (last - first) * size;
+        vector<uint64_t> visited((count + 63) / 64, 0);
+        vector<uint8_t>  parents((count + 3) / 4, 0); /* heading to the parent */
+
+        auto owns = [&](size_t idx) {
+            return idx >= base && idx < base + count;
+        };
+        auto if_visited = [&](size_t idx) {
+            return (visited[(idx - base) / 64] >> ((idx - base) % 64)) & 1;
+        };
+        auto visit = [&](size_t idx, heading to_parent) {
+            const size_t local = idx - base;
+            visited[local / 64] |= uint64_t(1) << (local % 64);
+            parents[local / 4] |= static_cast<uint8_t>(static_cast<uint8_t>(to_parent) << (local % 4 * 2));
+        };
+        auto parent_of = [&](size_t idx) {
+            const size_t local = idx - base;
+            return static_cast<heading>((parents[local / 4] >> (local % 4 * 2)) & 0b11);
+        };
+
+        vector<index_type> frontier, next;
+        Border             above { up };
+        Border             below { down };
+        if (owns(source)) {
+            visit(source, heading::north);
+            frontier.push_back(source);
+        }
+
+        // level-synchronous bfs, one round per level
+        for (command order = command::next; order == command::next;) {
+            next.clear();
+            above.out.clear();
+            below.out.clear();
+            for (const index_type idx : frontier) {
+                const size_t x = idx / size;
+                const size_t y = idx % size;
+                for (heading dir : { heading::north, heading::south, heading::west, heading::east }) {
+                    if ((dir == heading::north && x == 0) || (dir == heading::south && x + 1 == size)
+                        || (dir == heading::west && y == 0) || (dir == heading::east && y + 1 == size)) {
+                        continue;
+                    }
+                    const index_type to = step(idx, dir, size);
+                    if (!(cells[to] & GridFile::open_bit)) {
+                        continue;
+                    }
+                    if (!owns(to)) {
+                        (dir == heading::north ? above : below).out.push_back(to);
+                    } else if (!if_visited(to)) {
+                        visit(to, reverse(dir));
+                        next.push_back(to);
+                    }
+                }
+            }
+
+            if (!exchange(above, below)) {
+                return 1;
+            }
+            for (const index_type idx : above.in) {
+                if (!if_visited(idx)) {
+                    visit(idx, heading::north);
+                    next.push_back(idx);
+                }
+            }
+            for (const index_type idx : below.in) {
+                if (!if_visited(idx)) {
+                    visit(idx, heading::south);
+                    next.push_back(idx);
+                }
+            }
+
+            Report report;
+            report.frontier  = next.size();
+            report.exchanged = above.out.size() + below.out.size();
+            report.found     = owns(target) && if_visited(target);
+            if (!Socket::write_all(control, &report, sizeof(report))
+                || !Socket::read_exact(control, &order, sizeof(order))) {
+                return 1;
+            }
+            frontier.swap(next);
+        }
+
+        // stitching, one segment per visit of the route to this stripe
+        command order = command::stop;
+        while (Socket::read_exact(control, &order, sizeof(order)) && order == command::trace) {
+            index_type curr = npos;
+            if (!Socket::read_exact(control, &curr, sizeof(curr))) {
+                return 1;
+            }
+            vector<index_type> segment;
+            index_type         handoff = npos;
+            while (true) {
+                segment.push_back(curr);
+                if (curr == source) {
+                    break;
+                }
+                const index_type prev = step(curr, parent_of(curr), size);
+                if (!owns(prev)) {
+                    handoff = prev;
+                    break;
+                }
+                curr = prev;
+            }
+            if (!send_cells(control, segment) || !Socket::write_all(control, &handoff, sizeof(handoff))) {
+                return 1;
+            }
+        }
+        return order == command::quit ? 0 : 1;
+    }
+
+public:
+    /**
+     * @brief shortest route from `source` to `target` (flat row-major indices)
+     *      over `cells`, a `size` x `size` grid, split among `workers` processes
+     *
+     * @param cells  path cells have `GridFile::open_bit` set
+     * @throw std::runtime_error if a worker can't be started or dies
+     */
+    static PartitionedResult route(
+        std::span<const uint8_t> cells,
+        size_t                   size,
+        index_type               source,
+        index_type               target,
+        size_t                   workers
+    ) {
+        PartitionedResult ret;
+        if (size == 0 || cells.size() < size * size) {
+            throw std::invalid_argument("Cells do not fill the grid!");
+        }
+        if (source >= cells.size() || target >= cells.size()
+            || !(cells[source] & GridFile::open_bit) || !(cells[target] & GridFile::open_bit)) {
+            return ret;
+        }
+        workers     = std::clamp<size_t>(workers, 1, size);
+        ret.workers = workers;
+
+        // control[i]: coordinator <-> worker i, link[i]: worker i <-> worker i + 1
+        vector<std::pair<int, int>> control(workers, { -1, -1 });
+        vector<std::pair<int, int>> link(workers - 1, { -1, -1 });
+        vector<pid_t>               pids;
+        auto                        close_all = [&]() {
+            for (auto* pairs : { &control, &link }) {
+                for (auto& [lhs, rhs] : *pairs) {
+                    for (int* fd : { &lhs, &rhs }) {
+                        if (*fd >= 0) {
+                            ::close(*fd);
+                            *fd = -1;
+                        }
+                    }
+                }
+            }
+        };
+        auto fail = [&](const char* message) {
+            close_all();
+            for (pid_t pid : pids) {
+                ::kill(pid, SIGKILL);
+                ::waitpid(pid, nullptr, 0);
+            }
+            throw std::runtime_error(message);
+        };
+        for (auto* pairs : { &control, &link }) {
+            for (auto& [lhs, rhs] : *pairs) {
+                int fds[2];
+                if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+                    fail("Cannot connect the workers!");
+                }
+                lhs = fds[0];
+                rhs = fds[1];
+            }
+        }
+
+        // workers use the second end of their pairs, the coordinator the first
+        for (size_t i = 0; i < workers; ++i) {
+            const pid_t pid = ::fork();
+            if (pid < 0) {
+                fail("Cannot start a worker!");
+            }
+            if (pid == 0) {
+                const int own_control = control[i].second;
+                const int up          = i > 0 ? link[i - 1].second : -1;
+                const int down        = i + 1 < workers ? link[i].first : -1;
+                for (auto* pairs : { &control, &link }) {
+                    for (auto [lhs, rhs] : *pairs) {
+                        for (int fd : { lhs, rhs }) {
+                            if (fd != own_control && fd != up && fd != down) {
+                                ::close(fd);
+                            }
+                        }
+                    }
+                }
+                int code = 1;
+                try {
+                    code = work(cells, size, size * i / workers, size * (i + 1) / workers, source, target, own_control, up, down);
+                } catch (...) {
+                    // e.g. bad_alloc: the coordinator sees the socket close and fails
+                }
+                ::_exit(code);
+            }
+            pids.push_back(pid);
+        }
+        for (auto& [lhs, rhs] : control) {
+            ::close(rhs);
+            rhs = -1;
+        }
+        for (auto& [lhs, rhs] : link) {
+            ::close(lhs);
+            ::close(rhs);
+            lhs = rhs = -1;
+        }
+
+        auto order = [&](size_t worker, command what) {
+            if (!Socket::write_all(control[worker].first, &what, sizeof(what))) {
+                fail("A worker is gone!");
+            }
+        };
+
+        // one barrier per level, until the exit is reached or nothing is left
+        while (true) {
+            ++ret.rounds;
+            uint64_t frontier = 0;
+            for (size_t i = 0; i < workers; ++i) {
+                Report report;
+                if (!Socket::read_exact(control[i].first, &report, sizeof(report))) {
+                    fail("A worker is gone!");
+                }
+                frontier += report.frontier;
+                ret.exchanged += report.exchanged;
+                ret.found = ret.found || report.found;
+            }
+            const bool if_over = ret.found || frontier == 0;
+            for (size_t i = 0; i < workers; ++i) {
+                order(i, if_over ? command::stop : command::next);
+            }
+            if (if_over) {
+                break;
+            }
+        }
+
+        // stitch the segments, from the exit back to the entry
+        for (index_type curr = ret.found ? target : npos; curr != npos;) {
+            // the owner of row r is the last i with size * i / workers <= r
+            const size_t row    = curr / size;
+            size_t       worker = row * workers / size;
+            while (worker + 1 < workers && size * (worker + 1) / workers <= row) {
+                ++worker;
+            }
+            order(worker, command::trace);
+            vector<index_type> segment;
+            if (!Socket::write_all(control[worker].first, &curr, sizeof(curr))
+                || !receive_cells(control[worker].first, segment)
+                || !Socket::read_exact(control[worker].first, &curr, sizeof(curr))) {
+                fail("A worker is gone!");
+            }
+            ret.route.insert(ret.route.end(), segment.begin(), segment.end());
+        }
+        std::reverse(ret.route.begin(), ret.route.end());
+
+        for (size_t i = 0; i < workers; ++i) {
+            order(i, command::quit);
+        }
+        close_all();
+        bool if_clean = true;
+        for (pid_t pid : pids) {
+            int status = 0;
+            ::waitpid(pid, &status, 0);
+            if_clean = if_clean && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        }
+        if (!if_clean) {
+            throw std::runtime_error("A worker failed!");
+        }
+        return ret;
+    }
+};
+
+#endif
+
+} // namespace Utility
@@ -0,0 +1,128 @@
+/**
+ * @file Portfolio.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Race several optimal solvers on threads, keep the first answer
+ * @version 0.1
+ * @date 2023-01-20
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "AsyncSolve.hpp"
+#include "Maze.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace Utility {
+
+using std::vector;
+
+/// @brief the solvers of a portfolio, all returning shortest routes
+enum class portfolio_algorithm {
+    bfs,           /* best in tight corridors */
+    bidirectional, /* about half the cells of `bfs` on long routes */
+    a_star,        /* best in open areas, where the heuristic is accurate */
+};
+
+inline std::string_view name_of(portfolio_algorithm algorithm) {
+    switch (algorithm) {
+    case portfolio_algorithm::bfs:
+        return "bfs";
+    case portfolio_algorithm::bidirectional:
+        return "bidirectional";
+    default:
+        return "a*";
+    }
+}
+
+/**
+ * @brief outcome of a portfolio race
+ *
+ */
+struct PortfolioResult {
+    /// @brief the solver that answered first
+    portfolio_algorithm winner = portfolio_algorithm::bfs;
+
+    bool if_found = false;
+
+    /// @brief flat row-major indices from entry to exit (empty if not found)
+    vector<Maze::index_type> route = {};
+};
+
+/**
+ * @brief race `bfs`, bidirectional `bfs` and `a*` on `maze`, one thread each
+ *
+ * Every solver is exact, so whichever finishes first (route or no route) has
+ *  the answer: it claims the win, then cancels the others, which notice it at
+ *  their next check-in (every `check_interval` expansions) and give up. The
+ *  maze is only read, each thread searches in its own workspaces.
+ *
+ * @attention `maze` must not be `set`/`reset` during the race
+ */
+inline PortfolioResult solve_portfolio(
+    const Maze&       maze,
+    const coordinate& entry,
+    const coordinate& exit,
+    size_t            check_interval = 256
+) {
+    static constexpr std::array<portfolio_algorithm, 3> algorithms = {
+        portfolio_algorithm::bfs,
+        portfolio_algorithm::bidirectional,
+        portfolio_algorithm::a_star,
+    };
+
+    check_interval = std::max<size_t>(check_interval, 1);
+
+    CancellationToken token;
+    std::atomic<bool> if_claimed = false;
+    PortfolioResult   ret;
+
+    auto race = [&](portfolio_algorithm algorithm) {
+        Workspace ws;
+        Workspace back;
+
+        auto if_continue = [&](size_t expanded) {
+            return expanded % check_interval != 0 || !token.is_cancelled();
+        };
+
+        Maze::search_status status;
+        switch (algorithm) {
+        case portfolio_algorithm::bfs:
+            status = maze.bfs_search(ws, entry, exit, if_continue);
+            break;
+        case portfolio_algorithm::bidirectional:
+            status = maze.bidirectional_search(ws, back, entry, exit, if_continue);
+            break;
+        default:
+            status = maze.a_star_search(ws, entry, exit, if_continue);
+            break;
+        }
+        if (status == Maze::search_status::stopped || if_claimed.exchange(true)) {
+            return; /* lost the race */
+        }
+        token.cancel();
+        ret.winner   = algorithm;
+        ret.if_found = status == Maze::search_status::found;
+        ret.route.assign(ws.get_route().begin(), ws.get_route().end());
+    };
+
+    vector<std::thread> threads;
+    threads.reserve(algorithms.size());
+    for (auto algorithm : algorithms) {
+        threads.emplace_back(race, algorithm);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return ret;
+}
+
+} // namespace Utility
@@ -0,0 +1,381 @@
+/**
+ * @file RouteCache.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Sharded cache of solved routes, lock-free for readers
+ * @version 0.1
+ * @date 2023-01-26
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "Heading.hpp"
+#include "Workspace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace Utility {
+
+using std::vector;
+
+/**
+ * @brief limits of a `RouteCache`
+ *
+ */
+struct RouteCacheConfig {
+    /// @brief independent parts, rounded up to a power of two
+    size_t shards = 16;
+
+    /// @brief routes held at most, over all shards
+    size_t slots = size_t(1) << 16;
+
+    /// @brief bytes of routes held at most, over all shards, retired ones
+    ///     (replaced, not freed yet) included
+    size_t max_bytes = size_t(64) << 20;
+};
+
+/**
+ * @brief counters of a `RouteCache`, summed over the shards
+ *
+ */
+struct RouteCacheStats {
+    uint64_t hits       = 0;
+    uint64_t misses     = 0;
+    uint64_t insertions = 0;
+    uint64_t evictions  = 0;
+    uint64_t rejected   = 0; /* routes too large to keep */
+    size_t   entries    = 0;
+    size_t   bytes      = 0; /* cached and retired routes, all allocated */
+
+    double hit_rate() const {
+        return hits + misses == 0 ? 0 : static_cast<double>(hits) / static_cast<double>(hits + misses);
+    }
+};
+
+/**
+ * @brief solved routes keyed by (maze version, entry, exit)
+ *
+ * A route is kept as its first cell plus one 2-bit `heading` per step, 16
+ *  times smaller than the cell indices. Keys carry the version of the maze
+ *  (`Maze::get_version`, bumped by every `set` / `reset`), so routes of an
+ *  older maze can never be hit again and simply age out.
+ *
+ * Each shard is a set-associative table of `ways` slots per set holding
+ *  pointers to immutable routes:
+ *
+ *  - readers only load pointers and flip a CLOCK reference bit, no lock;
+ *  - writers take the shard mutex, replace a slot (second chance inside the
+ *    set) and, over 3/4 of the shard's bytes, sweep the CLOCK hand across it;
+ *  - replaced routes are retired, and freed by a grace period once they
+ *    outgrow the last 1/4 of the shard's bytes.
+ *
+ * Grace periods are per shard, with two reader counters and a phase bit (as
+ *  in sleepable RCU): a reader counts itself in the counter of the current
+ *  phase, and checks the phase again before touching a slot. A writer
+ *  flips the phase, then waits for the counter of the old phase to drain:
+ *  readers that may still hold a retired route all counted themselves there,
+ *  and new readers count in the other one, so the wait is bounded by the
+ *  lookups already in flight, however busy the shard is. Retired routes stay
+ *  counted in `bytes` until they are freed, so a shard never holds more than
+ *  its share of `max_bytes`.
+ */
+class RouteCache {
+public:
+    using index_type = Workspace::index_type;
+
+    static constexpr size_t ways = 8;
+
+    struct Key {
+        uint64_t   version = 0;
+        index_type entry   = 0;
+        index_type exit    = 0;
+
+        bool operator==(const Key&) const = default;
+    };
+
+private:
+    struct CompactRoute {
+        Key             key      = {};
+        bool            found    = false;
+        uint32_t        steps    = 0;
+        vector<uint8_t> headings = {}; /* 4 steps per byte */
+
+        size_t bytes() const {
+            return sizeof(CompactRoute) + headings.capacity();
+        }
+        /// @brief `bytes()` of the route of `cells` cells, before compressing it
+        static size_t bytes_of(bool found, size_t cells) {
+            return sizeof(CompactRoute) + (found && cells > 0 ? (cells + 2) / 4 : 0);
+        }
+    };
+
+    struct alignas(64) Shard {
+        std::unique_ptr<std::atomic<const CompactRoute*>[]> slots      = nullptr;
+        std::unique_ptr<std::atomic<uint8_t>[]>             referenced = nullptr;
+        size_t                                              sets       = 0;
+
+        std::atomic<uint32_t> phase      = 0;
+        std::atomic<uint32_t> readers[2] = {};
+
+        /* writers only, under `mutex` */
+        std::mutex                  mutex         = {};
+        vector<const CompactRoute*> retired       = {};
+        size_t                      retired_bytes = 0;
+        size_t                      live_bytes    = 0;
+        size_t                      hand          = 0;
+
+        std::atomic<uint64_t> hits       = 0;
+        std::atomic<uint64_t> misses     = 0;
+        std::atomic<uint64_t> insertions = 0;
+        std::atomic<uint64_t> evictions  = 0;
+        std::atomic<uint64_t> rejected   = 0;
+        std::atomic<size_t>   entries    = 0;
+        std::atomic<size_t>   bytes      = 0;
+    };
+
+    std::unique_ptr<Shard[]> shards      = nullptr;
+    size_t                   shard_count = 0;
+    size_t                   shard_bytes = 0;
+    size_t                   live_budget = 0; /* 3/4 of `shard_bytes`, the rest for retired routes */
+
+    static uint64_t hash_of(const Key& key) {
+        uint64_t value = key.version * 0x9E3779B97F4A7C15
+                       ^ (static_cast<uint64_t>(key.entry) << 32 | key.exit);
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+        return value ^ (value >> 31);
+    }
+    Shard& shard_of(uint64_t hash) const {
+        return shards[hash & (shard_count - 1)];
+    }
+    static size_t set_of(const Shard& shard, uint64_t hash) {
+        return (hash >> 32) % shard.sets * ways;
+    }
+
+    static CompactRoute* compress(const Key& key, size_t width, bool found, std::span<const index_type> route) {
+        auto* ret = new CompactRoute { key, found };
+        if (!found || route.empty()) {
+            return ret;
+        }
+        ret->steps = static_cast<uint32_t>(route.size() - 1);
+        ret->headings.assign((ret->steps + 3) / 4, 0);
+        for (size_t i = 1; i < route.size(); ++i) {
+            heading dir = heading::east;
+            if (route[i] + width == route[i - 1]) {
+                dir = heading::north;
+            } else if (route[i] == route[i - 1] + width) {
+                dir = heading::south;
+            } else if (route[i] + 1 == route[i - 1]) {
+                dir = heading::west;
+            }
+            const size_t k = i - 1;
+            ret->headings[k / 4] |= static_cast<uint8_t>(static_cast<uint8_t>(dir) << (k % 4 * 2));
+        }
+        return ret;
+    }
+
+    /**
+     * @brief start reading the slots of `shard`
+     *
+     * @return uint32_t  the phase to `leave` with
+     */
+    static uint32_t enter(Shard& shard) {
+        while (true) {
+            const uint32_t phase = shard.phase.load();
+            shard.readers[phase].fetch_add(1);
+            if (shard.phase.load() == phase) {
+                return phase;
+            }
+            shard.readers[phase].fetch_sub(1); /* a grace period began, count in the new phase */
+        }
+    }
+    static void leave(Shard& shard, uint32_t phase) {
+        shard.readers[phase].fetch_sub(1, std::memory_order_release);
+    }
+
+    /// @brief wait out the readers that may hold a retired route, then free them all
+    static void drain(Shard& shard) {
+        const uint32_t old = shard.phase.load();
+        shard.phase.store(old ^ 1);
+        while (shard.readers[old].load() != 0) {
+            std::this_thread::yield();
+        }
+        for (auto* route : shard.retired) {
+            delete route;
+        }
+        shard.retired.clear();
+        shard.bytes.fetch_sub(shard.retired_bytes, std::memory_order_relaxed);
+        shard.retired_bytes = 0;
+    }
+    static void retire(Shard& shard, size_t slot) {
+        const CompactRoute* old = shard.slots[slot].exchange(nullptr);
+        shard.entries.fetch_sub(1, std::memory_order_relaxed);
+        shard.live_bytes -= old->bytes();
+        shard.retired_bytes += old->bytes();
+        shard.retired.push_back(old);
+    }
+
+public:
+    explicit RouteCache(const RouteCacheConfig& config = {})
+        : shard_count(std::bit_ceil(std::max<size_t>(1, config.shards)))
+        , shard_bytes(config.max_bytes / std::bit_ceil(std::max<size_t>(1, config.shards)))
+        , live_budget(shard_bytes - shard_bytes / 4) {
+        const size_t sets = std::max<size_t>(1, config.slots / shard_count / ways);
+        shards            = std::make_unique<Shard[]>(shard_count);
+        for (size_t s = 0; s < shard_count; ++s) {
+            shards[s].sets       = sets;
+            shards[s].slots      = std::make_unique<std::atomic<const CompactRoute*>[]>(sets * ways);
+            shards[s].referenced = std::make_unique<std::atomic<uint8_t>[]>(sets * ways);
+        }
+    }
+    ~RouteCache() {
+        for (size_t s = 0; s < shard_count; ++s) {
+            auto& shard = shards[s];
+            for (size_t slot = 0; slot < shard.sets * ways; ++slot) {
+                delete shard.slots[slot].load();
+            }
+            for (auto* route : shard.retired) {
+                delete route;
+            }
+        }
+    }
+    RouteCache(const RouteCache&)            = delete;
+    RouteCache& operator=(const RouteCache&) = delete;
+
+    /**
+     * @brief look `key` up, on a hit leave its route in `ws`
+     *
+     * @param width  side of the (square) maze, to expand the headings
+     * @return nullopt on a miss, otherwise whether a route exists
+     * @note never blocks
+     */
+    std::optional<bool> lookup(const Key& key, size_t width, Workspace& ws) const {
+        const uint64_t hash  = hash_of(key);
+        Shard&         shard = shard_of(hash);
+        const size_t   base  = set_of(shard, hash);
+
+        std::optional<bool> ret   = std::nullopt;
+        const uint32_t      phase = enter(shard);
+        for (size_t w = 0; w < ways; ++w) {
+            const CompactRoute* route = shard.slots[base + w].load();
+            if (route == nullptr || route->key != key) {
+                continue;
+            }
+            if (!shard.referenced[base + w].load(std::memory_order_relaxed)) {
+                shard.referenced[base + w].store(1, std::memory_order_relaxed);
+            }
+            ws.begin(width * width);
+            if (route->found) {
+                index_type idx = key.entry;
+                ws.append_route(idx);
+                for (uint32_t k = 0; k < route->steps; ++k) {
+                    idx = step(idx, static_cast<heading>((route->headings[k / 4] >> (k % 4 * 2)) & 0b11), width);
+                    ws.append_route(idx);
+                }
+            }
+            ret = route->found;
+            break;
+        }
+        leave(shard, phase);
+
+        (ret.has_value() ? shard.hits : shard.misses).fetch_add(1, std::memory_order_relaxed);
+        return ret;
+    }
+
+    /**
+     * @brief keep the result of `key`, `route` being the cells if `found`
+     *
+     * @note a route larger than 3/4 of a shard's byte budget is not kept
+     *      (counted as `rejected`), nothing is evicted for it. May wait for
+     *      the lookups in flight on the shard, see `drain`
+     */
+    void store(const Key& key, size_t width, bool found, std::span<const index_type> route) {
+        const uint64_t hash  = hash_of(key);
+        Shard&         shard = shard_of(hash);
+        if (CompactRoute::bytes_of(found, route.size()) > live_budget) {
+            shard.rejected.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        const size_t  base     = set_of(shard, hash);
+        CompactRoute* fresh    = compress(key, width, found, route);
+        const size_t  capacity = shard.sets * ways;
+
+        std::lock_guard lock { shard.mutex };
+
+        // the same key, an empty way, or the first way without a second chance
+        size_t slot = base + ways;
+        for (size_t w = 0; w < ways && slot == base + ways; ++w) {
+            const CompactRoute* old = shard.slots[base + w].load();
+            if (old == nullptr || old->key == key) {
+                slot = base + w;
+            }
+        }
+        for (size_t round = 0; slot == base + ways; ++round) {
+            for (size_t w = 0; w < ways; ++w) {
+                if (round > 0 || !shard.referenced[base + w].exchange(0, std::memory_order_relaxed)) {
+                    slot = base + w;
+                    break;
+                }
+            }
+        }
+        if (const CompactRoute* old = shard.slots[slot].load(); old != nullptr) {
+            if (old->key != key) {
+                shard.evictions.fetch_add(1, std::memory_order_relaxed);
+            }
+            retire(shard, slot);
+        }
+        shard.referenced[slot].store(0, std::memory_order_relaxed);
+        shard.slots[slot].store(fresh);
+        shard.entries.fetch_add(1, std::memory_order_relaxed);
+        shard.live_bytes += fresh->bytes();
+        shard.bytes.fetch_add(fresh->bytes(), std::memory_order_relaxed);
+        shard.insertions.fetch_add(1, std::memory_order_relaxed);
+
+        // CLOCK over the whole shard until back under the budget of live routes
+        while (shard.live_bytes > live_budget) {
+            const size_t victim = shard.hand;
+            shard.hand          = (shard.hand + 1) % capacity;
+            if (shard.slots[victim].load() == nullptr
+                || shard.referenced[victim].exchange(0, std::memory_order_relaxed)) {
+                continue;
+            }
+            retire(shard, victim);
+            shard.evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (shard.retired_bytes > shard_bytes - live_budget) {
+            drain(shard);
+        }
+    }
+
+    /**
+     * @brief counters summed over the shards (each one read atomically)
+     *
+     */
+    RouteCacheStats stats() const {
+        RouteCacheStats ret;
+        for (size_t s = 0; s < shard_count; ++s) {
+            const auto& shard = shards[s];
+            ret.hits += shard.hits.load(std::memory_order_relaxed);
+            ret.misses += shard.misses.load(std::memory_order_relaxed);
+            ret.insertions += shard.insertions.load(std::memory_order_relaxed);
+            ret.evictions += shard.evictions.load(std::memory_order_relaxed);
+            ret.rejected += shard.rejected.load(std::memory_order_relaxed);
+            ret.entries += shard.entries.load(std::memory_order_relaxed);
+            ret.bytes += shard.bytes.load(std::memory_order_relaxed);
+        }
+        return ret;
+    }
+};
+
+} // namespace Utility
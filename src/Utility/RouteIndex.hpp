@@ -0,0 +1,277 @@
+/**
+ * @file RouteIndex.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Persisted shortest-path tree towards a fixed target
+ * @version 0.1
+ * @date 2023-01-12
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "Heading.hpp"
+#include "MappedFile.hpp"
+#include "Workspace.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace Utility {
+
+using std::vector;
+
+/**
+ * @brief bfs distance field + parent headings towards one target, on disk
+ *
+ * Layout of the index file (native endianness):
+ *
+ *  1. `Header`
+ *  2. distance of every cell to the target, `uint32_t[cells]`
+ *      (`unreachable` for walls and other components)
+ *  3. heading of every cell towards its parent, 2 bits per cell
+ *
+ * The file is memory-mapped on load. A route from any entry is read by
+ *  following parent headings, in O(route length) without any search. The
+ *  header keeps a checksum of the maze, so a stale index is detected and
+ *  rebuilt.
+ */
+class RouteIndex {
+public:
+    using index_type = Workspace::index_type;
+
+    static constexpr uint32_t unreachable = UINT32_MAX;
+
+    struct Header {
+        char     magic[8] = { 'M', 'A', 'Z', 'E', 'I', 'D', 'X', '\0' };
+        uint32_t version  = 1;
+        uint32_t size     = 0;
+        uint32_t target   = 0;
+        uint32_t reserved = 0;
+        uint64_t checksum = 0;
+    };
+
+private:
+    std::shared_ptr<const MappedFile> file      = nullptr;
+    const Header*                     header    = nullptr;
+    const uint32_t*                   distances = nullptr;
+    const uint8_t*                    parents   = nullptr;
+
+    static size_t cell_count(const Header& header) {
+        return static_cast<size_t>(header.size) * header.size;
+    }
+    static size_t file_size_of(size_t cells) {
+        return sizeof(Header) + cells * sizeof(uint32_t) + (cells + 3) / 4;
+    }
+
+    heading parent_heading(index_type idx) const {
+        return static_cast<heading>((parents[idx / 4] >> (idx % 4 * 2)) & 0b11);
+    }
+
+    /// @return false if the mapped bytes don't look like an index
+    bool attach() {
+        if (file->get_size() < sizeof(Header)) {
+            return false;
+        }
+        header = reinterpret_cast<const Header*>(file->get_data());
+        if (std::memcmp(header->magic, Header {}.magic, sizeof(Header::magic)) != 0
+            || header->version != Header {}.version
+            || file->get_size() != file_size_of(cell_count(*header))) {
+            return false;
+        }
+        distances = reinterpret_cast<const uint32_t*>(file->get_data() + sizeof(Header));
+        parents   = reinterpret_cast<const uint8_t*>(distances + cell_count(*header));
+        return true;
+    }
+
+public:
+    /**
+     * @brief Default constructor (no index loaded)
+     *
+     */
+    RouteIndex() = default;
+
+    /**
+     * @brief FNV-1a over { size, target, cells }
+     *
+     */
+    static uint64_t checksum(
+        const vector<uint8_t>& cells,
+        size_t                 size,
+        index_type             target
+    ) {
+        uint64_t hash = 14695981039346656037ull;
+        auto     feed = [&](uint64_t byte) {
+            hash ^= byte;
+            hash *= 1099511628211ull;
+        };
+        for (int shift = 0; shift < 64; shift += 8) {
+            feed((static_cast<uint64_t>(size) >> shift) & 0xff);
+        }
+        for (int shift = 0; shift < 32; shift += 8) {
+            feed((target >> shift) & 0xff);
+        }
+        for (uint8_t cell : cells) {
+            feed(cell != 0);
+        }
+        return hash;
+    }
+
+    /**
+     * @brief bfs from `target` over the whole component, write the index
+     *
+     * @param path   index file (overwritten)
+     * @param cells  flat row-major grid, non-zero for path
+     * @param size
+     * @param target
+     */
+    static void build(
+        const std::filesystem::path& path,
+        const vector<uint8_t>&       cells,
+        size_t                       size,
+        index_type                   target
+    ) {
+        vector<uint32_t> distances(cells.size(), unreachable);
+        vector<uint8_t>  parents((cells.size() + 3) / 4, 0);
+        Workspace        ws;
+
+        ws.begin(cells.size());
+        ws.visit(target, target);
+        ws.push(target);
+        distances[target] = 0;
+
+        while (!ws.frontier_empty()) {
+            index_type from = ws.pop();
+            size_t     x    = from / size;
+            size_t     y    = from % size;
+
+            auto relax = [&](bool if_in_range, heading dir) {
+                if (!if_in_range) {
+                    return;
+                }
+                index_type to = step(from, dir, size);
+                if (!cells[to] || ws.visited(to)) {
+                    return;
+                }
+                ws.visit(to, from);
+                ws.push(to);
+                distances[to] = distances[from] + 1;
+                // parent of `to` is `from`, one step back the other way
+                auto code = static_cast<uint8_t>(reverse(dir));
+                parents[to / 4] |= static_cast<uint8_t>(code << (to % 4 * 2));
+            };
+            relax(x > 0, heading::north);
+            relax(x + 1 < size, heading::south);
+            relax(y > 0, heading::west);
+            relax(y + 1 < size, heading::east);
+        }
+
+        Header header;
+        header.size     = static_cast<uint32_t>(size);
+        header.target   = target;
+        header.checksum = checksum(cells, size, target);
+
+        // write aside then rename, so live mappings of the old index survive
+        auto          temp = std::filesystem::path(path) += ".tmp";
+        std::ofstream file { temp, std::ios::binary | std::ios::trunc };
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot create route index file!");
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(
+            reinterpret_cast<const char*>(distances.data()),
+            static_cast<std::streamsize>(distances.size() * sizeof(uint32_t))
+        );
+        file.write(
+            reinterpret_cast<const char*>(parents.data()),
+            static_cast<std::streamsize>(parents.size())
+        );
+        file.close();
+        if (!file.good()) {
+            throw std::runtime_error("Cannot write route index file!");
+        }
+        std::filesystem::rename(temp, path);
+    }
+
+    /**
+     * @brief map the index at `path`, rebuilding it first if it's missing,
+     *      malformed, or was built for another maze / target
+     *
+     * @return RouteIndex
+     */
+    static RouteIndex open_or_build(
+        const std::filesystem::path& path,
+        const vector<uint8_t>&       cells,
+        size_t                       size,
+        index_type                   target
+    ) {
+        const uint64_t expected = checksum(cells, size, target);
+
+        auto try_open = [&]() {
+            RouteIndex ret;
+            if (!std::filesystem::exists(path)) {
+                return ret;
+            }
+            ret.file = std::make_shared<const MappedFile>(path);
+            if (!ret.attach()
+                || ret.header->checksum != expected
+                || ret.header->size != size
+                || ret.header->target != target) {
+                return RouteIndex {};
+            }
+            return ret;
+        };
+
+        RouteIndex ret = try_open();
+        if (ret.empty()) {
+            build(path, cells, size, target);
+            ret = try_open();
+        }
+        if (ret.empty()) {
+            throw std::runtime_error("Route index is broken right after building!");
+        }
+        return ret;
+    }
+
+    bool empty() const {
+        return header == nullptr;
+    }
+    index_type get_target() const {
+        return header->target;
+    }
+
+    /**
+     * @brief distance from `idx` to the target (`unreachable` if none)
+     *
+     */
+    uint32_t get_distance(index_type idx) const {
+        return distances[idx];
+    }
+
+    /**
+     * @brief read the route from `source` to the target by following parents
+     *
+     * @return true if a route exists, the cells are left in `ws.get_route()`
+     */
+    bool route(Workspace& ws, index_type source) const {
+        ws.begin(cell_count(*header));
+        if (distances[source] == unreachable) {
+            return false;
+        }
+        const index_type target = header->target;
+        for (index_type curr = source; curr != target;) {
+            ws.append_route(curr);
+            curr = step(curr, parent_heading(curr), header->size);
+        }
+        ws.append_route(target);
+        return true;
+    }
+};
+
+} // namespace Utility
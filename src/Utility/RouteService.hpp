@@ -0,0 +1,378 @@
+/**
+ * @file RouteService.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Route queries over a Unix domain socket (server and client)
+ * @version 0.1
+ * @date 2023-01-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "Maze.hpp"
+#include "WorkerPool.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAZE_HAS_UNIX_SOCKET 1
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#else
+#define MAZE_HAS_UNIX_SOCKET 0
+#endif
+
+namespace Utility {
+
+using std::vector;
+
+/*
+ * Protocol: fixed-size frames in host byte order (both ends share a host).
+ *  A client may send any number of requests before reading. Every request
+ *  gets exactly one response tagged with its `id`; responses of pipelined
+ *  requests can come back in any order, as workers finish them.
+ */
+
+enum class route_op : uint16_t {
+    route    = 1, /* shortest route from entry to exit */
+    shutdown = 2, /* stop the server (answered before it stops) */
+};
+
+enum class route_status : uint16_t {
+    found       = 0, /* followed by `length` flat row-major indices */
+    no_route    = 1,
+    bad_request = 2, /* unknown op / maze, or an endpoint is not a path */
+    stopping    = 3,
+};
+
+struct RouteRequest {
+    uint32_t id      = 0;
+    route_op op      = route_op::route;
+    uint16_t maze    = 0; /* position in the served list */
+    int32_t  entry_x = 0;
+    int32_t  entry_y = 0;
+    int32_t  exit_x  = 0;
+    int32_t  exit_y  = 0;
+};
+
+struct RouteResponseHeader {
+    uint32_t     id       = 0;
+    route_status status   = route_status::found;
+    uint16_t     reserved = 0;
+    uint32_t     length   = 0;
+};
+
+static_assert(sizeof(RouteRequest) == 24 && sizeof(RouteResponseHeader) == 12);
+
+/// @brief a decoded response
+struct RouteReply {
+    uint32_t         id     = 0;
+    route_status     status = route_status::found;
+    vector<uint32_t> route  = {};
+};
+
+#if MAZE_HAS_UNIX_SOCKET
+
+namespace Socket {
+    /// @return false on end of stream
+    inline bool read_exact(int fd, void* buffer, size_t size) {
+        auto* bytes = static_cast<char*>(buffer);
+        while (size > 0) {
+            ssize_t got = ::read(fd, bytes, size);
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got <= 0) {
+                return false;
+            }
+            bytes += got;
+            size -= static_cast<size_t>(got);
+        }
+        return true;
+    }
+    /// @return false if the peer is gone
+    inline bool write_all(int fd, const void* buffer, size_t size) {
+#if defined(MSG_NOSIGNAL)
+        static constexpr int flags = MSG_NOSIGNAL;
+#else
+        static constexpr int flags = 0;
+#endif
+        auto* bytes = static_cast<const char*>(buffer);
+        while (size > 0) {
+            ssize_t sent = ::send(fd, bytes, size, flags);
+            if (sent < 0 && errno == EINTR) {
+                continue;
+            }
+            if (sent <= 0) {
+                return false;
+            }
+            bytes += sent;
+            size -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+    inline sockaddr_un address_of(const std::filesystem::path& path) {
+        sockaddr_un address {};
+        address.sun_family = AF_UNIX;
+        const std::string name = path.string();
+        if (name.size() >= sizeof(address.sun_path)) {
+            throw std::invalid_argument("Socket path is too long!");
+        }
+        std::memcpy(address.sun_path, name.c_str(), name.size() + 1);
+        return address;
+    }
+} // namespace Socket
+
+/**
+ * @brief serves route queries on loaded mazes until asked to shut down
+ *
+ * One reader thread per connection decodes requests and hands them to the
+ *  worker pool, so requests pipelined on one connection are solved in
+ *  parallel. The mazes are shared read-only, each worker has its own
+ *  workspace, so a query costs one search and no allocation.
+ */
+class RouteServer {
+    struct Connection {
+        int        fd          = -1;
+        std::mutex write_mutex = {};
+
+        explicit Connection(int fd)
+            : fd(fd) { }
+        ~Connection() {
+            ::close(fd);
+        }
+        void respond(const RouteResponseHeader& header, std::span<const uint32_t> route) {
+            std::lock_guard lock { write_mutex };
+            if (Socket::write_all(fd, &header, sizeof(header))) {
+                Socket::write_all(fd, route.data(), route.size_bytes());
+            }
+        }
+    };
+
+    const vector<std::shared_ptr<const Maze>> mazes;
+    const std::filesystem::path               socket_path;
+
+    int               listen_fd = -1;
+    std::atomic<bool> stopping  = false;
+
+    /* live connections, each read by one detached thread */
+    std::mutex                        connections_mutex = {};
+    std::condition_variable           all_closed        = {};
+    vector<std::weak_ptr<Connection>> connections       = {};
+    size_t                            readers           = 0;
+
+    WorkerPool pool; /* last member: joined first, while the rest is alive */
+
+    bool if_valid(const Maze& maze, int32_t x, int32_t y) const {
+        const auto size = static_cast<int64_t>(maze.get_size());
+        return x >= 0 && x < size && y >= 0 && y < size
+            && maze.get_cells()[maze.to_index({ x, y })];
+    }
+
+    void answer(Connection& connection, const RouteRequest& request, Workspace& ws) const {
+        RouteResponseHeader header;
+        header.id = request.id;
+        if (request.maze >= mazes.size()
+            || !if_valid(*mazes[request.maze], request.entry_x, request.entry_y)
+            || !if_valid(*mazes[request.maze], request.exit_x, request.exit_y)) {
+            header.status = route_status::bad_request;
+            connection.respond(header, {});
+            return;
+        }
+        const Maze& maze = *mazes[request.maze];
+        if (!maze.bfs_route(ws, { request.entry_x, request.entry_y }, { request.exit_x, request.exit_y })) {
+            header.status = route_status::no_route;
+            connection.respond(header, {});
+            return;
+        }
+        header.length = static_cast<uint32_t>(ws.get_route().size());
+        connection.respond(header, ws.get_route());
+    }
+
+    void read_requests(std::shared_ptr<Connection> connection) {
+        RouteRequest request;
+        while (Socket::read_exact(connection->fd, &request, sizeof(request))) {
+            if (stopping) {
+                RouteResponseHeader header;
+                header.id     = request.id;
+                header.status = route_status::stopping;
+                connection->respond(header, {});
+            } else if (request.op == route_op::route) {
+                pool.submit([this, connection, request](Workspace& ws) {
+                    answer(*connection, request, ws);
+                });
+            } else if (request.op == route_op::shutdown) {
+                RouteResponseHeader header;
+                header.id     = request.id;
+                header.status = route_status::stopping;
+                connection->respond(header, {});
+                stop();
+            } else {
+                RouteResponseHeader header;
+                header.id     = request.id;
+                header.status = route_status::bad_request;
+                connection->respond(header, {});
+            }
+        }
+    }
+
+public:
+    /**
+     * @brief bind `socket_path` (replacing a stale socket file)
+     *
+     * @param workers  0 for one per hardware thread
+     */
+    RouteServer(
+        std::filesystem::path               socket_path,
+        vector<std::shared_ptr<const Maze>> mazes,
+        size_t                              workers = 0
+    )
+        : mazes(std::move(mazes))
+        , socket_path(std::move(socket_path))
+        , pool(workers) {
+        auto address = Socket::address_of(this->socket_path);
+        std::filesystem::remove(this->socket_path);
+        listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd < 0
+            || ::bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+            || ::listen(listen_fd, SOMAXCONN) != 0) {
+            if (listen_fd >= 0) {
+                ::close(listen_fd);
+            }
+            throw std::runtime_error("Cannot listen on the socket!");
+        }
+    }
+    ~RouteServer() {
+        stop();
+        {
+            std::unique_lock lock { connections_mutex };
+            all_closed.wait(lock, [this]() {
+                return readers == 0;
+            });
+        }
+        ::close(listen_fd);
+        std::filesystem::remove(socket_path);
+    }
+
+    RouteServer(const RouteServer&)            = delete;
+    RouteServer& operator=(const RouteServer&) = delete;
+
+    /**
+     * @brief accept connections until `stop` (or a shutdown request)
+     *
+     */
+    void run() {
+        pollfd waiting { listen_fd, POLLIN, 0 };
+        while (!stopping) {
+            if (::poll(&waiting, 1, 100) <= 0) {
+                continue; /* timeout or signal, check `stopping` again */
+            }
+            int fd = ::accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) {
+                continue;
+            }
+            auto connection = std::make_shared<Connection>(fd);
+            {
+                std::lock_guard lock { connections_mutex };
+                std::erase_if(connections, [](const auto& weak) {
+                    return weak.expired();
+                });
+                connections.push_back(connection);
+                ++readers;
+                if (stopping) {
+                    ::shutdown(fd, SHUT_RD); /* `stop` ran before it was listed */
+                }
+            }
+            std::thread([this, connection = std::move(connection)]() mutable {
+                read_requests(std::move(connection));
+                // the last touch of `this`, the destructor waits for it
+                std::lock_guard lock { connections_mutex };
+                --readers;
+                all_closed.notify_all();
+            }).detach();
+        }
+    }
+
+    /**
+     * @brief stop accepting, and wake every reader (thread-safe)
+     *
+     */
+    void stop() {
+        stopping = true;
+        std::lock_guard lock { connections_mutex };
+        for (auto& weak : connections) {
+            if (auto connection = weak.lock()) {
+                ::shutdown(connection->fd, SHUT_RD);
+            }
+        }
+    }
+};
+
+/**
+ * @brief blocking client of `RouteServer` (one connection)
+ *
+ * `send` and `receive` are separate, so requests can be pipelined.
+ */
+class RouteClient {
+    int fd = -1;
+
+public:
+    explicit RouteClient(const std::filesystem::path& socket_path) {
+        auto address = Socket::address_of(socket_path);
+        fd           = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            throw std::runtime_error("Cannot connect to the route server!");
+        }
+    }
+    ~RouteClient() {
+        ::close(fd);
+    }
+
+    RouteClient(const RouteClient&)            = delete;
+    RouteClient& operator=(const RouteClient&) = delete;
+
+    void send(const RouteRequest& request) {
+        if (!Socket::write_all(fd, &request, sizeof(request))) {
+            throw std::runtime_error("Route server has gone!");
+        }
+    }
+    RouteReply receive() {
+        RouteResponseHeader header;
+        if (!Socket::read_exact(fd, &header, sizeof(header))) {
+            throw std::runtime_error("Route server has gone!");
+        }
+        RouteReply reply { header.id, header.status, vector<uint32_t>(header.length) };
+        if (!Socket::read_exact(fd, reply.route.data(), reply.route.size() * sizeof(uint32_t))) {
+            throw std::runtime_error("Route server has gone!");
+        }
+        return reply;
+    }
+    RouteReply query(const RouteRequest& request) {
+        send(request);
+        return receive();
+    }
+};
+
+#endif
+
+} // namespace Utility
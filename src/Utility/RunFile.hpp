@@ -0,0 +1,263 @@
+/**
+ * @file RunFile.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Sequential files of `uint64_t` records, and an external sorter
+ * @version 0.1
+ * @date 2023-01-15
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Utility {
+
+using std::vector;
+
+/// @brief records buffered by a run reader or writer unless told otherwise (128 KiB)
+inline constexpr size_t default_run_buffer = 1 << 14;
+
+/**
+ * @brief buffered, append-only writer of `uint64_t` records
+ *
+ */
+class RunWriter {
+    std::ofstream    file           = {};
+    vector<uint64_t> buffer         = {};
+    size_t           buffer_records = 0;
+    uint64_t         written        = 0;
+
+public:
+    explicit RunWriter(const std::filesystem::path& path, size_t buffer_records = default_run_buffer)
+        : file(path, std::ios::binary | std::ios::trunc)
+        , buffer_records(std::max<size_t>(1, buffer_records)) {
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot create run file!");
+        }
+        buffer.reserve(this->buffer_records);
+    }
+    ~RunWriter() {
+        flush();
+    }
+
+    RunWriter(const RunWriter&)            = delete;
+    RunWriter& operator=(const RunWriter&) = delete;
+
+    void push(uint64_t record) {
+        buffer.push_back(record);
+        ++written;
+        if (buffer.size() == buffer_records) {
+            flush();
+        }
+    }
+    void flush() {
+        if (buffer.empty()) {
+            return;
+        }
+        file.write(
+            reinterpret_cast<const char*>(buffer.data()),
+            static_cast<std::streamsize>(buffer.size() * sizeof(uint64_t))
+        );
+        if (!file.good()) {
+            throw std::runtime_error("Cannot write run file!");
+        }
+        buffer.clear();
+    }
+    uint64_t get_count() const {
+        return written;
+    }
+};
+
+/**
+ * @brief buffered, forward-only reader of `uint64_t` records
+ *
+ */
+class RunReader {
+    std::ifstream    file           = {};
+    vector<uint64_t> buffer         = {};
+    size_t           buffer_records = 0;
+    size_t           cursor         = 0;
+
+    bool refill() {
+        buffer.resize(buffer_records);
+        file.read(
+            reinterpret_cast<char*>(buffer.data()),
+            static_cast<std::streamsize>(buffer_records * sizeof(uint64_t))
+        );
+        buffer.resize(static_cast<size_t>(file.gcount()) / sizeof(uint64_t));
+        cursor = 0;
+        return !buffer.empty();
+    }
+
+public:
+    explicit RunReader(const std::filesystem::path& path, size_t buffer_records = default_run_buffer)
+        : file(path, std::ios::binary)
+        , buffer_records(std::max<size_t>(1, buffer_records)) {
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open run file!");
+        }
+    }
+
+    /// @return false at the end of the file
+    bool next(uint64_t& record) {
+        if (cursor == buffer.size() && !refill()) {
+            return false;
+        }
+        record = buffer[cursor++];
+        return true;
+    }
+};
+
+/**
+ * @brief sort more records than fit in memory
+ *
+ * Records are buffered up to `memory_cap` bytes, every full buffer is sorted
+ *  and spilled as a run file, and `finish` merges all runs into one sorted
+ *  run file (duplicates are kept).
+ *
+ * `memory_cap` covers the stream buffers too: the sort buffer leaves room for
+ *  the writer of a spill, and is released before merging, so that at most
+ *  `memory_cap` / stream buffer - 1 runs are merged at once (plus the
+ *  writer). More runs than that are merged in several passes.
+ */
+class ExternalSorter {
+    std::filesystem::path scratch_dir    = {};
+    std::string           prefix         = {};
+    vector<uint64_t>      buffer         = {};
+    size_t                capacity       = 0;
+    size_t                stream_records = 0;
+    size_t                fan_in         = 0;
+    size_t                next_run       = 0;
+
+    vector<std::filesystem::path> runs = {};
+
+    std::filesystem::path run_path() {
+        return scratch_dir / (prefix + ".run" + std::to_string(next_run++));
+    }
+    void spill() {
+        if (buffer.empty()) {
+            return;
+        }
+        std::sort(buffer.begin(), buffer.end());
+        auto path = run_path();
+        {
+            RunWriter writer { path, stream_records };
+            for (uint64_t record : buffer) {
+                writer.push(record);
+            }
+        }
+        runs.push_back(std::move(path));
+        buffer.clear();
+    }
+    /// @brief merge `runs[from, to)` into `writer`, then delete them
+    void merge(size_t from, size_t to, RunWriter& writer) {
+        using head = std::pair<uint64_t, size_t>; /* { record, run } */
+        vector<std::unique_ptr<RunReader>>                      readers;
+        std::priority_queue<head, vector<head>, std::greater<>> heads;
+        for (size_t i = from; i < to; ++i) {
+            readers.push_back(std::make_unique<RunReader>(runs[i], stream_records));
+            uint64_t record = 0;
+            if (readers.back()->next(record)) {
+                heads.emplace(record, i - from);
+            }
+        }
+        while (!heads.empty()) {
+            auto [record, run] = heads.top();
+            heads.pop();
+            writer.push(record);
+            if (readers[run]->next(record)) {
+                heads.emplace(record, run);
+            }
+        }
+        readers.clear();
+        for (size_t i = from; i < to; ++i) {
+            std::filesystem::remove(runs[i]);
+        }
+    }
+
+public:
+    /**
+     * @param memory_cap      bytes for the sort buffer, or the merge streams
+     * @param stream_records  records buffered by each run reader / writer
+     */
+    ExternalSorter(
+        std::filesystem::path scratch_dir,
+        std::string           prefix,
+        size_t                memory_cap,
+        size_t                stream_records = default_run_buffer
+    )
+        : scratch_dir(std::move(scratch_dir))
+        , prefix(std::move(prefix))
+        , stream_records(std::max<size_t>(1, stream_records)) {
+        const size_t stream_bytes = this->stream_records * sizeof(uint64_t);
+        capacity = std::max<size_t>(1, (memory_cap - std::min(memory_cap, stream_bytes)) / sizeof(uint64_t));
+        fan_in   = std::max<size_t>(3, memory_cap / stream_bytes) - 1;
+        buffer.reserve(capacity);
+    }
+
+    void push(uint64_t record) {
+        buffer.push_back(record);
+        if (buffer.size() == capacity) {
+            spill();
+        }
+    }
+
+    /**
+     * @brief merge everything pushed so far into the run file `output`
+     *
+     * @return number of records written
+     */
+    uint64_t finish(const std::filesystem::path& output) {
+        if (runs.empty()) {
+            // everything fit in memory, no merge needed
+            RunWriter writer { output, stream_records };
+            std::sort(buffer.begin(), buffer.end());
+            for (uint64_t record : buffer) {
+                writer.push(record);
+            }
+            buffer.clear();
+            return writer.get_count();
+        }
+        spill();
+        vector<uint64_t>().swap(buffer); /* the merge streams take its place */
+
+        // intermediate passes: `fan_in` runs at a time, until one pass is left
+        while (runs.size() > fan_in) {
+            vector<std::filesystem::path> merged;
+            for (size_t from = 0; from < runs.size(); from += fan_in) {
+                const size_t to = std::min(runs.size(), from + fan_in);
+                if (to - from == 1) {
+                    merged.push_back(std::move(runs[from]));
+                    continue;
+                }
+                auto path = run_path();
+                {
+                    RunWriter writer { path, stream_records };
+                    merge(from, to, writer);
+                }
+                merged.push_back(std::move(path));
+            }
+            runs = std::move(merged);
+        }
+        RunWriter writer { output, stream_records };
+        merge(0, runs.size(), writer);
+        runs.clear();
+        writer.flush();
+        return writer.get_count();
+    }
+};
+
+} // namespace Utility
@@ -0,0 +1,487 @@
+/**
+ * @file Search.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief One grid search, specialised at compile time by policies
+ * @version 0.1
+ * @date 2023-01-22
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "GridLayout.hpp"
+#include "Workspace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// inline every policy call (and what they call) into the search loop
+#if defined(__GNUC__)
+#define MAZE_FLATTEN [[gnu::flatten]]
+#else
+#define MAZE_FLATTEN
+#endif
+
+namespace Utility {
+
+using std::vector;
+
+/// @brief how a monitored search ended
+enum class search_status {
+    found,    /* route is in the workspace */
+    no_route, /* entry and exit are disconnected */
+    stopped,  /* monitor asked to stop, workspace has the best partial route */
+};
+
+/// @brief monitor that never stops a search (compiled away)
+struct no_monitor {
+    constexpr bool operator()(size_t) const {
+        return true;
+    }
+};
+
+/*
+ * Open-list policies, built on the workspace at the start of a search.
+ *
+ *  `push(g, h, idx)` adds a cell reached with cost `g` and estimate `h`,
+ *  `pop()` returns `{ g, idx }` of the next cell to expand. An entry whose
+ *  `g` is no longer the cell's distance is stale and skipped by the search.
+ */
+
+/**
+ * @brief FIFO queue (bfs order), only for searches without a heuristic
+ *
+ * @note every cell is pushed once, so no entry is ever stale
+ */
+class FifoOpen {
+    Workspace& ws;
+
+public:
+    static constexpr bool if_fifo = true;
+
+    explicit FifoOpen(Workspace& ws)
+        : ws(ws) { }
+
+    bool empty() const {
+        return ws.frontier_empty();
+    }
+    void push(Workspace::index_type, Workspace::index_type, Workspace::index_type idx) {
+        ws.push(idx);
+    }
+    std::pair<Workspace::index_type, Workspace::index_type> pop() {
+        return { Workspace::npos, ws.pop() };
+    }
+};
+
+/**
+ * @brief binary heap on `g + h`, ties to the larger `g` (the deeper cell)
+ *
+ */
+class HeapOpen {
+    Workspace& ws;
+
+public:
+    static constexpr bool if_fifo = false;
+
+    explicit HeapOpen(Workspace& ws)
+        : ws(ws) { }
+
+    bool empty() const {
+        return ws.heap_empty();
+    }
+    void push(Workspace::index_type g, Workspace::index_type h, Workspace::index_type idx) {
+        ws.heap_push((static_cast<uint64_t>(g + h) << 32) | (UINT32_MAX - g), idx);
+    }
+    std::pair<Workspace::index_type, Workspace::index_type> pop() {
+        auto [key, idx] = ws.heap_pop();
+        return { static_cast<Workspace::index_type>(UINT32_MAX - (key & UINT32_MAX)), idx };
+    }
+};
+
+/**
+ * @brief bucket queue on `g + h`, each bucket a stack (deeper cells first)
+ *
+ * With unit steps and a consistent heuristic, `g + h` of a pushed cell is
+ *  at most 2 above the lowest one, so a ring of 4 buckets is enough and
+ *  push / pop are O(1).
+ */
+class BucketOpen {
+    static constexpr size_t ring = 4;
+
+    std::array<vector<std::pair<Workspace::index_type, Workspace::index_type>>, ring> buckets = {};
+
+    size_t                count   = 0;
+    Workspace::index_type current = Workspace::npos; /* lowest `g + h` that may be queued */
+
+public:
+    static constexpr bool if_fifo = false;
+
+    explicit BucketOpen(Workspace&) { }
+
+    bool empty() const {
+        return count == 0;
+    }
+    void push(Workspace::index_type g, Workspace::index_type h, Workspace::index_type idx) {
+        const Workspace::index_type key = g + h;
+        if (current == Workspace::npos) {
+            current = key; /* the source */
+        }
+        if (key < current || key - current >= ring) {
+            throw std::logic_error("Bucket open list needs unit steps and a consistent heuristic!");
+        }
+        buckets[key % ring].emplace_back(g, idx);
+        ++count;
+    }
+    std::pair<Workspace::index_type, Workspace::index_type> pop() {
+        while (buckets[current % ring].empty()) {
+            ++current;
+        }
+        auto top = buckets[current % ring].back();
+        buckets[current % ring].pop_back();
+        --count;
+        return top;
+    }
+};
+
+/*
+ * Visited policies: which cells have a tentative distance. The parent of a
+ *  cell always goes to the workspace, which the route is traced from.
+ */
+
+/**
+ * @brief the workspace generation stamps, nothing to clear between searches
+ *
+ */
+class StampVisited {
+    Workspace& ws;
+
+public:
+    StampVisited(Workspace& ws, size_t)
+        : ws(ws) { }
+
+    bool test(Workspace::index_type idx) const {
+        return ws.visited(idx);
+    }
+    void mark(Workspace::index_type idx, Workspace::index_type parent) {
+        ws.visit(idx, parent);
+    }
+};
+
+/**
+ * @brief one bit per cell, 32 times smaller than stamps but cleared per search
+ *
+ * @note pays off when the search stays in cache, e.g. on small mazes
+ */
+class BitsetVisited {
+    Workspace&       ws;
+    vector<uint64_t> bits;
+
+public:
+    BitsetVisited(Workspace& ws, size_t cell_count)
+        : ws(ws)
+        , bits((cell_count + 63) / 64, 0) { }
+
+    bool test(Workspace::index_type idx) const {
+        return (bits[idx / 64] >> (idx % 64)) & 1;
+    }
+    void mark(Workspace::index_type idx, Workspace::index_type parent) {
+        bits[idx / 64] |= uint64_t(1) << (idx % 64);
+        ws.set_parent(idx, parent);
+    }
+};
+
+/*
+ * Heuristic policies: `h(x, y)` estimates the steps left from cell (x, y).
+ *  All of them are consistent on a grid with unit steps.
+ */
+
+/// @brief no estimate, the search is a plain bfs / Dijkstra
+struct NoHeuristic {
+    static constexpr bool if_none = true;
+
+    constexpr Workspace::index_type operator()(size_t, size_t) const {
+        return 0;
+    }
+};
+
+/// @brief manhattan distance to the target
+struct ManhattanHeuristic {
+    static constexpr bool if_none = false;
+
+    size_t target_x = 0;
+    size_t target_y = 0;
+
+    Workspace::index_type operator()(size_t x, size_t y) const {
+        const size_t dx = x > target_x ? x - target_x : target_x - x;
+        const size_t dy = y > target_y ? y - target_y : target_y - y;
+        return static_cast<Workspace::index_type>(dx + dy);
+    }
+};
+
+/**
+ * @brief bfs distances from a few landmark cells, for `AltHeuristic`
+ *
+ * Landmarks are picked farthest-first (each is the cell farthest from all
+ *  landmarks before it), so they sit on the rim of the maze where the
+ *  triangle inequality gives tight bounds. Memory is 4 bytes per cell per
+ *  landmark.
+ */
+class Landmarks {
+public:
+    using index_type = Workspace::index_type;
+
+    static constexpr index_type unreachable = Workspace::npos;
+
+private:
+    size_t                   size      = 0;
+    vector<vector<uint32_t>> distances = {};
+
+    /// @brief bfs from `source` into `dist`, returns the farthest cell
+    static index_type fill(
+        std::span<const uint8_t> cells,
+        size_t                   size,
+        index_type               source,
+        vector<uint32_t>&        dist,
+        Workspace&               ws
+    ) {
+        dist.assign(cells.size(), unreachable);
+        ws.begin(cells.size());
+        ws.visit(source, source);
+        ws.push(source);
+        dist[source]        = 0;
+        index_type farthest = source;
+        while (!ws.frontier_empty()) {
+            const index_type from = ws.pop();
+            farthest              = from;
+            const size_t x        = from / size;
+            const size_t y        = from % size;
+            auto relax            = [&](bool if_inside, index_type to) {
+                if (if_inside && cells[to] && !ws.visited(to)) {
+                    ws.visit(to, from);
+                    ws.push(to);
+                    dist[to] = dist[from] + 1;
+                }
+            };
+            relax(x > 0, static_cast<index_type>(from - size));
+            relax(x + 1 < size, static_cast<index_type>(from + size));
+            relax(y > 0, from - 1);
+            relax(y + 1 < size, from + 1);
+        }
+        return farthest;
+    }
+
+public:
+    /**
+     * @brief Default constructor (no landmark)
+     *
+     */
+    Landmarks() = default;
+
+    /**
+     * @brief pick `count` landmarks in the component of `seed`
+     *
+     * @param cells  flat row-major grid, non-zero for path
+     * @note O(count * cells)
+     */
+    static Landmarks pick(
+        std::span<const uint8_t> cells,
+        size_t                   size,
+        index_type               seed,
+        size_t                   count
+    ) {
+        Landmarks ret;
+        ret.size = size;
+
+        Workspace        ws;
+        vector<uint32_t> nearest; /* distance to the closest landmark so far */
+        vector<uint32_t> scratch;
+        index_type       next = fill(cells, size, seed, scratch, ws);
+        for (size_t k = 0; k < count; ++k) {
+            ret.distances.emplace_back();
+            fill(cells, size, next, ret.distances.back(), ws);
+            const auto& dist = ret.distances.back();
+            if (nearest.empty()) {
+                nearest = dist;
+            } else {
+                std::transform(nearest.begin(), nearest.end(), dist.begin(), nearest.begin(), [](uint32_t lhs, uint32_t rhs) {
+                    return std::min(lhs, rhs);
+                });
+            }
+            // farthest from every landmark (unreachable cells don't count)
+            uint32_t best = 0;
+            for (size_t idx = 0; idx < nearest.size(); ++idx) {
+                if (nearest[idx] != unreachable && nearest[idx] > best) {
+                    best = nearest[idx];
+                    next = static_cast<index_type>(idx);
+                }
+            }
+        }
+        return ret;
+    }
+
+    bool empty() const {
+        return distances.empty();
+    }
+    size_t get_size() const {
+        return size;
+    }
+    const vector<vector<uint32_t>>& get_distances() const {
+        return distances;
+    }
+};
+
+/**
+ * @brief ALT: the best triangle-inequality bound over the landmarks
+ *
+ * `|d(L, target) - d(L, cell)|` never exceeds `d(cell, target)`, and it's
+ *  far tighter than manhattan when walls force long detours.
+ */
+class AltHeuristic {
+    const Landmarks* landmarks = nullptr;
+    vector<uint32_t> to_target = {};
+
+public:
+    static constexpr bool if_none = false;
+
+    AltHeuristic(const Landmarks& landmarks, Workspace::index_type target)
+        : landmarks(&landmarks) {
+        for (const auto& dist : landmarks.get_distances()) {
+            to_target.push_back(dist[target]);
+        }
+    }
+
+    Workspace::index_type operator()(size_t x, size_t y) const {
+        const size_t          idx = x * landmarks->get_size() + y;
+        Workspace::index_type ret = 0;
+        const auto&           all = landmarks->get_distances();
+        for (size_t k = 0; k < all.size(); ++k) {
+            const uint32_t here = all[k][idx];
+            if (here == Landmarks::unreachable || to_target[k] == Landmarks::unreachable) {
+                continue;
+            }
+            ret = std::max(ret, here > to_target[k] ? here - to_target[k] : to_target[k] - here);
+        }
+        return ret;
+    }
+};
+
+/**
+ * @brief best-first search from `entry` to `exit` over `grid_cells` laid out
+ *      by `grid`, asking `if_continue(expanded)` after every expanded cell
+ *
+ * Every policy is a template parameter, so each combination compiles to its
+ *  own loop with the policy calls inlined: `FifoOpen` + `NoHeuristic` is a
+ *  plain bfs, `HeapOpen` + `ManhattanHeuristic` is a*, and so on. The route
+ *  (or, when stopped, the route to the expanded cell closest to `exit`) is
+ *  left in `ws` as row-major indices.
+ *
+ * @param size  side of the maze, for the row-major route
+ * @attention entry and exit must be connected open cells (see `Components`)
+ */
+template <class Open, class Visited, class Grid, class Heuristic, class Monitor>
+MAZE_FLATTEN search_status grid_search(
+    const Grid&               grid,
+    std::span<const uint8_t>  grid_cells,
+    size_t                    size,
+    Workspace&                ws,
+    std::pair<size_t, size_t> entry,
+    std::pair<size_t, size_t> exit,
+    const Heuristic&          heuristic,
+    Monitor&&                 if_continue
+) {
+    using index_type = Workspace::index_type;
+
+    static_assert(!Open::if_fifo || Heuristic::if_none, "A FIFO open list cannot follow a heuristic");
+    static constexpr bool if_monitored
+        = !std::is_same_v<std::decay_t<Monitor>, no_monitor>;
+
+    const index_type source = grid.to_index(entry.first, entry.second);
+    const index_type target = grid.to_index(exit.first, exit.second);
+
+    auto estimate = [&](index_type idx) -> index_type {
+        if constexpr (Heuristic::if_none) {
+            return 0;
+        } else {
+            auto [x, y] = grid.to_xy(idx);
+            return heuristic(x, y);
+        }
+    };
+    auto trace_to = [&](index_type cell) {
+        ws.trace(source, cell);
+        if constexpr (Grid::tag != layout::row_major) {
+            ws.remap_route([&](index_type idx) {
+                auto [x, y] = grid.to_xy(idx);
+                return static_cast<index_type>(x * size + y);
+            });
+        }
+    };
+
+    ws.begin(grid.cell_count());
+    Open    open { ws };
+    Visited visited { ws, grid.cell_count() };
+
+    visited.mark(source, source);
+    if constexpr (!Open::if_fifo) {
+        ws.set_distance(source, 0); /* bfs needs no distance, only the order */
+    }
+    open.push(0, estimate(source), source);
+
+    index_type best     = source;
+    index_type best_h   = ManhattanHeuristic { exit.first, exit.second }(entry.first, entry.second);
+    size_t     expanded = 0;
+
+    while (!open.empty()) {
+        auto [g, from] = open.pop();
+        if constexpr (!Open::if_fifo) {
+            if (g != ws.get_distance(from)) {
+                continue; /* stale, `from` was reached cheaper since */
+            }
+        }
+        if (from == target) {
+            trace_to(target);
+            return search_status::found;
+        }
+        if constexpr (if_monitored) {
+            auto [x, y]       = grid.to_xy(from);
+            index_type h_cost = ManhattanHeuristic { exit.first, exit.second }(x, y);
+            if (h_cost < best_h) {
+                best   = from;
+                best_h = h_cost;
+            }
+            if (!if_continue(++expanded)) {
+                trace_to(best);
+                return search_status::stopped;
+            }
+        }
+        grid.for_each_adj(grid_cells, from, [&](index_type to) {
+            if constexpr (Open::if_fifo) {
+                if (visited.test(to)) {
+                    return; /* bfs: the first visit is the shortest */
+                }
+                visited.mark(to, from);
+                open.push(0, 0, to);
+            } else {
+                if (visited.test(to) && ws.get_distance(to) <= g + 1) {
+                    return;
+                }
+                visited.mark(to, from);
+                ws.set_distance(to, g + 1);
+                open.push(g + 1, estimate(to), to);
+            }
+        });
+    }
+
+    // if reached here, no route found
+    return search_status::no_route;
+}
+
+} // namespace Utility
@@ -0,0 +1,244 @@
+/**
+ * @file SolverSelection.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Pick the solver expected to be fastest from cheap features of a maze
+ * @version 0.1
+ * @date 2023-01-29
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "Maze.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace Utility {
+
+/**
+ * @brief features of a maze, sampled in O(samples) once it's loaded
+ *
+ */
+struct MazeFeatures {
+    size_t size = 0;
+
+    /// @brief share of open cells
+    double density = 0;
+
+    /// @brief share of open cells with 3 or 4 open neighbours
+    double junction_ratio = 0;
+
+    /// @brief estimated cells per corridor between two junctions / dead ends
+    double corridor_length = 0;
+
+    /// @brief one route between any two cells (known since `Maze::set`)
+    bool perfect = false;
+
+    /**
+     * @brief look at `samples` random cells of `maze` (all of them if fewer)
+     *
+     */
+    static MazeFeatures sample(const Maze& maze, size_t samples = 4096, uint64_t seed = 20230129) {
+        MazeFeatures ret;
+        ret.size    = maze.get_size();
+        ret.perfect = maze.is_perfect();
+
+        const auto   cells = maze.get_cells();
+        const size_t size  = ret.size;
+        if (cells.empty()) {
+            return ret;
+        }
+        std::mt19937_64 rng(seed);
+        const bool      if_all = samples >= cells.size();
+        const size_t    count  = if_all ? cells.size() : samples;
+
+        size_t open = 0, junctions = 0, passages = 0, ends = 0;
+        for (size_t k = 0; k < count; ++k) {
+            const size_t idx = if_all ? k : rng() % cells.size();
+            if (!cells[idx]) {
+                continue;
+            }
+            ++open;
+            const size_t x      = idx / size;
+            const size_t y      = idx % size;
+            const size_t degree = (x > 0 && cells[idx - size]) + (x + 1 < size && cells[idx + size])
+                                + (y > 0 && cells[idx - 1]) + (y + 1 < size && cells[idx + 1]);
+            if (degree == 2) {
+                ++passages;
+            } else {
+                ends += degree; /* every corridor has two ends */
+                junctions += degree >= 3;
+            }
+        }
+        ret.density         = static_cast<double>(open) / static_cast<double>(count);
+        ret.junction_ratio  = open == 0 ? 0 : static_cast<double>(junctions) / static_cast<double>(open);
+        ret.corridor_length = static_cast<double>(passages) / std::max(1.0, static_cast<double>(ends) / 2);
+        return ret;
+    }
+};
+
+/// @brief the solvers an `AdaptiveSolver` picks from, all returning shortest routes
+enum class selected_solver {
+    tree,   /* perfect mazes: read off the spanning tree */
+    bfs,    /* winding corridors, where manhattan misleads a* */
+    a_star, /* open areas, where manhattan is close to the distance */
+    alt,    /* many queries: landmarks built once, a* guided by them */
+};
+
+inline std::string_view name_of(selected_solver solver) {
+    switch (solver) {
+    case selected_solver::tree:
+        return "tree";
+    case selected_solver::bfs:
+        return "bfs";
+    case selected_solver::a_star:
+        return "a*";
+    default:
+        return "alt";
+    }
+}
+
+/**
+ * @brief a row of the selection table: `solver` if `applies`
+ *
+ */
+struct SelectionRule {
+    selected_solver solver;
+    bool (*applies)(const MazeFeatures&, size_t expected_queries);
+    std::string_view reason;
+};
+
+/*
+ * Calibrated with `Test::SelectionBenchmark` (average of random queries on
+ *  the workload corpus, 201 to 2001 cells per side):
+ *
+ *  - tree routes are 20-80x faster than any search on perfect mazes;
+ *  - alt is the fastest search everywhere (2-6x under bfs), but its 4
+ *    landmark sweeps cost about 15 bfs queries and 16 bytes per cell, and
+ *    only pay back after some 20 queries;
+ *  - a* beats bfs 2-4x once a maze is mostly open (density >= 0.6, or many
+ *    junctions and corridors under 2 cells), and loses 1.5-2x to it in
+ *    corridors (braided mazes: density ~0.53, corridors ~6 cells);
+ *  - under ~64k cells, every solver answers in well under a millisecond.
+ *
+ * First match wins, the last row always applies.
+ */
+inline constexpr SelectionRule selection_rules[] = {
+    {
+        selected_solver::tree,
+        [](const MazeFeatures& features, size_t) { return features.perfect; },
+        "perfect maze: the route is read off the spanning tree, no search",
+    },
+    {
+        selected_solver::bfs,
+        [](const MazeFeatures& features, size_t) { return features.size * features.size < (size_t(1) << 16); },
+        "small maze: every search is sub-millisecond, bfs has the least overhead",
+    },
+    {
+        selected_solver::alt,
+        [](const MazeFeatures&, size_t expected_queries) { return expected_queries >= 32; },
+        "many queries: the landmark sweeps pay back, alt explores the fewest cells",
+    },
+    {
+        selected_solver::a_star,
+        [](const MazeFeatures& features, size_t) {
+            return features.density >= 0.6 || (features.junction_ratio >= 0.2 && features.corridor_length < 2);
+        },
+        "open areas: manhattan is close to the true distance",
+    },
+    {
+        selected_solver::bfs,
+        [](const MazeFeatures&, size_t) { return true; },
+        "corridors: manhattan misleads a*, bfs has the cheapest expansions",
+    },
+};
+
+/**
+ * @brief the solver picked for a maze, and why
+ *
+ */
+struct SolverChoice {
+    selected_solver  solver   = selected_solver::bfs;
+    std::string_view reason   = {};
+    MazeFeatures     features = {};
+
+    /// @brief one line for the log
+    std::string describe() const {
+        std::ostringstream out;
+        out << name_of(solver) << " (" << reason << "; "
+            << features.size << " x " << features.size
+            << ", density " << features.density
+            << ", junctions " << features.junction_ratio
+            << ", corridor ~" << features.corridor_length
+            << (features.perfect ? ", perfect" : "") << ")";
+        return out.str();
+    }
+};
+
+/**
+ * @brief first rule of `selection_rules` applying to `features`
+ *
+ * @param expected_queries  queries the maze will answer before it changes
+ */
+inline SolverChoice choose_solver(const MazeFeatures& features, size_t expected_queries = 1) {
+    for (const auto& rule : selection_rules) {
+        if (rule.applies(features, expected_queries)) {
+            return { rule.solver, rule.reason, features };
+        }
+    }
+    return { selected_solver::bfs, "no rule applies", features };
+}
+
+/**
+ * @brief answer every query of a maze with the solver chosen when loading it
+ *
+ * @note holds `maze` mutably: if `alt` is chosen, the constructor prepares
+ *      its landmarks, replacing any others. Constructing one is not
+ *      thread-safe, nothing else may use `maze` meanwhile. `route` only
+ *      reads it, and may run on several threads (a `Workspace` each) as long
+ *      as `maze` stays alive and unchanged
+ */
+class AdaptiveSolver {
+    Maze&        maze;
+    SolverChoice choice;
+
+public:
+    explicit AdaptiveSolver(Maze& maze, size_t expected_queries = 1)
+        : maze(maze)
+        , choice(choose_solver(MazeFeatures::sample(maze), expected_queries)) {
+        if (choice.solver == selected_solver::alt) {
+            maze.prepare_landmarks();
+        }
+    }
+
+    const SolverChoice& get_choice() const {
+        return choice;
+    }
+
+    /**
+     * @brief shortest route from `entry` to `exit` into `ws`
+     *
+     * @return true if a route exists
+     */
+    bool route(Workspace& ws, const coordinate& entry, const coordinate& exit) const {
+        switch (choice.solver) {
+        case selected_solver::tree:
+            return maze.tree_route(ws, entry, exit);
+        case selected_solver::a_star:
+            return maze.a_star_route(ws, entry, exit);
+        case selected_solver::alt:
+            return maze.alt_route(ws, entry, exit);
+        default:
+            return maze.bfs_route(ws, entry, exit);
+        }
+    }
+};
+
+} // namespace Utility
@@ -0,0 +1,193 @@
+/**
+ * @file StaticMaze.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Mazes generated and solved at compile time, for test fixtures
+ * @version 0.1
+ * @date 2023-01-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "Maze.hpp"
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+namespace Utility {
+
+/**
+ * @brief splitmix64, small enough to run inside constant evaluation
+ *
+ */
+class StaticRandom {
+    uint64_t state = 0;
+
+public:
+    constexpr explicit StaticRandom(uint64_t seed)
+        : state(seed) { }
+
+    constexpr uint64_t next() {
+        uint64_t value = (state += 0x9E3779B97F4A7C15);
+        value          = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+        value          = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+        return value ^ (value >> 31);
+    }
+    /// @brief in [0, bound), the bias is negligible for small bounds
+    constexpr size_t below(size_t bound) {
+        return static_cast<size_t>(next() % bound);
+    }
+};
+
+/**
+ * @brief `Size` x `Size` maze held in a `std::array`, a literal type
+ *
+ * `generate` carves the same kind of maze as `Generator` (cells on even
+ *  coordinates, a random dfs, entry on the left border, exit where the dfs
+ *  carved last), but from a seed and inside constant evaluation, so
+ *
+ *      constexpr auto fixture = StaticMaze<23>::generate(1);
+ *      static_assert(fixture.route_length() > 0);
+ *
+ *  puts the maze in read-only data, already checked to be solvable. Fixtures
+ *  cost nothing at startup and never touch `MazeData.txt`.
+ *
+ * @note `generate` keeps its dfs stack in a `std::array` too, compilers limit
+ *      constant evaluation, a few hundred cells per side is about the most
+ */
+template <size_t Size>
+class StaticMaze {
+public:
+    static constexpr size_t size  = Size;
+    static constexpr size_t cells = Size * Size;
+
+    static_assert(Size % 2 == 1, "StaticMaze size must be odd");
+
+    /// @brief 0 for wall, 1 for path, row-major
+    std::array<uint8_t, cells> data = {};
+
+    coordinate entry = { -1, -1 };
+    coordinate exit  = { -1, -1 };
+
+private:
+    static constexpr size_t rooms = (Size + 1) / 2; /* cells per side */
+
+    static constexpr size_t to_index(const coordinate& cord) {
+        return static_cast<size_t>(cord.first) * Size + static_cast<size_t>(cord.second);
+    }
+
+public:
+    /**
+     * @brief the maze of `seed` (same seed, same maze, on every compiler)
+     *
+     */
+    static constexpr StaticMaze generate(uint64_t seed) {
+        constexpr std::array<std::pair<int, int>, 4> steps = { {
+            { -2, 0 },
+            { 2, 0 },
+            { 0, -2 },
+            { 0, 2 },
+        } };
+
+        StaticMaze   ret;
+        StaticRandom rng { seed };
+
+        ret.entry = { static_cast<int>(2 * rng.below(rooms)), 0 };
+        ret.exit  = ret.entry;
+        ret.data[to_index(ret.entry)] = 1;
+
+        std::array<coordinate, rooms * rooms> stack = {};
+        size_t                                top   = 0;
+        stack[top++]                                = ret.entry;
+        while (top != 0) {
+            auto [x, y] = stack[top - 1];
+
+            std::array<coordinate, 4> neighbors = {};
+            size_t                    count     = 0;
+            for (auto [dx, dy] : steps) {
+                const int nx = x + dx;
+                const int ny = y + dy;
+                if (nx >= 0 && nx < static_cast<int>(Size) && ny >= 0 && ny < static_cast<int>(Size)
+                    && ret.data[to_index({ nx, ny })] == 0) {
+                    neighbors[count++] = { nx, ny };
+                }
+            }
+            if (count == 0) {
+                --top;
+                continue;
+            }
+            const coordinate chosen = neighbors[rng.below(count)];
+            ret.data[to_index({ (x + chosen.first) / 2, (y + chosen.second) / 2 })] = 1;
+            ret.data[to_index(chosen)]                                           = 1;
+            stack[top++]                                                         = chosen;
+            ret.exit                                                             = chosen;
+        }
+        return ret;
+    }
+
+    constexpr bool is_open(int x, int y) const {
+        return x >= 0 && x < static_cast<int>(Size) && y >= 0 && y < static_cast<int>(Size)
+            && data[to_index({ x, y })] != 0;
+    }
+
+    /**
+     * @brief `bfs` from `from` to `to` in constant evaluation
+     *
+     * @return number of cells on a shortest route, 0 if there's none
+     */
+    constexpr size_t route_length(const coordinate& from, const coordinate& to) const {
+        if (!is_open(from.first, from.second) || !is_open(to.first, to.second)) {
+            return 0;
+        }
+        std::array<uint32_t, cells> distance = {}; /* steps + 1, 0 for unvisited */
+        std::array<uint32_t, cells> queue    = {};
+        size_t                      head     = 0;
+        size_t                      tail     = 0;
+
+        queue[tail++]           = static_cast<uint32_t>(to_index(from));
+        distance[queue[0]]      = 1;
+        const size_t target     = to_index(to);
+        while (head != tail) {
+            const uint32_t idx = queue[head++];
+            if (idx == target) {
+                return distance[idx];
+            }
+            const int x = static_cast<int>(idx / Size);
+            const int y = static_cast<int>(idx % Size);
+            for (auto [nx, ny] : { coordinate { x - 1, y },
+                                   coordinate { x + 1, y },
+                                   coordinate { x, y - 1 },
+                                   coordinate { x, y + 1 } }) {
+                if (is_open(nx, ny) && distance[to_index({ nx, ny })] == 0) {
+                    distance[to_index({ nx, ny })] = distance[idx] + 1;
+                    queue[tail++]                  = static_cast<uint32_t>(to_index({ nx, ny }));
+                }
+            }
+        }
+
+        // if reached here, no route found
+        return 0;
+    }
+    constexpr size_t route_length() const {
+        return route_length(entry, exit);
+    }
+
+    /**
+     * @brief the cells as a matrix, e.g. for `Maze::create`
+     *
+     */
+    matrix<int> to_matrix() const {
+        matrix<int> ret(Size, vector<int>(Size, 0));
+        for (size_t i = 0; i < Size; ++i) {
+            for (size_t j = 0; j < Size; ++j) {
+                ret[i][j] = data[i * Size + j];
+            }
+        }
+        return ret;
+    }
+};
+
+} // namespace Utility
@@ -0,0 +1,208 @@
+/**
+ * @file TiledGrid.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Maze on disk in fixed-size square tiles, read through an LRU cache
+ * @version 0.1
+ * @date 2023-01-15
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "GridFile.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Utility {
+
+using std::vector;
+
+/**
+ * @brief square maze stored tile after tile, one byte per cell
+ *
+ * Cells are addressed by a tile-major `key`: all cells of a tile are
+ *  consecutive, so sorting keys groups them by tile. Cells past the edge of
+ *  the maze (padding of the last row / column of tiles) are walls.
+ */
+class TiledGrid {
+public:
+    struct Header {
+        char     magic[8]   = { 'M', 'A', 'Z', 'E', 'T', 'I', 'L', 'E' };
+        uint32_t version    = 1;
+        uint32_t tile_size  = 0;
+        uint64_t size       = 0;
+        uint64_t tiles_side = 0;
+    };
+
+private:
+    Header header = {};
+
+    std::ifstream file      = {};
+    size_t        max_tiles = 1;
+
+    /* LRU cache of tiles, front is the most recently used */
+    using tile_bytes = std::unique_ptr<uint8_t[]>;
+    std::list<std::pair<uint64_t, tile_bytes>> lru = {};
+    std::unordered_map<
+        uint64_t,
+        std::list<std::pair<uint64_t, tile_bytes>>::iterator>
+        cached = {};
+
+    uint64_t hits   = 0;
+    uint64_t misses = 0;
+
+    size_t tile_cells() const {
+        return static_cast<size_t>(header.tile_size) * header.tile_size;
+    }
+    const uint8_t* load(uint64_t tile) {
+        if (auto it = cached.find(tile); it != cached.end()) {
+            ++hits;
+            lru.splice(lru.begin(), lru, it->second);
+            return it->second->second.get();
+        }
+        ++misses;
+        tile_bytes bytes;
+        if (lru.size() >= max_tiles) {
+            // recycle the least recently used buffer
+            bytes = std::move(lru.back().second);
+            cached.erase(lru.back().first);
+            lru.pop_back();
+        } else {
+            bytes = std::make_unique<uint8_t[]>(tile_cells());
+        }
+        file.seekg(static_cast<std::streamoff>(sizeof(Header) + tile * tile_cells()));
+        file.read(reinterpret_cast<char*>(bytes.get()), static_cast<std::streamsize>(tile_cells()));
+        if (!file.good()) {
+            throw std::runtime_error("Cannot read tile!");
+        }
+        lru.emplace_front(tile, std::move(bytes));
+        cached[tile] = lru.begin();
+        return lru.front().second.get();
+    }
+
+public:
+    /**
+     * @brief tile a row-major grid into `output`, one band of rows at a time
+     *
+     * @param cells      row-major cells (e.g. of a mapped `GridFile`)
+     * @param size
+     * @param tile_size
+     * @param output
+     */
+    static void build(
+        std::span<const uint8_t>     cells,
+        uint64_t                     size,
+        uint32_t                     tile_size,
+        const std::filesystem::path& output
+    ) {
+        if (tile_size == 0) {
+            throw std::invalid_argument("Tile size cannot be 0!");
+        }
+        Header header;
+        header.tile_size  = tile_size;
+        header.size       = size;
+        header.tiles_side = (size + tile_size - 1) / tile_size;
+
+        std::ofstream file { output, std::ios::binary | std::ios::trunc };
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot create tiled grid file!");
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        vector<char> tile(static_cast<size_t>(tile_size) * tile_size);
+        for (uint64_t ti = 0; ti < header.tiles_side; ++ti) {
+            for (uint64_t tj = 0; tj < header.tiles_side; ++tj) {
+                std::fill(tile.begin(), tile.end(), 0);
+                for (uint64_t r = 0; r < tile_size; ++r) {
+                    uint64_t x = ti * tile_size + r;
+                    for (uint64_t c = 0; x < size && c < tile_size; ++c) {
+                        uint64_t y = tj * tile_size + c;
+                        if (y < size) {
+                            tile[r * tile_size + c] = cells[x * size + y] & GridFile::open_bit;
+                        }
+                    }
+                }
+                file.write(tile.data(), static_cast<std::streamsize>(tile.size()));
+            }
+        }
+        if (!file.good()) {
+            throw std::runtime_error("Cannot write tiled grid file!");
+        }
+    }
+
+    /**
+     * @brief open a tiled grid, caching at most `memory_cap` bytes of tiles
+     *
+     * @throw std::invalid_argument if `memory_cap` cannot hold one tile
+     */
+    TiledGrid(const std::filesystem::path& path, size_t memory_cap)
+        : file(path, std::ios::binary) {
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open tiled grid file!");
+        }
+        file.read(reinterpret_cast<char*>(&header), sizeof(Header));
+        if (!file.good()
+            || std::memcmp(header.magic, Header {}.magic, sizeof(Header::magic)) != 0
+            || header.version != Header {}.version
+            || header.tile_size == 0) {
+            throw std::runtime_error("Not a tiled grid file!");
+        }
+        if (memory_cap < tile_cells()) {
+            throw std::invalid_argument("Memory cap of tiled grid is below one tile!");
+        }
+        max_tiles = memory_cap / tile_cells();
+    }
+
+    uint64_t get_size() const {
+        return header.size;
+    }
+    uint64_t get_hits() const {
+        return hits;
+    }
+    uint64_t get_misses() const {
+        return misses;
+    }
+
+    /* tile-major keys */
+
+    uint64_t to_key(uint64_t x, uint64_t y) const {
+        const uint64_t t    = header.tile_size;
+        const uint64_t tile = (x / t) * header.tiles_side + y / t;
+        return tile * tile_cells() + (x % t) * t + y % t;
+    }
+    std::pair<uint64_t, uint64_t> to_xy(uint64_t key) const {
+        const uint64_t t      = header.tile_size;
+        const uint64_t tile   = key / tile_cells();
+        const uint64_t offset = key % tile_cells();
+        return {
+            (tile / header.tiles_side) * t + offset / t,
+            (tile % header.tiles_side) * t + offset % t,
+        };
+    }
+    uint64_t tile_of(uint64_t key) const {
+        return key / tile_cells();
+    }
+
+    /**
+     * @brief whether the cell at `key` is path (loads its tile if needed)
+     *
+     */
+    bool is_open(uint64_t key) {
+        return load(tile_of(key))[key % tile_cells()] != 0;
+    }
+};
+
+} // namespace Utility
@@ -0,0 +1,368 @@
+/**
+ * @file TraceReplay.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Replay a trace of route queries, open or closed loop, with latencies
+ * @version 0.1
+ * @date 2023-01-23
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "LatencyHistogram.hpp"
+#include "Maze.hpp"
+#include "Workspace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Utility {
+
+using std::vector;
+
+/// @brief solver a trace record asks for
+enum class trace_algorithm {
+    bfs,
+    a_star,
+    bidirectional,
+    tree, /* `Maze::tree_route`, falls back to bfs on mazes with loops */
+};
+
+inline const char* name_of(trace_algorithm algorithm) {
+    switch (algorithm) {
+    case trace_algorithm::bfs:
+        return "bfs";
+    case trace_algorithm::a_star:
+        return "a_star";
+    case trace_algorithm::bidirectional:
+        return "bidirectional";
+    default:
+        return "tree";
+    }
+}
+
+/**
+ * @brief one query of a trace, `maze` is the index into the trace's mazes
+ *
+ */
+struct TraceRecord {
+    uint32_t        maze      = 0;
+    coordinate      entry     = { -1, -1 };
+    coordinate      exit      = { -1, -1 };
+    trace_algorithm algorithm = trace_algorithm::bfs;
+};
+
+/**
+ * @brief the grid files a trace runs on, and its queries in order
+ *
+ * Stored as text, one item per line, `#` starts a comment:
+ *
+ *      maze <id> <grid file>
+ *      query <maze id> <entry x> <entry y> <exit x> <exit y> <algorithm>
+ *
+ * Maze ids are 0, 1, ... in order. Grid paths are relative to the trace.
+ */
+struct Trace {
+    vector<std::filesystem::path> grids   = {};
+    vector<TraceRecord>           records = {};
+
+    static Trace read(const std::filesystem::path& path) {
+        std::ifstream file { path };
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open trace file!");
+        }
+        Trace       ret;
+        std::string line;
+        while (std::getline(file, line)) {
+            line = line.substr(0, line.find('#'));
+            std::istringstream in { line };
+            std::string        kind;
+            if (!(in >> kind)) {
+                continue; /* blank or comment */
+            }
+            if (kind == "maze") {
+                size_t      id = 0;
+                std::string grid;
+                if (!(in >> id >> std::quoted(grid)) || id != ret.grids.size()) {
+                    throw std::runtime_error("Bad maze line in trace: " + line);
+                }
+                ret.grids.push_back(path.parent_path() / grid);
+                continue;
+            }
+            TraceRecord record;
+            std::string algorithm;
+            if (kind != "query"
+                || !(in >> record.maze
+                     >> record.entry.first >> record.entry.second
+                     >> record.exit.first >> record.exit.second
+                     >> algorithm)
+                || record.maze >= ret.grids.size()) {
+                throw std::runtime_error("Bad query line in trace: " + line);
+            }
+            record.algorithm = parse_algorithm(algorithm);
+            ret.records.push_back(record);
+        }
+        return ret;
+    }
+
+    /// @note `grids` are written relative to the trace when possible
+    void write(const std::filesystem::path& path) const {
+        std::ofstream file { path, std::ios::trunc };
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot create trace file!");
+        }
+        file << "# maze <id> <grid file>" << std::endl;
+        file << "# query <maze id> <entry x> <entry y> <exit x> <exit y> <algorithm>" << std::endl;
+        for (size_t id = 0; id < grids.size(); ++id) {
+            auto relative = grids[id].lexically_proximate(path.parent_path());
+            file << "maze " << id << " " << std::quoted(relative.string()) << "\n";
+        }
+        for (const auto& record : records) {
+            file << "query " << record.maze
+                 << " " << record.entry.first << " " << record.entry.second
+                 << " " << record.exit.first << " " << record.exit.second
+                 << " " << name_of(record.algorithm) << "\n";
+        }
+    }
+
+    static trace_algorithm parse_algorithm(const std::string& name) {
+        for (auto algorithm : { trace_algorithm::bfs,
+                                trace_algorithm::a_star,
+                                trace_algorithm::bidirectional,
+                                trace_algorithm::tree }) {
+            if (name == name_of(algorithm)) {
+                return algorithm;
+            }
+        }
+        throw std::runtime_error("Unknown algorithm in trace: " + name);
+    }
+};
+
+/**
+ * @brief `count` queries between random open cells of `mazes`, the
+ *      algorithms drawn from `mix` (repeat one to weight it)
+ *
+ * @note endpoints are uniform over the open cells of each maze, the maze of
+ *      a query is uniform over `mazes`; the same seed gives the same trace
+ */
+inline vector<TraceRecord> synthesize_trace(
+    std::span<const std::shared_ptr<const Maze>> mazes,
+    size_t                                       count,
+    uint64_t                                     seed,
+    std::span<const trace_algorithm>             mix
+) {
+    if (mazes.empty() || mix.empty()) {
+        throw std::invalid_argument("A trace needs mazes and algorithms!");
+    }
+    std::mt19937_64        rng(seed);
+    vector<vector<uint32_t>> open(mazes.size());
+    for (size_t m = 0; m < mazes.size(); ++m) {
+        auto cells = mazes[m]->get_cells();
+        for (size_t idx = 0; idx < cells.size(); ++idx) {
+            if (cells[idx]) {
+                open[m].push_back(static_cast<uint32_t>(idx));
+            }
+        }
+        if (open[m].empty()) {
+            throw std::invalid_argument("A maze of the trace has no open cell!");
+        }
+    }
+
+    vector<TraceRecord> ret(count);
+    for (auto& record : ret) {
+        record.maze      = static_cast<uint32_t>(rng() % mazes.size());
+        const auto& maze = *mazes[record.maze];
+        const auto& pool = open[record.maze];
+        record.entry     = maze.to_coordinate(pool[rng() % pool.size()]);
+        record.exit      = maze.to_coordinate(pool[rng() % pool.size()]);
+        record.algorithm = mix[rng() % mix.size()];
+    }
+    return ret;
+}
+
+/**
+ * @brief how a trace is replayed
+ *
+ */
+struct ReplayConfig {
+    /// @brief 0 for one per hardware thread
+    size_t threads = 1;
+
+    /// @brief queries per second across all threads (open loop), 0 to send
+    ///     each query as soon as a thread is free (closed loop)
+    double rate = 0;
+
+    /// @brief times the whole trace is replayed
+    size_t repeat = 1;
+};
+
+/**
+ * @brief latencies and throughput of a replay
+ *
+ * @note in open loop a latency runs from when the query was due, not from
+ *      when a thread got to it, so falling behind the rate shows up in the
+ *      tail instead of being hidden (no coordinated omission)
+ */
+struct ReplayReport {
+    size_t queries = 0;
+    size_t found   = 0;
+    size_t threads = 0;
+    double rate    = 0;
+    double seconds = 0;
+
+    /// @brief nanoseconds
+    LatencyHistogram latency = {};
+
+    double throughput() const {
+        return seconds > 0 ? static_cast<double>(queries) / seconds : 0;
+    }
+
+    /**
+     * @brief one JSON object, latencies in microseconds
+     *
+     */
+    std::string to_json() const {
+        auto us = [this](double percentile) {
+            return static_cast<double>(latency.value_at(percentile)) / 1000;
+        };
+        std::ostringstream out;
+        out << "{"
+            << "\"queries\": " << queries
+            << ", \"found\": " << found
+            << ", \"threads\": " << threads
+            << ", \"rate\": " << rate
+            << ", \"seconds\": " << seconds
+            << ", \"throughput\": " << throughput()
+            << ", \"latency_us\": {"
+            << "\"min\": " << static_cast<double>(latency.min()) / 1000
+            << ", \"mean\": " << latency.mean() / 1000
+            << ", \"p50\": " << us(50)
+            << ", \"p90\": " << us(90)
+            << ", \"p99\": " << us(99)
+            << ", \"p999\": " << us(99.9)
+            << ", \"max\": " << static_cast<double>(latency.max()) / 1000
+            << "}}";
+        return out.str();
+    }
+};
+
+/**
+ * @brief replay queries on const mazes from several threads
+ *
+ * Threads claim queries from one atomic counter and solve them with the
+ *  const `*_route` APIs inside their own workspaces, so nothing is shared
+ *  but the counter and the mazes. Each thread keeps its own histogram, they
+ *  are merged at the end.
+ */
+class TraceReplayer {
+    using clock = std::chrono::steady_clock;
+
+    struct Worker {
+        Workspace        ws      = {};
+        Workspace        back    = {}; /* second side of bidirectional */
+        LatencyHistogram latency = {};
+        size_t           found   = 0;
+    };
+
+    static bool solve(const Maze& maze, const TraceRecord& record, Worker& worker) {
+        switch (record.algorithm) {
+        case trace_algorithm::a_star:
+            return maze.a_star_route(worker.ws, record.entry, record.exit);
+        case trace_algorithm::bidirectional:
+            return maze.bidirectional_route(worker.ws, worker.back, record.entry, record.exit);
+        case trace_algorithm::tree:
+            return maze.tree_route(worker.ws, record.entry, record.exit);
+        default:
+            return maze.bfs_route(worker.ws, record.entry, record.exit);
+        }
+    }
+
+    static bool if_inside(const Maze& maze, const coordinate& cord) {
+        const auto size = static_cast<int>(maze.get_size());
+        return cord.first >= 0 && cord.first < size && cord.second >= 0 && cord.second < size;
+    }
+
+public:
+    /**
+     * @brief replay `records` on `mazes` (query `maze` ids index `mazes`)
+     *
+     * @throw std::invalid_argument if a query is out of its maze
+     */
+    static ReplayReport replay(
+        std::span<const std::shared_ptr<const Maze>> mazes,
+        std::span<const TraceRecord>                 records,
+        const ReplayConfig&                          config = {}
+    ) {
+        for (const auto& record : records) {
+            if (record.maze >= mazes.size()
+                || !if_inside(*mazes[record.maze], record.entry)
+                || !if_inside(*mazes[record.maze], record.exit)) {
+                throw std::invalid_argument("Trace query is out of its maze!");
+            }
+        }
+        size_t threads = config.threads;
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        const size_t total = records.size() * config.repeat;
+
+        vector<Worker>      workers(threads);
+        std::atomic<size_t> next = 0;
+
+        const auto start = clock::now();
+        auto       due   = [&](size_t i) {
+            const std::chrono::duration<double> offset { static_cast<double>(i) / config.rate };
+            return start + std::chrono::duration_cast<clock::duration>(offset);
+        };
+        auto work = [&](Worker& worker) {
+            for (size_t i = next++; i < total; i = next++) {
+                const auto& record = records[i % records.size()];
+                auto        begin  = clock::now();
+                if (config.rate > 0) {
+                    begin = due(i);
+                    std::this_thread::sleep_until(begin);
+                }
+                worker.found += solve(*mazes[record.maze], record, worker);
+                const std::chrono::nanoseconds spent = clock::now() - begin;
+                worker.latency.record(static_cast<uint64_t>(std::max<int64_t>(0, spent.count())));
+            }
+        };
+        vector<std::thread> pool;
+        pool.reserve(threads);
+        for (auto& worker : workers) {
+            pool.emplace_back(work, std::ref(worker));
+        }
+        for (auto& thread : pool) {
+            thread.join();
+        }
+        const std::chrono::duration<double> spent = clock::now() - start;
+
+        ReplayReport ret;
+        ret.queries = total;
+        ret.threads = threads;
+        ret.rate    = config.rate;
+        ret.seconds = spent.count();
+        for (const auto& worker : workers) {
+            ret.found += worker.found;
+            ret.latency.merge(worker.latency);
+        }
+        return ret;
+    }
+};
+
+} // namespace Utility
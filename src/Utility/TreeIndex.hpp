@@ -0,0 +1,287 @@
+/**
+ * @file TreeIndex.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Lowest common ancestor index of a perfect maze
+ * @version 0.1
+ * @date 2023-01-20
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "Heading.hpp"
+#include "Workspace.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Utility {
+
+using std::vector;
+
+/**
+ * @brief the spanning tree of a perfect maze, rooted, with O(1) lca
+ *
+ * A perfect maze (one component, no loop, as `Generator` makes) has exactly
+ *  one route between two cells: up from the entry to their lowest common
+ *  ancestor, then down to the exit. The tree is kept as 2-bit parent headings
+ *  plus depths, and the lca is a range-minimum over the dfs preorder: for
+ *  `pre(u) < pre(v)` it's the parent of the shallowest cell in
+ *  `(pre(u), pre(v)]`. Minima are answered in O(1) by a sparse table over
+ *  64-cell blocks and, inside a block, a bitmask of the increasing stack.
+ */
+class TreeIndex {
+public:
+    using index_type = Workspace::index_type;
+
+    static constexpr index_type npos = Workspace::npos;
+
+private:
+    static constexpr size_t block = 64;
+
+    size_t size = 0;
+
+    /* per cell (depth and preorder are npos on walls) */
+    vector<uint8_t>    parents  = {}; /* heading to the parent, 2 bits each */
+    vector<index_type> depths   = {};
+    vector<index_type> preorder = {};
+
+    /* per preorder position */
+    vector<index_type> order = {};
+    vector<uint64_t>   masks = {};
+
+    /// @brief `sparse[k][b]`: position of the min over blocks `b .. b + 2^k`
+    vector<vector<index_type>> sparse = {};
+
+    heading parent_heading(index_type idx) const {
+        return static_cast<heading>((parents[idx / 4] >> (idx % 4 * 2)) & 0b11);
+    }
+    void set_parent_heading(index_type idx, heading dir) {
+        parents[idx / 4] |= static_cast<uint8_t>(static_cast<uint8_t>(dir) << (idx % 4 * 2));
+    }
+    index_type depth_at(index_type pos) const {
+        return depths[order[pos]];
+    }
+    index_type shallower(index_type lhs, index_type rhs) const {
+        return depth_at(rhs) < depth_at(lhs) ? rhs : lhs;
+    }
+
+    /// @brief position of the min over `[l, r]`, both in one block
+    index_type min_in_block(index_type l, index_type r) const {
+        const uint64_t stack = masks[r] & (~uint64_t(0) << (l % block));
+        return static_cast<index_type>(r - r % block + std::countr_zero(stack));
+    }
+    /// @brief position of the min over `[l, r]`
+    index_type min_between(index_type l, index_type r) const {
+        const size_t lhs = l / block;
+        const size_t rhs = r / block;
+        if (lhs == rhs) {
+            return min_in_block(l, r);
+        }
+        index_type ret = shallower(
+            min_in_block(l, static_cast<index_type>(lhs * block + block - 1)),
+            min_in_block(static_cast<index_type>(rhs * block), r)
+        );
+        if (rhs - lhs > 1) {
+            const size_t first = lhs + 1;
+            const size_t count = rhs - lhs - 1;
+            const int    k     = std::bit_width(count) - 1;
+            ret = shallower(ret, shallower(sparse[k][first], sparse[k][rhs - (size_t(1) << k)]));
+        }
+        return ret;
+    }
+
+    /// @return false if the open cells are not one tree
+    bool span(const vector<uint8_t>& cells) {
+        const size_t cell_count = cells.size();
+        size_t       open       = 0;
+        size_t       edges      = 0;
+        for (size_t idx = 0; idx < cell_count; ++idx) {
+            if (!cells[idx]) {
+                continue;
+            }
+            ++open;
+            edges += idx % size + 1 < size && cells[idx + 1];
+            edges += idx + size < cell_count && cells[idx + size];
+        }
+        // a connected graph with `open - 1` edges is a tree, checked below
+        if (open == 0 || edges != open - 1) {
+            return false;
+        }
+
+        parents.assign((cell_count + 3) / 4, 0);
+        depths.assign(cell_count, npos);
+        preorder.assign(cell_count, npos);
+        order.reserve(open);
+
+        index_type root = 0;
+        while (!cells[root]) {
+            ++root;
+        }
+        vector<index_type> stack = { root };
+        depths[root]             = 0;
+        while (!stack.empty()) {
+            const index_type from = stack.back();
+            stack.pop_back();
+            preorder[from] = static_cast<index_type>(order.size());
+            order.push_back(from);
+
+            const size_t x = from / size;
+            const size_t y = from % size;
+            auto descend   = [&](bool if_inside, heading dir) {
+                if (!if_inside) {
+                    return;
+                }
+                const index_type to = step(from, dir, size);
+                if (!cells[to] || depths[to] != npos) {
+                    return; /* wall, or the parent (no loop by the edge count) */
+                }
+                depths[to] = depths[from] + 1;
+                set_parent_heading(to, reverse(dir));
+                stack.push_back(to);
+            };
+            descend(x > 0, heading::north);
+            descend(x + 1 < size, heading::south);
+            descend(y > 0, heading::west);
+            descend(y + 1 < size, heading::east);
+        }
+        return order.size() == open;
+    }
+
+    void index_minima() {
+        const size_t count = order.size();
+
+        // in every block, the increasing stack of prefix minima as a bitmask
+        masks.resize(count);
+        vector<index_type> stack;
+        for (size_t start = 0; start < count; start += block) {
+            stack.clear();
+            uint64_t mask = 0;
+            for (size_t pos = start; pos < std::min(count, start + block); ++pos) {
+                while (!stack.empty() && depth_at(stack.back()) > depth_at(static_cast<index_type>(pos))) {
+                    mask &= ~(uint64_t(1) << (stack.back() % block));
+                    stack.pop_back();
+                }
+                stack.push_back(static_cast<index_type>(pos));
+                mask |= uint64_t(1) << (pos % block);
+                masks[pos] = mask;
+            }
+        }
+
+        // sparse table over the block minima
+        const size_t blocks = (count + block - 1) / block;
+        sparse.assign(1, vector<index_type>(blocks));
+        for (size_t b = 0; b < blocks; ++b) {
+            sparse[0][b] = min_in_block(
+                static_cast<index_type>(b * block),
+                static_cast<index_type>(std::min(count, b * block + block) - 1)
+            );
+        }
+        for (size_t k = 1; (size_t(1) << k) <= blocks; ++k) {
+            const size_t half = size_t(1) << (k - 1);
+            auto&        prev = sparse[k - 1];
+            vector<index_type> level(blocks - 2 * half + 1);
+            for (size_t b = 0; b < level.size(); ++b) {
+                level[b] = shallower(prev[b], prev[b + half]);
+            }
+            sparse.push_back(std::move(level));
+        }
+    }
+
+public:
+    /**
+     * @brief Default constructor (no index, the maze is not perfect)
+     *
+     */
+    TreeIndex() = default;
+
+    /**
+     * @brief index the open cells if they form one tree
+     *
+     * @param cells  flat row-major grid, non-zero for path
+     * @param size
+     * @return TreeIndex  empty unless the maze is perfect
+     * @note one edge-counting pass rejects most other mazes before any
+     *      allocation; building is O(cells)
+     */
+    static TreeIndex build(const vector<uint8_t>& cells, size_t size) {
+        TreeIndex ret;
+        ret.size = size;
+        if (!ret.span(cells)) {
+            return {};
+        }
+        ret.index_minima();
+        return ret;
+    }
+
+    bool empty() const {
+        return order.empty();
+    }
+
+    /// @brief whether `idx` is a cell of the tree (an open cell of the maze)
+    bool contains(index_type idx) const {
+        return idx < preorder.size() && preorder[idx] != npos;
+    }
+
+    /**
+     * @brief lowest common ancestor of two open cells, O(1)
+     *
+     * @return index_type  npos if either is not in the tree
+     */
+    index_type lca(index_type lhs, index_type rhs) const {
+        if (!contains(lhs) || !contains(rhs)) {
+            return npos;
+        }
+        if (lhs == rhs) {
+            return lhs;
+        }
+        index_type l = preorder[lhs];
+        index_type r = preorder[rhs];
+        if (l > r) {
+            std::swap(l, r);
+        }
+        const index_type shallowest = order[min_between(l + 1, r)];
+        return step(shallowest, parent_heading(shallowest), size);
+    }
+
+    /**
+     * @brief number of steps between two open cells, O(1)
+     *
+     * @return index_type  npos if either is not in the tree
+     */
+    index_type distance(index_type lhs, index_type rhs) const {
+        const index_type top = lca(lhs, rhs);
+        return top == npos ? npos : depths[lhs] + depths[rhs] - 2 * depths[top];
+    }
+
+    /**
+     * @brief the route from `source` to `target`, O(route length)
+     *
+     * @note the cells are left in `ws.get_route()`
+     * @return false (and an empty route) if either is not in the tree
+     */
+    bool route(Workspace& ws, index_type source, index_type target) const {
+        const index_type top = lca(source, target);
+        ws.begin(depths.size());
+        if (top == npos) {
+            return false;
+        }
+        for (index_type curr = source; curr != top; curr = step(curr, parent_heading(curr), size)) {
+            ws.append_route(curr);
+        }
+        ws.append_route(top);
+        const size_t down = ws.get_route().size();
+        for (index_type curr = target; curr != top; curr = step(curr, parent_heading(curr), size)) {
+            ws.append_route(curr);
+        }
+        ws.reverse_route(down);
+        return true;
+    }
+};
+
+} // namespace Utility
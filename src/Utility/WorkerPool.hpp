@@ -0,0 +1,104 @@
+/**
+ * @file WorkerPool.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Fixed set of threads, each solving inside its own Workspace
+ * @version 0.1
+ * @date 2023-01-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "Workspace.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Utility {
+
+/**
+ * @brief FIFO task queue served by a fixed number of threads
+ *
+ * A task receives the `Workspace` of the thread running it, so a const
+ *  `Maze` shared by all tasks can be searched without any allocation once
+ *  the workspaces have grown. Destruction runs the queued tasks, then joins.
+ */
+class WorkerPool {
+public:
+    using task = std::function<void(Workspace&)>;
+
+private:
+    std::vector<std::thread> threads  = {};
+    std::deque<task>         queue    = {};
+    std::mutex               mutex    = {};
+    std::condition_variable  ready    = {};
+    bool                     stopping = false;
+
+    void work() {
+        Workspace ws;
+        while (true) {
+            task next;
+            {
+                std::unique_lock lock { mutex };
+                ready.wait(lock, [this]() {
+                    return stopping || !queue.empty();
+                });
+                if (queue.empty()) {
+                    return; /* stopping and drained */
+                }
+                next = std::move(queue.front());
+                queue.pop_front();
+            }
+            next(ws);
+        }
+    }
+
+public:
+    /**
+     * @brief start `count` threads (0 for one per hardware thread)
+     *
+     */
+    explicit WorkerPool(size_t count = 0) {
+        if (count == 0) {
+            count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        threads.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            threads.emplace_back(&WorkerPool::work, this);
+        }
+    }
+    ~WorkerPool() {
+        {
+            std::lock_guard lock { mutex };
+            stopping = true;
+        }
+        ready.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool&)            = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void submit(task job) {
+        {
+            std::lock_guard lock { mutex };
+            queue.push_back(std::move(job));
+        }
+        ready.notify_one();
+    }
+    size_t size() const {
+        return threads.size();
+    }
+};
+
+} // namespace Utility
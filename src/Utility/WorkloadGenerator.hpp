@@ -0,0 +1,327 @@
+/**
+ * @file WorkloadGenerator.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Seeded, tunable maze generation for benchmark corpora
+ * @version 0.1
+ * @date 2023-01-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "Maze.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Utility {
+
+using std::vector;
+
+/// @brief where `WorkloadGenerator` puts entry and exit
+enum class endpoint_strategy {
+    border,          /* entry on the left border, exit on the right one */
+    random_interior, /* two random open cells */
+    farthest_pair,   /* (about) the two open cells farthest apart */
+};
+
+/**
+ * @brief knobs of a generated maze, all defaults give a perfect dfs maze
+ *
+ * Probabilities are in [0, 1].
+ */
+struct WorkloadConfig {
+    /// @brief side of the maze, odd (cells on even coordinates, like `Generator`)
+    int size = 101;
+
+    uint64_t seed = 20230118;
+
+    /// @brief chance of a dfs step going straight on when it can
+    double corridor_bias = 0.0;
+
+    /// @brief chance of a dead end being opened into a loop
+    double braid = 0.0;
+
+    /// @brief chance of each wall left between two cells being knocked down
+    double wall_removal = 0.0;
+
+    /// @brief share of the area opened up as rectangular rooms
+    double room_density = 0.0;
+
+    /// @brief longest side of a room
+    int room_max = 9;
+
+    endpoint_strategy endpoints = endpoint_strategy::border;
+};
+
+/**
+ * @brief a generated maze with its endpoints (see `Maze::create`)
+ *
+ */
+struct Workload {
+    std::string name  = {};
+    matrix<int> data  = {};
+    coordinate  entry = { -1, -1 };
+    coordinate  exit  = { -1, -1 };
+};
+
+/**
+ * @brief reproducible mazes between perfect, braided, roomy and open
+ *
+ * Every random choice comes from one `mt19937_64` seeded by the config, and
+ *  no std distribution is used (their output differs between standard
+ *  libraries), so a seed gives the same maze everywhere.
+ */
+class WorkloadGenerator {
+    const WorkloadConfig config;
+
+    std::mt19937_64 rng;
+    matrix<int>     data = {};
+
+    static constexpr std::array<std::pair<int, int>, 4> steps = { {
+        { -2, 0 },
+        { 2, 0 },
+        { 0, -2 },
+        { 0, 2 },
+    } };
+
+    explicit WorkloadGenerator(const WorkloadConfig& config)
+        : config(config)
+        , rng(config.seed) {
+        if (config.size < 3 || config.size % 2 == 0) {
+            throw std::invalid_argument("Workload size must be odd and at least 3!");
+        }
+    }
+
+    int below(int bound) {
+        return static_cast<int>(rng() % static_cast<uint64_t>(bound));
+    }
+    bool chance(double probability) {
+        return static_cast<double>(rng() >> 11) * 0x1.0p-53 < probability;
+    }
+    bool if_cell(int x, int y) const {
+        return x >= 0 && x < config.size && y >= 0 && y < config.size;
+    }
+
+    /// @brief iterative dfs over the even cells, going straight on by bias
+    void carve() {
+        const int size = config.size;
+        data           = matrix<int>(size, vector<int>(size, 0));
+
+        vector<std::pair<coordinate, int>> stack; /* { cell, heading in } */
+        stack.push_back({ { 0, 0 }, -1 });
+        data[0][0] = 1;
+        while (!stack.empty()) {
+            auto [top, last] = stack.back();
+            auto [x, y]      = top;
+
+            std::array<int, 4> options {};
+            int                count = 0;
+            for (int k = 0; k < 4; ++k) {
+                int nx = x + steps[k].first;
+                int ny = y + steps[k].second;
+                if (if_cell(nx, ny) && data[nx][ny] == 0) {
+                    options[count++] = k;
+                }
+            }
+            if (count == 0) {
+                stack.pop_back();
+                continue;
+            }
+            int chosen = options[below(count)];
+            if (last != -1 && chance(config.corridor_bias)) {
+                chosen = std::find(options.begin(), options.begin() + count, last) != options.begin() + count
+                           ? last
+                           : chosen;
+            }
+            int nx = x + steps[chosen].first;
+            int ny = y + steps[chosen].second;
+            data[(x + nx) / 2][(y + ny) / 2] = 1;
+            data[nx][ny]                     = 1;
+            stack.push_back({ { nx, ny }, chosen });
+        }
+    }
+
+    /// @brief open one more wall of some dead ends, making loops
+    void braid() {
+        if (config.braid <= 0) {
+            return;
+        }
+        for (int x = 0; x < config.size; x += 2) {
+            for (int y = 0; y < config.size; y += 2) {
+                std::array<int, 4> closed {};
+                int                open_count   = 0;
+                int                closed_count = 0;
+                for (int k = 0; k < 4; ++k) {
+                    int nx = x + steps[k].first;
+                    int ny = y + steps[k].second;
+                    if (!if_cell(nx, ny)) {
+                        continue;
+                    }
+                    if (data[(x + nx) / 2][(y + ny) / 2]) {
+                        ++open_count;
+                    } else {
+                        closed[closed_count++] = k;
+                    }
+                }
+                if (open_count == 1 && closed_count > 0 && chance(config.braid)) {
+                    int k = closed[below(closed_count)];
+                    data[x + steps[k].first / 2][y + steps[k].second / 2] = 1;
+                }
+            }
+        }
+    }
+
+    /// @brief knock down walls between two cells at random
+    void remove_walls() {
+        if (config.wall_removal <= 0) {
+            return;
+        }
+        for (int x = 0; x < config.size; ++x) {
+            // walls between two cells sit on exactly one odd coordinate
+            for (int y = (x + 1) % 2; y < config.size; y += 2) {
+                if (data[x][y] == 0 && chance(config.wall_removal)) {
+                    data[x][y] = 1;
+                }
+            }
+        }
+    }
+
+    /// @brief open rectangles aligned on the cells until the density is met
+    void open_rooms() {
+        if (config.room_density <= 0) {
+            return;
+        }
+        const int  size   = config.size;
+        const long target = static_cast<long>(config.room_density * size * size);
+        const int  side   = std::max(3, std::min(config.room_max, size));
+
+        long opened = 0;
+        for (int attempt = 0; opened < target && attempt < size * size; ++attempt) {
+            // odd sides, corners on cells, so a room joins the corridors
+            int height = 3 + 2 * below((side - 1) / 2);
+            int width  = 3 + 2 * below((side - 1) / 2);
+            height     = std::min(height, size);
+            width      = std::min(width, size);
+            int x      = 2 * below((size - height) / 2 + 1);
+            int y      = 2 * below((size - width) / 2 + 1);
+            for (int i = x; i < x + height; ++i) {
+                for (int j = y; j < y + width; ++j) {
+                    opened += data[i][j] == 0;
+                    data[i][j] = 1;
+                }
+            }
+        }
+    }
+
+    /// @brief bfs distances from `source` (-1 for unreachable)
+    vector<int> distances_from(coordinate source) const {
+        const int   size = config.size;
+        vector<int> dist(size * size, -1);
+        vector<int> queue;
+        queue.reserve(size * size);
+
+        dist[source.first * size + source.second] = 0;
+        queue.push_back(source.first * size + source.second);
+        for (size_t head = 0; head < queue.size(); ++head) {
+            const int from = queue[head];
+            const int x    = from / size;
+            const int y    = from % size;
+            for (auto [dx, dy] : steps) {
+                int nx = x + dx / 2;
+                int ny = y + dy / 2;
+                if (if_cell(nx, ny) && data[nx][ny] && dist[nx * size + ny] == -1) {
+                    dist[nx * size + ny] = dist[from] + 1;
+                    queue.push_back(nx * size + ny);
+                }
+            }
+        }
+        return dist;
+    }
+    coordinate farthest_from(coordinate source) const {
+        auto dist = distances_from(source);
+        int  best = static_cast<int>(std::max_element(dist.begin(), dist.end()) - dist.begin());
+        return { best / config.size, best % config.size };
+    }
+
+    coordinate random_open_cell() {
+        while (true) {
+            coordinate cord = { below(config.size), below(config.size) };
+            if (data[cord.first][cord.second]) {
+                return cord;
+            }
+        }
+    }
+
+    std::pair<coordinate, coordinate> place_endpoints() {
+        const int size = config.size;
+        switch (config.endpoints) {
+        case endpoint_strategy::border:
+            // even rows of the border columns are always cells
+            return {
+                { 2 * below(size / 2 + 1), 0 },
+                { 2 * below(size / 2 + 1), size - 1 },
+            };
+        case endpoint_strategy::random_interior:
+            return { random_open_cell(), random_open_cell() };
+        default: {
+            // double sweep: exact on perfect mazes, a close bound otherwise
+            coordinate entry = farthest_from(random_open_cell());
+            return { entry, farthest_from(entry) };
+        }
+        }
+    }
+
+public:
+    /**
+     * @brief generate one maze
+     *
+     * @note the same config (seed included) always gives the same maze
+     */
+    static Workload generate(const WorkloadConfig& config, std::string name = "") {
+        WorkloadGenerator generator { config };
+        generator.carve();
+        generator.braid();
+        generator.remove_walls();
+        generator.open_rooms();
+        auto [entry, exit] = generator.place_endpoints();
+        return { std::move(name), std::move(generator.data), entry, exit };
+    }
+
+    /**
+     * @brief one maze of each kind, where solvers behave very differently
+     *
+     * - perfect:   one route, long winding corridors
+     * - corridors: perfect, but mostly straight runs
+     * - braided:   every dead end looped, many equal routes
+     * - rooms:     open areas joined by corridors
+     * - open:      half of the walls knocked down, close to a grid
+     */
+    static vector<Workload> corpus(int size, uint64_t seed) {
+        auto with = [&](auto&& tune) {
+            WorkloadConfig config;
+            config.size      = size;
+            config.seed      = seed;
+            config.endpoints = endpoint_strategy::farthest_pair;
+            tune(config);
+            return config;
+        };
+        return {
+            generate(with([](auto&) { }), "perfect"),
+            generate(with([](auto& c) { c.corridor_bias = 0.8; }), "corridors"),
+            generate(with([](auto& c) { c.braid = 1.0; }), "braided"),
+            generate(with([](auto& c) { c.room_density = 0.3; c.braid = 0.2; }), "rooms"),
+            generate(with([](auto& c) { c.wall_removal = 0.5; }), "open"),
+        };
+    }
+};
+
+} // namespace Utility
@@ -0,0 +1,232 @@
+/**
+ * @file Workspace.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief Reusable scratch memory for solving mazes
+ * @version 0.1
+ * @date 2023-01-09
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace Utility {
+
+/**
+ * @brief scratch buffers of a solve, carved out of one arena
+ *
+ * Cells are addressed by their flat index. Visited marks are generation
+ *  stamps: starting a new solve only bumps `generation`, so nothing has to be
+ *  cleared. Once the arena is large enough for the maze, reusing the same
+ *  workspace for consecutive queries makes no heap allocation at all.
+ */
+class Workspace {
+public:
+    using index_type = uint32_t;
+
+    static constexpr index_type npos = UINT32_MAX;
+
+private:
+    /// @brief number of `index_type` slices carved out of the arena
+    static constexpr size_t slices = 5;
+
+    std::unique_ptr<index_type[]> arena    = nullptr;
+    size_t                        capacity = 0;
+
+    index_type* stamps   = nullptr;
+    index_type* parents  = nullptr;
+    index_type* frontier = nullptr;
+    index_type* route    = nullptr;
+    index_type* distance = nullptr;
+
+    /// @brief binary min-heap of `{ key, index }`, keeps its capacity
+    std::vector<std::pair<uint64_t, index_type>> heap = {};
+
+    index_type generation   = 0;
+    size_t     head         = 0;
+    size_t     tail         = 0;
+    size_t     route_length = 0;
+
+    void reserve(size_t cells) {
+        if (cells <= capacity) {
+            return;
+        }
+        arena    = std::make_unique<index_type[]>(cells * slices);
+        capacity = cells;
+        stamps   = arena.get();
+        parents  = stamps + cells;
+        frontier = parents + cells;
+        route    = frontier + cells;
+        distance = route + cells;
+        // fresh arena => stamps are all zero, generation restarts
+        std::fill_n(stamps, cells, 0);
+        generation = 0;
+    }
+    void next_generation() {
+        if (++generation == 0) {
+            // wrapped around, the only time stamps are really cleared
+            std::fill_n(stamps, capacity, 0);
+            generation = 1;
+        }
+    }
+
+public:
+    /**
+     * @brief Default constructor
+     *
+     */
+    Workspace() = default;
+
+    /* scratch memory is never shared, a copy starts out empty */
+
+    Workspace(const Workspace&) { }
+    Workspace& operator=(const Workspace&) {
+        return *this;
+    }
+    /* a move takes the arena, the moved-from workspace starts out empty */
+
+    Workspace(Workspace&& other) noexcept {
+        *this = std::move(other);
+    }
+    Workspace& operator=(Workspace&& other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+        arena        = std::move(other.arena);
+        capacity     = std::exchange(other.capacity, 0);
+        stamps       = std::exchange(other.stamps, nullptr);
+        parents      = std::exchange(other.parents, nullptr);
+        frontier     = std::exchange(other.frontier, nullptr);
+        route        = std::exchange(other.route, nullptr);
+        distance     = std::exchange(other.distance, nullptr);
+        heap         = std::move(other.heap);
+        generation   = std::exchange(other.generation, 0);
+        head         = std::exchange(other.head, 0);
+        tail         = std::exchange(other.tail, 0);
+        route_length = std::exchange(other.route_length, 0);
+        other.heap.clear();
+        return *this;
+    }
+
+    /**
+     * @brief start a new solve over `cells` cells
+     *
+     * @note only allocates when `cells` exceeds the current capacity
+     */
+    void begin(size_t cells) {
+        reserve(cells);
+        next_generation();
+        head         = 0;
+        tail         = 0;
+        route_length = 0;
+        heap.clear();
+    }
+
+    bool visited(index_type idx) const {
+        return stamps[idx] == generation;
+    }
+    void visit(index_type idx, index_type parent) {
+        stamps[idx]  = generation;
+        parents[idx] = parent;
+    }
+    /// @brief record a parent without stamping (visits tracked elsewhere)
+    void set_parent(index_type idx, index_type parent) {
+        parents[idx] = parent;
+    }
+    index_type parent(index_type idx) const {
+        return parents[idx];
+    }
+
+    /* FIFO frontier (every cell is pushed at most once per solve) */
+
+    bool frontier_empty() const {
+        return head == tail;
+    }
+    size_t frontier_size() const {
+        return tail - head;
+    }
+    void push(index_type idx) {
+        frontier[tail++] = idx;
+    }
+    index_type pop() {
+        return frontier[head++];
+    }
+
+    /* tentative distance, only meaningful for visited cells */
+
+    index_type get_distance(index_type idx) const {
+        return distance[idx];
+    }
+    void set_distance(index_type idx, index_type dist) {
+        distance[idx] = dist;
+    }
+
+    /*
+     * min-heap frontier keyed by a 64-bit cost (stale entries allowed),
+     *  wide enough for a cost plus a tie-breaker in the low bits
+     */
+
+    bool heap_empty() const {
+        return heap.empty();
+    }
+    void heap_push(uint64_t key, index_type idx) {
+        heap.emplace_back(key, idx);
+        std::push_heap(heap.begin(), heap.end(), std::greater<> {});
+    }
+    /// @return { key, index } with the lowest key (then the lowest index)
+    std::pair<uint64_t, index_type> heap_pop() {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<> {});
+        auto top = heap.back();
+        heap.pop_back();
+        return top;
+    }
+
+    /**
+     * @brief fill the route by walking parents from `target` back to `source`
+     *
+     */
+    void trace(index_type source, index_type target) {
+        route_length = 0;
+        index_type curr = target;
+        while (curr != source) {
+            route[route_length++] = curr;
+            curr                  = parents[curr];
+        }
+        route[route_length++] = source;
+        std::reverse(route, route + route_length);
+    }
+    void clear_route() {
+        route_length = 0;
+    }
+    void append_route(index_type idx) {
+        route[route_length++] = idx;
+    }
+    /// @brief reverse the route from position `from` to its end
+    void reverse_route(size_t from = 0) {
+        std::reverse(route + from, route + route_length);
+    }
+    /// @brief replace every index of the route by `fn(index)`
+    template <class Fn>
+    void remap_route(Fn&& fn) {
+        std::transform(route, route + route_length, route, fn);
+    }
+
+    /**
+     * @brief route of the last successful solve, from entry to exit
+     *
+     */
+    std::span<const index_type> get_route() const {
+        return { route, route_length };
+    }
+};
+
+} // namespace Utility
@@ -10,10 +10,44 @@
  */
 
 #include "TaskManager.hpp"
+#include "Test/Benchmark.hpp"
 #include "Test/GeneratorTest.hpp"
+#include "Test/SolverTest.hpp"
 
 int main(int argc, char** argv) {
+    if (argc > 1) {
+        return Task::run_command({ argv + 1, argv + argc });
+    }
     Task::run_all_tasks();
     // Test::GeneratorTest();
+    // Test::FixedMazeTest();
+    // Test::StaticMazeTest();
+    // Test::WorkspaceTest();
+    // Test::CorridorGraphTest();
+    // Test::ComponentsTest();
+    // Test::RouteIndexTest();
+    // Test::AsyncSolveTest();
+    // Test::LowMemorySolverTest();
+    // Test::ExternalBfsTest();
+    // Test::LayoutTest();
+    // Test::LayoutBenchmark();
+    // Test::ImageExportTest();
+    // Test::WorkloadTest();
+    // Test::PortfolioTest();
+    // Test::ParallelAStarTest();
+    // Test::SolverSelectionTest();
+    // Test::BoundedSearchTest();
+    // Test::TreeIndexTest();
+    // Test::NearestExitTest();
+    // Test::AnalyticsTest();
+    // Test::SearchPolicyTest();
+    // Test::TraceReplayTest();
+    // Test::ChunkedMazeTest();
+    // Test::RouteCacheTest();
+    // Test::PartitionedBfsTest();
+    // Test::WorkloadBenchmark();
+    // Test::SelectionBenchmark();
+    // Test::ParallelAStarBenchmark();
+    // Test::RouteServiceTest();
     return 0;
 }
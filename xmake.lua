@@ -4,6 +4,9 @@ target("Maze")
     set_kind("binary")
     add_files("src/*.cpp")
     set_languages("c17", "c++20")
+    if is_plat("linux") then
+        add_syslinks("pthread")
+    end
     if is_mode("release") then 
         set_optimize("faster")
     end